@@ -0,0 +1,30 @@
+#ifndef ODR_ACCESS_ASYNC_STREAM_H
+#define ODR_ACCESS_ASYNC_STREAM_H
+
+#include <iostream>
+#include <memory>
+
+namespace odr {
+namespace access {
+
+// hands everything written to it in chunks to a thread which writes them to
+// `out`; `out` must not be used by anyone else until `finish` returns
+class AsyncOstream final : public std::ostream {
+public:
+  explicit AsyncOstream(std::ostream &out);
+  ~AsyncOstream() final;
+
+  // writes the remaining data and waits for the thread; further writes fail.
+  // sets badbit if writing to `out` failed or threw at any point, which the
+  // destructor cannot report
+  void finish();
+
+private:
+  class Buf;
+  const std::unique_ptr<Buf> buf_;
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_ASYNC_STREAM_H
@@ -0,0 +1,50 @@
+#ifndef ODR_ACCESS_CACHING_STORAGE_H
+#define ODR_ACCESS_CACHING_STORAGE_H
+
+#include <access/Storage.h>
+#include <cstdint>
+#include <memory>
+
+namespace odr {
+namespace access {
+
+// keeps the bytes of members read from `parent`, inflated and decrypted as
+// the parent hands them out, in least recently used order within a byte
+// budget. hits are served from memory without a copy; members larger than the
+// budget are streamed from the parent as before, and so is everything from a
+// resident parent. safe to read from several threads if the parent is
+class CachingStorage final : public ReadStorage {
+public:
+  static constexpr std::uint64_t defaultBudget = 32 * 1024 * 1024;
+
+  explicit CachingStorage(std::unique_ptr<ReadStorage> parent,
+                          std::uint64_t budget = defaultBudget);
+  ~CachingStorage() final;
+
+  // drops the cache and hands back the parent; nothing else may be called
+  // afterwards
+  std::unique_ptr<ReadStorage> release();
+
+  std::uint64_t cachedBytes() const;
+
+  bool isSomething(PathView) const final;
+  bool isFile(PathView) const final;
+  bool isDirectory(PathView) const final;
+  bool isReadable(PathView) const final;
+
+  std::uint64_t size(PathView) const final;
+  std::uint32_t checksum(PathView) const final;
+
+  void visit(Visitor) const final;
+
+  std::unique_ptr<std::istream> read(PathView) const final;
+
+private:
+  class Impl;
+  const std::unique_ptr<Impl> impl_;
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_CACHING_STORAGE_H
@@ -2,6 +2,8 @@
 #define ODR_ACCESS_CFB_STORAGE_H
 
 #include <access/Storage.h>
+#include <memory>
+#include <string>
 
 namespace odr {
 namespace access {
@@ -18,19 +20,22 @@ struct CfbFileCorruptedException : public CfbException {
 
 class CfbReader final : public ReadStorage {
 public:
+  // shares the bytes instead of copying them, e.g. with a ZipReader probing
+  // the same buffer
+  explicit CfbReader(std::shared_ptr<const std::string> cfb);
   explicit CfbReader(const Path &);
   ~CfbReader() final;
 
-  bool isSomething(const Path &) const final;
-  bool isFile(const Path &) const final;
-  bool isDirectory(const Path &) const final;
-  bool isReadable(const Path &) const final;
+  bool isSomething(PathView) const final;
+  bool isFile(PathView) const final;
+  bool isDirectory(PathView) const final;
+  bool isReadable(PathView) const final;
 
-  std::uint64_t size(const Path &) const final;
+  std::uint64_t size(PathView) const final;
 
   void visit(Visitor) const final;
 
-  std::unique_ptr<std::istream> read(const Path &) const final;
+  std::unique_ptr<std::istream> read(PathView) const final;
 
 private:
   class Impl;
@@ -11,13 +11,14 @@ class ChildStorage final : public Storage {
 public:
   ChildStorage(const Storage &parent, Path prefix);
 
-  bool isSomething(const Path &) const final;
-  bool isFile(const Path &) const final;
-  bool isDirectory(const Path &) const final;
-  bool isReadable(const Path &) const final;
+  bool isSomething(PathView) const final;
+  bool isFile(PathView) const final;
+  bool isDirectory(PathView) const final;
+  bool isReadable(PathView) const final;
   bool isWriteable(const Path &) const final;
 
-  std::uint64_t size(const Path &) const final;
+  std::uint64_t size(PathView) const final;
+  std::uint32_t checksum(PathView) const final;
 
   bool remove(const Path &) const final;
   bool copy(const Path &, const Path &) const final;
@@ -27,7 +28,7 @@ public:
 
   void visit(Visitor) const final;
 
-  std::unique_ptr<std::istream> read(const Path &) const final;
+  std::unique_ptr<std::istream> read(PathView) const final;
   std::unique_ptr<std::ostream> write(const Path &) const final;
 
 private:
@@ -0,0 +1,35 @@
+#ifndef ODR_ACCESS_DIAGNOSTICS_H
+#define ODR_ACCESS_DIAGNOSTICS_H
+
+#include <odr/Diagnostics.h>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace odr {
+namespace access {
+
+// Counts problems by category instead of logging each of them. Only the first
+// few samples of a category are copied.
+class Diagnostics final {
+public:
+  static constexpr std::size_t maxSamples = 3;
+
+  // `category` has to outlive the collector; meant for string literals
+  void report(const char *category);
+  void report(const char *category, std::string_view sample);
+
+  bool empty() const noexcept;
+  void clear() noexcept;
+
+  // sorted by category
+  std::vector<Diagnostic> summary() const;
+
+private:
+  std::unordered_map<std::string_view, Diagnostic> diagnostics_;
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_DIAGNOSTICS_H
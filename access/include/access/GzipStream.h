@@ -0,0 +1,29 @@
+#ifndef ODR_ACCESS_GZIP_STREAM_H
+#define ODR_ACCESS_GZIP_STREAM_H
+
+#include <iostream>
+#include <memory>
+
+namespace odr {
+namespace access {
+
+// deflates everything written to it into a gzip member on `out`
+class GzipOstream final : public std::ostream {
+public:
+  // `level` ranges from 0 (stored) to 9 (smallest)
+  explicit GzipOstream(std::ostream &out, int level = 6);
+  ~GzipOstream() final;
+
+  // flushes the remaining data and writes the gzip trailer; further writes
+  // fail
+  void finish();
+
+private:
+  class Buf;
+  const std::unique_ptr<Buf> buf_;
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_GZIP_STREAM_H
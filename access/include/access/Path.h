@@ -4,16 +4,20 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <typeindex>
 
 namespace odr {
 namespace access {
 
+class PathView;
+
 class Path final {
 public:
   Path() noexcept;
   Path(const char *);
   Path(const std::string &);
+  explicit Path(PathView);
   Path(const Path &) = default;
   Path(Path &&) = default;
   ~Path() = default;
@@ -53,12 +57,64 @@ private:
   std::uint32_t upwards_;
   std::uint32_t downwards_;
   bool absolute_;
+  std::size_t hash_;
 
   friend struct ::std::hash<Path>;
   friend std::ostream &operator<<(std::ostream &, const Path &);
 
+  void assign_(std::string_view);
   void parent_();
-  void join_(const std::string &);
+  void join_(std::string_view);
+};
+
+// non-owning view of a path which is already normalized, like the literals in
+// the translators or the text of a `Path`. the hash is computed once and
+// matches the one of the equal `Path`, so lookups neither allocate nor rehash
+class PathView final {
+public:
+  // fnv-1a; constant for literals
+  static constexpr std::size_t hash(const std::string_view path) noexcept {
+    std::uint64_t result = 14695981039346656037ull;
+    for (auto &&c : path) {
+      result ^= static_cast<unsigned char>(c);
+      result *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(result);
+  }
+
+  // there is no normalization; strings of unknown shape go through `Path`
+  constexpr PathView(const char *path) noexcept
+      : path_(path), hash_(hash(path_)) {}
+  PathView(const Path &path) noexcept
+      : path_(path.string()), hash_(path.hash()) {}
+
+  constexpr std::string_view string() const noexcept { return path_; }
+  // always terminated since the view only ever covers a whole string
+  constexpr const char *c_str() const noexcept { return path_.data(); }
+  constexpr std::size_t hash() const noexcept { return hash_; }
+  constexpr bool empty() const noexcept { return path_.empty(); }
+
+  // segment by segment: a separator sorts before any other character, so a
+  // directory comes right before its children
+  int compare(PathView) const noexcept;
+  // true if `prefix` is made of whole leading segments of this path
+  bool startsWith(PathView prefix) const noexcept;
+
+  friend constexpr bool operator==(const PathView a,
+                                   const PathView b) noexcept {
+    return (a.hash_ == b.hash_) && (a.path_ == b.path_);
+  }
+  friend constexpr bool operator!=(const PathView a,
+                                   const PathView b) noexcept {
+    return !(a == b);
+  }
+  friend bool operator<(const PathView a, const PathView b) noexcept {
+    return a.compare(b) < 0;
+  }
+
+private:
+  std::string_view path_;
+  std::size_t hash_;
 };
 
 } // namespace access
@@ -70,6 +126,12 @@ template <> struct hash<::odr::access::Path> {
     return p.hash();
   }
 };
+
+template <> struct hash<::odr::access::PathView> {
+  std::size_t operator()(const ::odr::access::PathView p) const {
+    return p.hash();
+  }
+};
 } // namespace std
 
 #endif // ODR_ACCESS_PATH_H
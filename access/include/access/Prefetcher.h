@@ -0,0 +1,40 @@
+#ifndef ODR_ACCESS_PREFETCHER_H
+#define ODR_ACCESS_PREFETCHER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace odr {
+namespace access {
+
+// reads the files of a batch into memory on a thread of its own so that the
+// workers never wait for the disk. at most `depth` files are buffered ahead;
+// built with ODR_IO_URING a whole round of reads is in flight at once
+class Prefetcher final {
+public:
+  struct File {
+    // position in the given paths
+    std::size_t index{0};
+    std::string path;
+    std::string data;
+    // empty if the file was read
+    std::string error;
+  };
+
+  Prefetcher(std::vector<std::string> paths, std::size_t depth);
+  ~Prefetcher();
+
+  // the next file in the given order; blocks until it is read and returns
+  // false once every file was handed out. safe to call from many threads
+  bool next(File &file);
+
+private:
+  class Impl;
+  const std::unique_ptr<Impl> impl_;
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_PREFETCHER_H
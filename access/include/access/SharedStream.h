@@ -0,0 +1,26 @@
+#ifndef ODR_ACCESS_SHARED_STREAM_H
+#define ODR_ACCESS_SHARED_STREAM_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace odr {
+namespace access {
+
+// reads straight from bytes it shares with others; they stay alive for as
+// long as the stream does, even if their owner drops them meanwhile
+class SharedIstream final : public std::istream {
+public:
+  explicit SharedIstream(std::shared_ptr<const std::string> data);
+  ~SharedIstream() final;
+
+private:
+  class Buf;
+  const std::unique_ptr<Buf> buf_;
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_SHARED_STREAM_H
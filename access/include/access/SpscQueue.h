@@ -0,0 +1,114 @@
+#ifndef ODR_ACCESS_SPSC_QUEUE_H
+#define ODR_ACCESS_SPSC_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace odr {
+namespace access {
+
+// Bounded queue for exactly one producer and one consumer thread. Elements
+// move without a lock; a side blocked in `push` or `pop` sleeps on a condition
+// variable until the other side makes room or adds an element. `capacity` is
+// rounded up to a power of two.
+template <typename T> class SpscQueue final {
+public:
+  explicit SpscQueue(const std::size_t capacity)
+      : slots_(roundUp_(capacity)), mask_(slots_.size() - 1) {}
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  // producer only; false if the queue is full
+  bool tryPush(T &value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+      return false;
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_seq_cst);
+    wake_(consumerSleeping_);
+    return true;
+  }
+
+  // consumer only; false if the queue is empty
+  bool tryPop(T &value) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+      return false;
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_seq_cst);
+    wake_(producerSleeping_);
+    return true;
+  }
+
+  // blocks while the queue is full
+  void push(T value) {
+    while (!tryPush(value)) {
+      wait_(producerSleeping_, [this] {
+        return tail_.load(std::memory_order_relaxed) -
+                   head_.load(std::memory_order_seq_cst) !=
+               slots_.size();
+      });
+    }
+  }
+
+  // blocks while the queue is empty
+  T pop() {
+    T value;
+    while (!tryPop(value)) {
+      wait_(consumerSleeping_, [this] {
+        return head_.load(std::memory_order_relaxed) !=
+               tail_.load(std::memory_order_seq_cst);
+      });
+    }
+    return value;
+  }
+
+private:
+  static std::size_t roundUp_(const std::size_t capacity) {
+    std::size_t result = 1;
+    while (result < capacity)
+      result <<= 1;
+    return result;
+  }
+
+  // the flag and the indices are ordered sequentially consistent: either the
+  // waker sees the flag or the sleeper sees the moved index, so no wakeup is
+  // lost
+  template <typename Ready>
+  void wait_(std::atomic<bool> &sleeping, const Ready &ready) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping.store(true, std::memory_order_seq_cst);
+    changed_.wait(lock, ready);
+    sleeping.store(false, std::memory_order_relaxed);
+  }
+
+  // costs a load unless the other side sleeps
+  void wake_(std::atomic<bool> &sleeping) {
+    if (!sleeping.load(std::memory_order_seq_cst))
+      return;
+    // the sleeper holds the mutex until it waits on the condition
+    { const std::lock_guard<std::mutex> lock(mutex_); }
+    changed_.notify_all();
+  }
+
+  std::vector<T> slots_;
+  const std::size_t mask_;
+  // separate cache lines keep the producer and consumer from false sharing
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::atomic<bool> producerSleeping_{false};
+  std::atomic<bool> consumerSleeping_{false};
+};
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_SPSC_QUEUE_H
@@ -1,6 +1,7 @@
 #ifndef ODR_ACCESS_STORAGE_H
 #define ODR_ACCESS_STORAGE_H
 
+#include <access/Path.h>
 #include <exception>
 #include <functional>
 #include <iostream>
@@ -9,8 +10,6 @@
 namespace odr {
 namespace access {
 
-class Path;
-
 class FileNotFoundException final : public std::exception {
 public:
   explicit FileNotFoundException(std::string path) : path_(std::move(path)) {}
@@ -31,23 +30,29 @@ private:
   std::string path_;
 };
 
+// lookups take a `PathView`, so literals and existing paths cost no allocation
 class ReadStorage {
 public:
   typedef std::function<void(const Path &)> Visitor;
 
   virtual ~ReadStorage() = default;
 
-  virtual bool isSomething(const Path &) const = 0;
-  virtual bool isFile(const Path &) const = 0;
-  virtual bool isDirectory(const Path &) const = 0;
-  virtual bool isReadable(const Path &) const = 0;
+  virtual bool isSomething(PathView) const = 0;
+  virtual bool isFile(PathView) const = 0;
+  virtual bool isDirectory(PathView) const = 0;
+  virtual bool isReadable(PathView) const = 0;
 
-  virtual std::uint64_t size(const Path &) const = 0;
+  virtual std::uint64_t size(PathView) const = 0;
+  // crc32 kept in the directory without reading the file; zero if unknown
+  virtual std::uint32_t checksum(PathView) const { return 0; }
+  // members are kept inflated by the storage itself, so a cache in front of
+  // it would only hold a second copy
+  virtual bool resident() const { return false; }
 
   // TODO only list for subdir? harder in case of zip
   virtual void visit(Visitor) const = 0;
 
-  virtual std::unique_ptr<std::istream> read(const Path &) const = 0;
+  virtual std::unique_ptr<std::istream> read(PathView) const = 0;
 };
 
 class WriteStorage {
@@ -69,13 +74,13 @@ class Storage : public ReadStorage, public WriteStorage {
 public:
   ~Storage() override = default;
 
-  bool isSomething(const Path &) const override = 0;
-  bool isFile(const Path &) const override = 0;
-  bool isDirectory(const Path &) const override = 0;
-  bool isReadable(const Path &) const override = 0;
+  bool isSomething(PathView) const override = 0;
+  bool isFile(PathView) const override = 0;
+  bool isDirectory(PathView) const override = 0;
+  bool isReadable(PathView) const override = 0;
   bool isWriteable(const Path &) const override = 0;
 
-  std::uint64_t size(const Path &) const override = 0;
+  std::uint64_t size(PathView) const override = 0;
 
   bool remove(const Path &) const override = 0;
   bool copy(const Path &from, const Path &to) const override = 0;
@@ -85,7 +90,7 @@ public:
 
   void visit(Visitor) const override = 0;
 
-  std::unique_ptr<std::istream> read(const Path &) const override = 0;
+  std::unique_ptr<std::istream> read(PathView) const override = 0;
   std::unique_ptr<std::ostream> write(const Path &) const override = 0;
 };
 
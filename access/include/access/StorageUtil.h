@@ -7,11 +7,8 @@
 namespace odr {
 namespace access {
 
-class Path;
-class ReadStorage;
-
 namespace StorageUtil {
-extern std::string read(const ReadStorage &, const Path &);
+extern std::string read(const ReadStorage &, PathView);
 }
 
 } // namespace access
@@ -0,0 +1,42 @@
+#ifndef ODR_ACCESS_TRACE_H
+#define ODR_ACCESS_TRACE_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace odr {
+namespace access {
+
+// Nested spans in the chrome trace-event format (chrome://tracing, perfetto).
+// Nothing is recorded unless started, which leaves an atomic load per span.
+namespace Trace {
+void start();
+// stops recording and writes the spans recorded so far as json
+void stop(std::ostream &out);
+bool enabled() noexcept;
+
+// records the time between construction and destruction on this thread
+class Span final {
+public:
+  explicit Span(const char *name);
+  // labeled with the member path and the entry index if not negative
+  Span(const char *name, std::string_view path, std::int64_t index = -1);
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+  ~Span();
+
+private:
+  const char *name_;
+  std::string path_;
+  std::int64_t index_{-1};
+  // microseconds since `start`; negative if not recording
+  std::int64_t begin_{-1};
+};
+} // namespace Trace
+
+} // namespace access
+} // namespace odr
+
+#endif // ODR_ACCESS_TRACE_H
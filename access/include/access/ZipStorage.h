@@ -2,7 +2,10 @@
 #define ODR_ACCESS_ZIP_STORAGE_H
 
 #include <access/Storage.h>
+#include <cstdint>
 #include <exception>
+#include <memory>
+#include <string>
 
 namespace odr {
 namespace access {
@@ -19,23 +22,48 @@ private:
   std::string path_;
 };
 
+// a member inflates to far more than any real document would: beyond `size`
+// at a higher ratio than `ratio`. deflate itself allows ~1000
+class ZipBombException : public std::exception {
+public:
+  static constexpr std::uint64_t size = 64 * 1024 * 1024;
+  static constexpr std::uint64_t ratio = 200;
+
+  explicit ZipBombException(std::string path) : path_(std::move(path)) {}
+  const std::string &path() const { return path_; }
+  const char *what() const noexcept override { return "zip bomb"; }
+
+private:
+  std::string path_;
+};
+
+// a streamed archive needs more memory and spool than it was given
+class ZipSpoolFullException : public std::exception {
+public:
+  const char *what() const noexcept override { return "zip spool full"; }
+};
+
 class ZipReader final : public ReadStorage {
 public:
   ZipReader(const void *, std::uint64_t size);
   ZipReader(const std::string &zip, bool dummy);
+  // shares the bytes instead of copying them, e.g. with a CfbReader probing
+  // the same buffer
+  explicit ZipReader(std::shared_ptr<const std::string> zip);
   explicit ZipReader(const Path &);
   ~ZipReader() final;
 
-  bool isSomething(const Path &) const final;
-  bool isFile(const Path &) const final;
-  bool isDirectory(const Path &) const final;
-  bool isReadable(const Path &) const final;
+  bool isSomething(PathView) const final;
+  bool isFile(PathView) const final;
+  bool isDirectory(PathView) const final;
+  bool isReadable(PathView) const final;
 
-  std::uint64_t size(const Path &) const final;
+  std::uint64_t size(PathView) const final;
+  std::uint32_t checksum(PathView) const final;
 
   void visit(Visitor) const final;
 
-  std::unique_ptr<std::istream> read(const Path &) const final;
+  std::unique_ptr<std::istream> read(PathView) const final;
 
 private:
   class Impl;
@@ -44,6 +72,45 @@ private:
   friend ZipWriter;
 };
 
+// reads an archive from a stream which cannot seek, e.g. while it is still
+// being uploaded. members are inflated from their local headers in the order
+// they arrive; a lookup reads ahead until the member passes or the archive
+// ends, so translation overlaps with the arrival of the rest. members are kept
+// in memory up to `memoryBudget` and written to a temporary spool beyond that
+class ZipStreamReader final : public ReadStorage {
+public:
+  static constexpr std::uint64_t defaultMemoryBudget = 64 * 1024 * 1024;
+  static constexpr std::uint64_t defaultSpoolBudget = 1024 * 1024 * 1024;
+
+  explicit ZipStreamReader(std::unique_ptr<std::istream>,
+                           std::uint64_t memoryBudget = defaultMemoryBudget,
+                           std::uint64_t spoolBudget = defaultSpoolBudget);
+  ~ZipStreamReader() final;
+
+  bool isSomething(PathView) const final;
+  bool isFile(PathView) const final;
+  bool isDirectory(PathView) const final;
+  bool isReadable(PathView) const final;
+
+  std::uint64_t size(PathView) const final;
+  std::uint32_t checksum(PathView) const final;
+  // in memory or in the spool
+  bool resident() const final;
+
+  // has to wait for the whole archive
+  void visit(Visitor) const final;
+
+  std::unique_ptr<std::istream> read(PathView) const final;
+
+  // waits only for the first member; the empty path if there is none. enough
+  // to tell the format, e.g. ODF requires `mimetype` to come first
+  Path first() const;
+
+private:
+  class Impl;
+  const std::unique_ptr<Impl> impl;
+};
+
 class ZipWriter final : public WriteStorage {
 public:
   explicit ZipWriter(const Path &);
@@ -0,0 +1,118 @@
+#include <access/AsyncStream.h>
+#include <access/SpscQueue.h>
+#include <atomic>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+namespace odr {
+namespace access {
+
+namespace {
+constexpr std::size_t chunkSize = 65536;
+constexpr std::size_t queueCapacity = 16;
+} // namespace
+
+class AsyncOstream::Buf final : public std::streambuf {
+public:
+  explicit Buf(std::ostream &out)
+      : out_(out), queue_(queueCapacity), writer_([this] { write(); }) {
+    reset();
+  }
+
+  int overflow(const int c) final {
+    if (finished_ || failed_)
+      return traits_type::eof();
+    push();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() final {
+    if (finished_ || failed_)
+      return -1;
+    push();
+    return 0;
+  }
+
+  // false if writing to `out` failed at any point
+  bool finish() {
+    if (finished_)
+      return !failed_;
+    push();
+    finished_ = true;
+    // an empty chunk stops the writer
+    queue_.push(std::string());
+    writer_.join();
+    setp(nullptr, nullptr);
+    if (!failed_)
+      guarded_([this] { out_.flush(); });
+    return !failed_;
+  }
+
+private:
+  void reset() {
+    chunk_.resize(chunkSize);
+    setp(chunk_.data(), chunk_.data() + chunk_.size());
+  }
+
+  void push() {
+    const std::size_t size = pptr() - pbase();
+    if (size == 0)
+      return;
+    chunk_.resize(size);
+    queue_.push(std::move(chunk_));
+    chunk_ = std::string();
+    reset();
+  }
+
+  void write() {
+    while (true) {
+      const std::string chunk = queue_.pop();
+      if (chunk.empty())
+        break;
+      // after a failure the chunks are still drained so that the producer
+      // never blocks on a full queue
+      if (!failed_)
+        guarded_([&] { out_.write(chunk.data(), chunk.size()); });
+    }
+  }
+
+  // an exception must not leave the writer thread; it fails the stream
+  template <typename F> void guarded_(const F &f) {
+    try {
+      f();
+      if (!out_)
+        failed_ = true;
+    } catch (...) {
+      failed_ = true;
+    }
+  }
+
+  std::ostream &out_;
+  std::string chunk_;
+  SpscQueue<std::string> queue_;
+  bool finished_{false};
+  // set by the writer; seen by the producer at the latest in `finish`
+  std::atomic<bool> failed_{false};
+  // started last; everything it uses is initialized before
+  std::thread writer_;
+};
+
+AsyncOstream::AsyncOstream(std::ostream &out)
+    : std::ostream(nullptr), buf_(std::make_unique<Buf>(out)) {
+  rdbuf(buf_.get());
+}
+
+AsyncOstream::~AsyncOstream() { buf_->finish(); }
+
+void AsyncOstream::finish() {
+  if (!buf_->finish())
+    setstate(std::ios::badbit);
+}
+
+} // namespace access
+} // namespace odr
@@ -0,0 +1,162 @@
+#include <access/CachingStorage.h>
+#include <access/Path.h>
+#include <access/SharedStream.h>
+#include <access/StreamUtil.h>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace odr {
+namespace access {
+
+class CachingStorage::Impl final {
+public:
+  Impl(std::unique_ptr<ReadStorage> parent, const std::uint64_t budget)
+      : parent_(std::move(parent)), budget_(budget),
+        resident_(parent_->resident()) {}
+
+  std::unique_ptr<ReadStorage> release() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    size_ = 0;
+    return std::move(parent_);
+  }
+
+  const ReadStorage &parent() const noexcept { return *parent_; }
+
+  std::uint64_t cachedBytes() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  std::unique_ptr<std::istream> read(const PathView path) {
+    if (resident_)
+      return parent_->read(path);
+    if (auto data = find(path))
+      return std::make_unique<SharedIstream>(std::move(data));
+
+    if (parent_->size(path) > budget_)
+      return parent_->read(path);
+    auto in = parent_->read(path);
+    if (!in)
+      return nullptr;
+    // read without the lock; a concurrent miss on the same member only costs
+    // a second read
+    auto data = std::make_shared<const std::string>(StreamUtil::read(*in));
+    insert(path, data);
+    return std::make_unique<SharedIstream>(std::move(data));
+  }
+
+private:
+  struct Entry {
+    Path path;
+    std::size_t hash;
+    std::shared_ptr<const std::string> data;
+  };
+  using Lru = std::list<Entry>;
+
+  // hits neither allocate nor rehash the path
+  std::shared_ptr<const std::string> find(const PathView path) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto range = index_.equal_range(path.hash());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->path.string() != path.string())
+        continue;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->data;
+    }
+    return nullptr;
+  }
+
+  void insert(const PathView path,
+              const std::shared_ptr<const std::string> &data) {
+    if (data->size() > budget_)
+      return;
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto range = index_.equal_range(path.hash());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->path.string() == path.string())
+        return;
+    }
+    while (!lru_.empty() && (size_ + data->size() > budget_))
+      evict();
+    lru_.push_front(Entry{Path(path), path.hash(), data});
+    index_.emplace(path.hash(), lru_.begin());
+    size_ += data->size();
+  }
+
+  void evict() {
+    const auto last = std::prev(lru_.end());
+    const auto range = index_.equal_range(last->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == last) {
+        index_.erase(it);
+        break;
+      }
+    }
+    size_ -= last->data->size();
+    lru_.erase(last);
+  }
+
+  std::unique_ptr<ReadStorage> parent_;
+  const std::uint64_t budget_;
+  const bool resident_;
+
+  mutable std::mutex mutex_;
+  Lru lru_;
+  std::unordered_multimap<std::size_t, Lru::iterator> index_;
+  std::uint64_t size_{0};
+};
+
+CachingStorage::CachingStorage(std::unique_ptr<ReadStorage> parent,
+                               const std::uint64_t budget)
+    : impl_(std::make_unique<Impl>(std::move(parent), budget)) {}
+
+CachingStorage::~CachingStorage() = default;
+
+std::unique_ptr<ReadStorage> CachingStorage::release() {
+  return impl_->release();
+}
+
+std::uint64_t CachingStorage::cachedBytes() const {
+  return impl_->cachedBytes();
+}
+
+bool CachingStorage::isSomething(const PathView path) const {
+  return impl_->parent().isSomething(path);
+}
+
+bool CachingStorage::isFile(const PathView path) const {
+  return impl_->parent().isFile(path);
+}
+
+bool CachingStorage::isDirectory(const PathView path) const {
+  return impl_->parent().isDirectory(path);
+}
+
+bool CachingStorage::isReadable(const PathView path) const {
+  return impl_->parent().isReadable(path);
+}
+
+std::uint64_t CachingStorage::size(const PathView path) const {
+  return impl_->parent().size(path);
+}
+
+std::uint32_t CachingStorage::checksum(const PathView path) const {
+  return impl_->parent().checksum(path);
+}
+
+void CachingStorage::visit(Visitor visitor) const {
+  impl_->parent().visit(visitor);
+}
+
+std::unique_ptr<std::istream> CachingStorage::read(const PathView path) const {
+  return impl_->read(path);
+}
+
+} // namespace access
+} // namespace odr
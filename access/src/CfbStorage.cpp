@@ -6,8 +6,14 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <iterator>
 #include <locale>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace odr {
 namespace access {
@@ -93,7 +99,7 @@ public:
   CompoundFileReader(const void *buffer, const std::size_t len)
       : m_buffer(static_cast<const std::uint8_t *>(buffer)), m_bufferLen(len),
         m_hdr(static_cast<const CompoundFileHeader *>(buffer)),
-        m_sectorSize(512), m_miniSectorSize(64), m_miniStreamStartSector(0) {
+        m_sectorSize(512), m_miniSectorSize(64) {
     if (buffer == nullptr || len == 0)
       throw std::invalid_argument("");
 
@@ -108,11 +114,19 @@ public:
     if (m_bufferLen < m_sectorSize * 3)
       throw CfbFileCorruptedException();
 
+    // no chain can be longer than the number of sectors in the file; a longer
+    // one loops
+    m_sectorCount = m_bufferLen / m_sectorSize - 1;
+
+    m_FATSectors = GetFATSectors();
+    m_directorySectors = Chain(m_hdr->firstDirectorySectorLocation);
+
     const CompoundFileEntry *root = GetEntry(0);
     if (root == nullptr)
       throw CfbFileCorruptedException();
 
-    m_miniStreamStartSector = root->startSectorLocation;
+    m_miniStreamSectors = Chain(root->startSectorLocation);
+    m_miniFATSectors = Chain(m_hdr->firstMiniFATSectorLocation);
   }
 
   /// Get entry (directory or file) by its ID.
@@ -124,34 +138,62 @@ public:
       return nullptr;
     }
 
-    if (m_bufferLen / sizeof(CompoundFileEntry) <= entryID) {
-      throw std::invalid_argument("");
+    if (GetEntryCount() <= entryID) {
+      throw CfbFileCorruptedException();
     }
 
-    std::size_t sector = 0;
-    std::size_t offset = 0;
-    LocateFinalSector(m_hdr->firstDirectorySectorLocation,
-                      entryID * sizeof(CompoundFileEntry), &sector, &offset);
-    return reinterpret_cast<const CompoundFileEntry *>(
-        SectorOffsetToAddress(sector, offset));
+    const std::size_t offset = entryID * sizeof(CompoundFileEntry);
+    return reinterpret_cast<const CompoundFileEntry *>(SectorOffsetToAddress(
+        m_directorySectors[offset / m_sectorSize], offset % m_sectorSize));
   }
 
   const CompoundFileEntry *GetRootEntry() const { return GetEntry(0); }
 
   const CompoundFileHeader *GetFileInfo() const { return m_hdr; }
 
+  /// Get the sectors of a file(stream) in order. These are mini sectors if the
+  /// stream is stored in the mini stream.
+  std::vector<std::size_t> GetSectors(const CompoundFileEntry *entry) const {
+    // a stream can not be larger than the file containing it
+    if (entry->size > m_bufferLen)
+      throw CfbFileCorruptedException();
+
+    if (IsMini(entry)) {
+      const std::size_t count =
+          (entry->size + m_miniSectorSize - 1) / m_miniSectorSize;
+      return Chain(entry->startSectorLocation, count,
+                   [this](const std::size_t sector) {
+                     return GetNextMiniSector(sector);
+                   });
+    }
+    const std::size_t count = (entry->size + m_sectorSize - 1) / m_sectorSize;
+    return Chain(entry->startSectorLocation, count,
+                 [this](const std::size_t sector) {
+                   return GetNextSector(sector);
+                 });
+  }
+
   /// Get file(stream) data start with "offset".
   /// The buffer must have enough space to store "len" bytes. Typically "len" is
-  /// derived by the steam length.
-  void ReadFile(const CompoundFileEntry *entry, const std::size_t offset,
-                char *buffer, const std::size_t len) const {
+  /// derived by the steam length. "sectors" are the result of "GetSectors"
+  /// which should be kept for sequential reads.
+  void ReadFile(const CompoundFileEntry *entry,
+                const std::vector<std::size_t> &sectors,
+                const std::size_t offset, char *buffer,
+                const std::size_t len) const {
     if (entry->size < offset || entry->size - offset < len)
       throw std::invalid_argument("");
 
-    if (entry->size < m_hdr->miniStreamCutoffSize) {
-      ReadMiniStream(entry->startSectorLocation, offset, buffer, len);
+    if (IsMini(entry)) {
+      ReadStream(sectors, m_miniSectorSize, offset, buffer, len,
+                 [this](const std::size_t sector, const std::size_t offset) {
+                   return MiniSectorOffsetToAddress(sector, offset);
+                 });
     } else {
-      ReadStream(entry->startSectorLocation, offset, buffer, len);
+      ReadStream(sectors, m_sectorSize, offset, buffer, len,
+                 [this](const std::size_t sector, const std::size_t offset) {
+                   return SectorOffsetToAddress(sector, offset);
+                 });
     }
   }
 
@@ -166,95 +208,126 @@ public:
 
   void EnumFiles(const CompoundFileEntry *entry, int maxLevel,
                  EnumFilesCallback callback) const {
-    std::u16string dir;
-    EnumNodes(GetEntry(entry->childId), 0, maxLevel, dir, callback);
+    EnumNodes(entry->childId, maxLevel, callback);
   }
 
 private:
-  // Enum entries with same level, including 'entry' itself
-  void EnumNodes(const CompoundFileEntry *entry, const int currentLevel,
-                 const int maxLevel, const std::u16string &dir,
-                 EnumFilesCallback callback) const {
-    if (maxLevel > 0 && currentLevel >= maxLevel)
-      return;
-    if (entry == nullptr)
-      return;
-
-    callback(entry, dir, currentLevel + 1);
-
-    const CompoundFileEntry *child = GetEntry(entry->childId);
-    if (child != nullptr) {
-      std::u16string newDir = dir;
-      if (dir.length() != 0)
-        newDir.append(1, '\n');
-      newDir.append((char16_t *)entry->name, entry->nameLen / 2);
-      EnumNodes(GetEntry(entry->childId), currentLevel + 1, maxLevel, newDir,
-                callback);
-    }
-
-    EnumNodes(GetEntry(entry->leftSiblingId), currentLevel, maxLevel, dir,
-              callback);
-    EnumNodes(GetEntry(entry->rightSiblingId), currentLevel, maxLevel, dir,
-              callback);
+  bool IsMini(const CompoundFileEntry *entry) const {
+    return entry->size < m_hdr->miniStreamCutoffSize;
   }
 
-  void ReadStream(std::size_t sector, std::size_t offset, char *buffer,
-                  std::size_t len) const {
-    LocateFinalSector(sector, offset, &sector, &offset);
+  std::size_t GetEntryCount() const {
+    return m_directorySectors.size() *
+           (m_sectorSize / sizeof(CompoundFileEntry));
+  }
 
-    // copy as many as possible in each step
-    // copylen typically iterate as: m_sectorSize - offset   -->   m_sectorSize
-    // -->   m_sectorSize  --> ... -->    remaining
-    while (len > 0) {
-      const std::uint8_t *src = SectorOffsetToAddress(sector, offset);
-      std::size_t copylen = std::min(len, m_sectorSize - offset);
-      if (m_buffer + m_bufferLen < src + copylen)
+  // Enum the tree below the root with an explicit stack; an entry is visited
+  // at most once so that looping sibling or child ids terminate
+  void EnumNodes(const std::size_t rootID, const int maxLevel,
+                 EnumFilesCallback callback) const {
+    struct Node {
+      std::size_t id;
+      int level;
+      std::u16string dir;
+    };
+
+    std::vector<bool> visited(GetEntryCount());
+    std::vector<Node> stack;
+    stack.push_back({rootID, 0, {}});
+
+    while (!stack.empty()) {
+      Node node = std::move(stack.back());
+      stack.pop_back();
+
+      if (maxLevel > 0 && node.level >= maxLevel)
+        continue;
+      const CompoundFileEntry *entry = GetEntry(node.id);
+      if (entry == nullptr)
+        continue;
+      if (visited[node.id])
         throw CfbFileCorruptedException();
-
-      std::memcpy(buffer, src, copylen);
-      buffer += copylen;
-      len -= copylen;
-      sector = GetNextSector(sector);
-      offset = 0;
+      visited[node.id] = true;
+
+      callback(entry, node.dir, node.level + 1);
+
+      // the child tree comes first, then the left and the right siblings
+      stack.push_back({entry->rightSiblingId, node.level, node.dir});
+      stack.push_back({entry->leftSiblingId, node.level, node.dir});
+      if (entry->childId != 0xFFFFFFFF) {
+        std::u16string newDir = node.dir;
+        if (!newDir.empty())
+          newDir.append(1, '\n');
+        newDir.append((const char16_t *)entry->name,
+                      std::min<std::size_t>(entry->nameLen / 2, 32));
+        stack.push_back({entry->childId, node.level + 1, std::move(newDir)});
+      }
     }
   }
 
-  // Same logic as "ReadStream" except that use MiniStream functions instead
-  void ReadMiniStream(std::size_t sector, std::size_t offset, char *buffer,
-                      std::size_t len) const {
-    LocateFinalMiniSector(sector, offset, &sector, &offset);
+  template <typename Address>
+  void ReadStream(const std::vector<std::size_t> &sectors,
+                  const std::size_t sectorSize, std::size_t offset,
+                  char *buffer, std::size_t len, Address &&address) const {
+    std::size_t index = offset / sectorSize;
+    offset %= sectorSize;
 
     // copy as many as possible in each step
-    // copylen typically iterate as: m_sectorSize - offset   -->   m_sectorSize
-    // -->   m_sectorSize  --> ... -->    remaining
+    // copylen typically iterate as: sectorSize - offset   -->   sectorSize
+    // -->   sectorSize  --> ... -->    remaining
     while (len > 0) {
-      const std::uint8_t *src = MiniSectorOffsetToAddress(sector, offset);
-      std::size_t copylen = std::min(len, m_miniSectorSize - offset);
+      if (index >= sectors.size())
+        throw CfbFileCorruptedException();
+      const std::uint8_t *src = address(sectors[index], offset);
+      std::size_t copylen = std::min(len, sectorSize - offset);
       if (m_buffer + m_bufferLen < src + copylen)
         throw CfbFileCorruptedException();
 
       std::memcpy(buffer, src, copylen);
       buffer += copylen;
       len -= copylen;
-      sector = GetNextMiniSector(sector);
+      ++index;
       offset = 0;
     }
   }
 
+  // Follow a chain of at most "count" sectors until its end
+  template <typename Next>
+  std::vector<std::size_t> Chain(std::size_t sector, const std::size_t count,
+                                 Next &&next) const {
+    std::vector<std::size_t> result;
+    while (sector < MAX_REG_SECT && result.size() < count) {
+      result.push_back(sector);
+      sector = next(sector);
+    }
+    return result;
+  }
+
+  std::vector<std::size_t> Chain(const std::size_t sector) const {
+    auto result = Chain(sector, m_sectorCount + 1,
+                        [this](const std::size_t sector) {
+                          return GetNextSector(sector);
+                        });
+    if (result.size() > m_sectorCount)
+      throw CfbFileCorruptedException();
+    return result;
+  }
+
   std::size_t GetNextSector(std::size_t sector) const {
     // lookup FAT
     std::size_t entriesPerSector = m_sectorSize / 4;
     std::size_t fatSectorNumber = sector / entriesPerSector;
-    std::size_t fatSectorLocation = GetFATSectorLocation(fatSectorNumber);
-    return ParseUint32(SectorOffsetToAddress(fatSectorLocation,
+    if (fatSectorNumber >= m_FATSectors.size())
+      throw CfbFileCorruptedException();
+    return ParseUint32(SectorOffsetToAddress(m_FATSectors[fatSectorNumber],
                                              sector % entriesPerSector * 4));
   }
 
   std::size_t GetNextMiniSector(std::size_t miniSector) const {
-    std::size_t sector, offset;
-    LocateFinalSector(m_hdr->firstMiniFATSectorLocation, miniSector * 4,
-                      &sector, &offset);
-    return ParseUint32(SectorOffsetToAddress(sector, offset));
+    const std::size_t offset = miniSector * 4;
+    if (offset / m_sectorSize >= m_miniFATSectors.size())
+      throw CfbFileCorruptedException();
+    return ParseUint32(SectorOffsetToAddress(
+        m_miniFATSectors[offset / m_sectorSize], offset % m_sectorSize));
   }
 
   // Get absolute address from sector and offset.
@@ -271,57 +344,47 @@ private:
 
   const std::uint8_t *MiniSectorOffsetToAddress(std::size_t sector,
                                                 std::size_t offset) const {
-    if (sector >= MAX_REG_SECT || offset >= m_miniSectorSize ||
-        m_bufferLen <=
-            static_cast<std::uint64_t>(m_miniSectorSize) * sector + offset) {
+    if (sector >= MAX_REG_SECT || offset >= m_miniSectorSize) {
       throw CfbFileCorruptedException();
     }
 
-    LocateFinalSector(m_miniStreamStartSector,
-                      sector * m_miniSectorSize + offset, &sector, &offset);
-    return SectorOffsetToAddress(sector, offset);
-  }
-
-  // Locate the final sector/offset when original offset expands multiple
-  // sectors
-  void LocateFinalSector(std::size_t sector, std::size_t offset,
-                         std::size_t *finalSector,
-                         std::size_t *finalOffset) const {
-    while (offset >= m_sectorSize) {
-      offset -= m_sectorSize;
-      sector = GetNextSector(sector);
-    }
-    *finalSector = sector;
-    *finalOffset = offset;
+    offset += sector * m_miniSectorSize;
+    if (offset / m_sectorSize >= m_miniStreamSectors.size())
+      throw CfbFileCorruptedException();
+    return SectorOffsetToAddress(m_miniStreamSectors[offset / m_sectorSize],
+                                 offset % m_sectorSize);
   }
 
-  void LocateFinalMiniSector(std::size_t sector, std::size_t offset,
-                             std::size_t *finalSector,
-                             std::size_t *finalOffset) const {
-    while (offset >= m_miniSectorSize) {
-      offset -= m_miniSectorSize;
-      sector = GetNextMiniSector(sector);
-    }
-    *finalSector = sector;
-    *finalOffset = offset;
-  }
+  // Locations of the FAT sectors from the header and the DIFAT chain
+  std::vector<std::size_t> GetFATSectors() const {
+    const std::size_t count = m_hdr->numFATSector;
+    if (count > m_sectorCount)
+      throw CfbFileCorruptedException();
 
-  std::size_t GetFATSectorLocation(std::size_t fatSectorNumber) const {
-    if (fatSectorNumber < 109) {
-      return m_hdr->headerDIFAT[fatSectorNumber];
-    } else {
-      fatSectorNumber -= 109;
-      std::size_t entriesPerSector = m_sectorSize / 4 - 1;
-      std::size_t difatSectorLocation = m_hdr->firstDIFATSectorLocation;
-      while (fatSectorNumber >= entriesPerSector) {
-        fatSectorNumber -= entriesPerSector;
-        const std::uint8_t *addr =
-            SectorOffsetToAddress(difatSectorLocation, m_sectorSize - 4);
-        difatSectorLocation = ParseUint32(addr);
+    std::vector<std::size_t> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < std::min<std::size_t>(count, 109); ++i)
+      result.push_back(m_hdr->headerDIFAT[i]);
+
+    const std::size_t entriesPerSector = m_sectorSize / 4 - 1;
+    std::size_t difatSectorLocation = m_hdr->firstDIFATSectorLocation;
+    // a DIFAT sector which comes up twice means the chain loops
+    std::vector<bool> visited(m_sectorCount);
+    for (std::size_t difatSectors = 0; result.size() < count; ++difatSectors) {
+      if (difatSectors >= m_hdr->numDIFATSector ||
+          difatSectorLocation >= m_sectorCount ||
+          visited[difatSectorLocation])
+        throw CfbFileCorruptedException();
+      visited[difatSectorLocation] = true;
+      for (std::size_t i = 0; i < entriesPerSector && result.size() < count;
+           ++i) {
+        result.push_back(
+            ParseUint32(SectorOffsetToAddress(difatSectorLocation, i * 4)));
       }
-      return ParseUint32(
-          SectorOffsetToAddress(difatSectorLocation, fatSectorNumber * 4));
+      difatSectorLocation = ParseUint32(
+          SectorOffsetToAddress(difatSectorLocation, m_sectorSize - 4));
     }
+    return result;
   }
 
 private:
@@ -331,7 +394,12 @@ private:
   const CompoundFileHeader *m_hdr;
   std::size_t m_sectorSize;
   std::size_t m_miniSectorSize;
-  std::size_t m_miniStreamStartSector;
+  std::size_t m_sectorCount{0};
+  // chains which are used for every entry
+  std::vector<std::size_t> m_FATSectors;
+  std::vector<std::size_t> m_directorySectors;
+  std::vector<std::size_t> m_miniStreamSectors;
+  std::vector<std::size_t> m_miniFATSectors;
 };
 
 class PropertySet final {
@@ -421,7 +489,8 @@ class CfbReaderBuf final : public std::streambuf {
 public:
   CfbReaderBuf(const CFB::CompoundFileReader &reader,
                const CFB::CompoundFileEntry &entry)
-      : reader_(reader), entry_(entry), buffer_(new char[buffer_size_]) {}
+      : reader_(reader), entry_(entry), sectors_(reader.GetSectors(&entry)),
+        buffer_(new char[buffer_size_]) {}
 
   ~CfbReaderBuf() final { delete[] buffer_; }
 
@@ -431,7 +500,7 @@ public:
       return std::char_traits<char>::eof();
 
     const std::uint64_t amount = std::min(remaining, buffer_size_);
-    reader_.ReadFile(&entry_, offset_, buffer_, amount);
+    reader_.ReadFile(&entry_, sectors_, offset_, buffer_, amount);
     offset_ += amount;
     this->setg(this->buffer_, this->buffer_, this->buffer_ + amount);
 
@@ -441,6 +510,8 @@ public:
 private:
   const CFB::CompoundFileReader &reader_;
   const CFB::CompoundFileEntry &entry_;
+  // walked once instead of for every buffer
+  const std::vector<std::size_t> sectors_;
   std::uint64_t offset_{0};
   char *buffer_;
 };
@@ -464,8 +535,21 @@ typedef std::function<void(const CFB::CompoundFileEntry *, const Path &)>
 
 class CfbReader::Impl final {
 public:
+  explicit Impl(std::shared_ptr<const std::string> data)
+      : buffer(std::move(data)), reader(buffer->data(), buffer->size()) {
+    // names are decoded once so lookups are a binary search without
+    // conversions; of equal names the last one enumerated wins as before
+    visit([&](const CFB::CompoundFileEntry *entry, const Path &path) {
+      index.emplace_back(path.string(), entry);
+    });
+    std::stable_sort(index.begin(), index.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.first < b.first;
+                     });
+  }
+
   explicit Impl(const Path &path)
-      : buffer(FileUtil::read(path)), reader(buffer.data(), buffer.size()) {}
+      : Impl(std::make_shared<const std::string>(FileUtil::read(path))) {}
 
   void visit(CfbVisitor visitor) const {
     reader.EnumFiles(
@@ -476,36 +560,40 @@ public:
               convert;
           // TODO not sure what directory is; was empty so far
           // const std::string dir = convert.to_bytes(directory);
-          const std::string name = convert.to_bytes(std::u16string(
-              (const char16_t *)entry->name, (entry->nameLen - 1) / 2));
+          // the length includes the terminator and is not trusted
+          const std::size_t length =
+              std::min<std::size_t>(entry->nameLen / 2, 32);
+          const std::string name = convert.to_bytes(
+              std::u16string((const char16_t *)entry->name,
+                             (length > 0) ? length - 1 : 0));
           visitor(entry, Path(name));
         });
   }
 
-  const CFB::CompoundFileEntry *find(const Path &p) const {
-    const CFB::CompoundFileEntry *result = nullptr;
-    visit([&](const CFB::CompoundFileEntry *entry, const Path &path) {
-      if (p == path)
-        result = entry;
-    });
-    return result;
+  const CFB::CompoundFileEntry *find(const PathView p) const {
+    const auto it = std::upper_bound(
+        index.begin(), index.end(), p.string(),
+        [](const std::string_view a, const auto &b) { return a < b.first; });
+    if ((it == index.begin()) || (std::prev(it)->first != p.string()))
+      return nullptr;
+    return std::prev(it)->second;
   }
 
-  bool isSomething(const Path &p) const { return find(p) != nullptr; }
+  bool isSomething(const PathView p) const { return find(p) != nullptr; }
 
-  bool isFile(const Path &p) const {
+  bool isFile(const PathView p) const {
     const auto entry = find(p);
     return (entry != nullptr) && reader.IsStream(entry);
   }
 
-  bool isDirectory(const Path &p) const {
+  bool isDirectory(const PathView p) const {
     const auto entry = find(p);
     return (entry != nullptr) && !reader.IsStream(entry);
   }
 
-  bool isReadable(const Path &p) const { return isFile(p); }
+  bool isReadable(const PathView p) const { return isFile(p); }
 
-  std::uint64_t size(const Path &p) const {
+  std::uint64_t size(const PathView p) const {
     const auto entry = find(p);
     if (entry == nullptr)
       return 0; // TODO throw?
@@ -518,7 +606,7 @@ public:
     });
   }
 
-  std::unique_ptr<std::istream> read(const Path &p) const {
+  std::unique_ptr<std::istream> read(const PathView p) const {
     const auto entry = find(p);
     if (entry == nullptr)
       return nullptr;
@@ -526,35 +614,41 @@ public:
   }
 
 private:
-  std::string buffer;
+  std::shared_ptr<const std::string> buffer;
   CFB::CompoundFileReader reader;
+  std::vector<std::pair<std::string, const CFB::CompoundFileEntry *>> index;
 };
 
+CfbReader::CfbReader(std::shared_ptr<const std::string> data)
+    : impl(std::make_unique<Impl>(std::move(data))) {}
+
 CfbReader::CfbReader(const Path &path) : impl(std::make_unique<Impl>(path)) {}
 
 CfbReader::~CfbReader() = default;
 
-bool CfbReader::isSomething(const Path &path) const {
+bool CfbReader::isSomething(const PathView path) const {
   return impl->isSomething(path);
 }
 
-bool CfbReader::isFile(const Path &path) const { return impl->isFile(path); }
+bool CfbReader::isFile(const PathView path) const {
+  return impl->isFile(path);
+}
 
-bool CfbReader::isDirectory(const Path &path) const {
+bool CfbReader::isDirectory(const PathView path) const {
   return impl->isDirectory(path);
 }
 
-bool CfbReader::isReadable(const Path &path) const {
+bool CfbReader::isReadable(const PathView path) const {
   return impl->isReadable(path);
 }
 
-std::uint64_t CfbReader::size(const Path &path) const {
+std::uint64_t CfbReader::size(const PathView path) const {
   return impl->size(path);
 }
 
 void CfbReader::visit(Visitor visitor) const { impl->visit(visitor); }
 
-std::unique_ptr<std::istream> CfbReader::read(const Path &path) const {
+std::unique_ptr<std::istream> CfbReader::read(const PathView path) const {
   return impl->read(path);
 }
 
@@ -10,28 +10,32 @@ ChildStorage::ChildStorage(const Storage &parent, const Path prefix)
 
 // TODO throw on escaping path
 
-bool ChildStorage::isSomething(const Path &path) const {
-  return parent_.isSomething(prefix_.join(path));
+bool ChildStorage::isSomething(const PathView path) const {
+  return parent_.isSomething(prefix_.join(Path(path)));
 }
 
-bool ChildStorage::isFile(const Path &path) const {
-  return parent_.isFile(prefix_.join(path));
+bool ChildStorage::isFile(const PathView path) const {
+  return parent_.isFile(prefix_.join(Path(path)));
 }
 
-bool ChildStorage::isDirectory(const Path &path) const {
-  return parent_.isFile(prefix_.join(path));
+bool ChildStorage::isDirectory(const PathView path) const {
+  return parent_.isFile(prefix_.join(Path(path)));
 }
 
-bool ChildStorage::isReadable(const Path &path) const {
-  return parent_.isFile(prefix_.join(path));
+bool ChildStorage::isReadable(const PathView path) const {
+  return parent_.isFile(prefix_.join(Path(path)));
 }
 
 bool ChildStorage::isWriteable(const Path &path) const {
   return parent_.isFile(prefix_.join(path));
 }
 
-std::uint64_t ChildStorage::size(const Path &path) const {
-  return parent_.size(prefix_.join(path));
+std::uint64_t ChildStorage::size(const PathView path) const {
+  return parent_.size(prefix_.join(Path(path)));
+}
+
+std::uint32_t ChildStorage::checksum(const PathView path) const {
+  return parent_.checksum(prefix_.join(Path(path)));
 }
 
 bool ChildStorage::remove(const Path &path) const {
@@ -58,8 +62,8 @@ void ChildStorage::visit(Visitor visiter) const {
   });
 }
 
-std::unique_ptr<std::istream> ChildStorage::read(const Path &path) const {
-  return parent_.read(prefix_.join(path));
+std::unique_ptr<std::istream> ChildStorage::read(const PathView path) const {
+  return parent_.read(prefix_.join(Path(path)));
 }
 
 std::unique_ptr<std::ostream> ChildStorage::write(const Path &path) const {
@@ -0,0 +1,40 @@
+#include <access/Diagnostics.h>
+#include <algorithm>
+
+namespace odr {
+namespace access {
+
+void Diagnostics::report(const char *category) {
+  auto &&diagnostic = diagnostics_[category];
+  if (diagnostic.count == 0)
+    diagnostic.category = category;
+  ++diagnostic.count;
+}
+
+void Diagnostics::report(const char *category, const std::string_view sample) {
+  auto &&diagnostic = diagnostics_[category];
+  if (diagnostic.count == 0)
+    diagnostic.category = category;
+  ++diagnostic.count;
+  if (diagnostic.samples.size() < maxSamples)
+    diagnostic.samples.emplace_back(sample);
+}
+
+bool Diagnostics::empty() const noexcept { return diagnostics_.empty(); }
+
+void Diagnostics::clear() noexcept { diagnostics_.clear(); }
+
+std::vector<Diagnostic> Diagnostics::summary() const {
+  std::vector<Diagnostic> result;
+  result.reserve(diagnostics_.size());
+  for (auto &&diagnostic : diagnostics_)
+    result.push_back(diagnostic.second);
+  std::sort(result.begin(), result.end(),
+            [](const Diagnostic &a, const Diagnostic &b) {
+              return a.category < b.category;
+            });
+  return result;
+}
+
+} // namespace access
+} // namespace odr
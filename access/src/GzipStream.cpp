@@ -0,0 +1,110 @@
+#include <access/GzipStream.h>
+#include <miniz.h>
+#include <streambuf>
+
+namespace odr {
+namespace access {
+
+namespace {
+constexpr std::size_t bufferSize = 16384;
+constexpr int windowBits = 15;
+
+void writeLittleEndian(std::ostream &out, const std::uint32_t value) {
+  const char bytes[4] = {
+      static_cast<char>(value & 0xff),
+      static_cast<char>((value >> 8) & 0xff),
+      static_cast<char>((value >> 16) & 0xff),
+      static_cast<char>((value >> 24) & 0xff),
+  };
+  out.write(bytes, sizeof(bytes));
+}
+} // namespace
+
+class GzipOstream::Buf final : public std::streambuf {
+public:
+  Buf(std::ostream &out, const int level)
+      : out_(out), compressor_(tdefl_compressor_alloc()),
+        buffer_(new char[bufferSize]) {
+    // negative window bits select raw deflate; the framing is ours
+    const mz_uint flags =
+        tdefl_create_comp_flags_from_zip_params(level, -windowBits, 0);
+    tdefl_init(compressor_, put, this, flags);
+
+    // magic, deflate, no flags, no mtime, no extra flags, unknown os
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0,
+                                    '\xff'};
+    out_.write(header, sizeof(header));
+    setp(buffer_, buffer_ + bufferSize);
+  }
+
+  ~Buf() final {
+    tdefl_compressor_free(compressor_);
+    delete[] buffer_;
+  }
+
+  int overflow(const int c) final {
+    if (finished_ || !compress(TDEFL_NO_FLUSH))
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() final {
+    // a sync flush lets the reader decode everything written so far
+    if (finished_ || !compress(TDEFL_SYNC_FLUSH))
+      return -1;
+    out_.flush();
+    return 0;
+  }
+
+  void finish() {
+    if (finished_)
+      return;
+    compress(TDEFL_FINISH);
+    finished_ = true;
+    writeLittleEndian(out_, crc_);
+    writeLittleEndian(out_, size_);
+    out_.flush();
+  }
+
+private:
+  std::ostream &out_;
+  tdefl_compressor *compressor_;
+  char *buffer_;
+  mz_ulong crc_{MZ_CRC32_INIT};
+  // size modulo 2^32 as required by the trailer
+  std::uint32_t size_{0};
+  bool finished_{false};
+
+  static mz_bool put(const void *data, const int length, void *user) {
+    auto &out = static_cast<Buf *>(user)->out_;
+    out.write(static_cast<const char *>(data), length);
+    return out.good() ? MZ_TRUE : MZ_FALSE;
+  }
+
+  bool compress(const tdefl_flush flush) {
+    const std::size_t length = pptr() - pbase();
+    crc_ = mz_crc32(crc_, reinterpret_cast<const unsigned char *>(pbase()),
+                    length);
+    size_ += static_cast<std::uint32_t>(length);
+    const tdefl_status status =
+        tdefl_compress_buffer(compressor_, pbase(), length, flush);
+    setp(buffer_, buffer_ + bufferSize);
+    return (status == TDEFL_STATUS_OKAY) || (status == TDEFL_STATUS_DONE);
+  }
+};
+
+GzipOstream::GzipOstream(std::ostream &out, const int level)
+    : std::ostream(nullptr), buf_(std::make_unique<Buf>(out, level)) {
+  rdbuf(buf_.get());
+}
+
+GzipOstream::~GzipOstream() { finish(); }
+
+void GzipOstream::finish() { buf_->finish(); }
+
+} // namespace access
+} // namespace odr
@@ -7,9 +7,13 @@ namespace access {
 
 Path::Path() noexcept : Path("") {}
 
-Path::Path(const char *path) : Path(std::string(path)) {}
+Path::Path(const char *path) { assign_(path); }
 
-Path::Path(const std::string &path) {
+Path::Path(const std::string &path) { assign_(path); }
+
+Path::Path(const PathView path) { assign_(path.string()); }
+
+void Path::assign_(const std::string_view path) {
   // TODO throw on illegal chars
   // TODO remove forward slash
   if (path.rfind("/..", 0) == 0)
@@ -17,51 +21,53 @@ Path::Path(const std::string &path) {
 
   absolute_ = !path.empty() && (path[0] == '/');
   path_ = absolute_ ? "/" : "";
+  path_.reserve(path.size());
   upwards_ = 0;
   downwards_ = 0;
 
   std::size_t pos = absolute_ ? 1 : 0;
   while (pos < path.size()) {
     std::size_t next = path.find('/', pos);
-    if (next == std::string::npos)
+    if (next == std::string_view::npos)
       next = path.size();
     join_(path.substr(pos, next - pos));
     pos = next + 1;
   }
+  hash_ = PathView::hash(path_);
 }
 
 void Path::parent_() {
   if (downwards_ > 0) {
     --downwards_;
     if (downwards_ == 0)
-      path_ = "";
-    else {
-      const auto pos = path_.rfind('/');
-      path_ = path_.substr(0, pos);
-    }
+      // keeps the leading slash or the `../` of each upward step
+      path_.resize(absolute_ ? 1 : 3 * upwards_);
+    else
+      path_.resize(path_.rfind('/'));
   } else if (!absolute_) {
     ++upwards_;
-    path_ = "../" + path_;
+    path_.insert(0, "../");
   } else {
     throw std::invalid_argument("absolute path violation");
   }
 }
 
-void Path::join_(const std::string &child) {
+void Path::join_(const std::string_view child) {
   if (child == ".")
     return;
   if (child == "..")
     parent_();
   else {
-    if (downwards_ == 0)
-      path_ += child;
-    else
-      path_ += "/" + child;
+    if (downwards_ != 0)
+      path_ += '/';
+    path_ += child;
     ++downwards_;
   }
 }
 
 bool Path::operator==(const Path &b) const noexcept {
+  if (hash_ != b.hash_)
+    return false;
   if (absolute_ != b.absolute_)
     return false;
   if (!absolute_ && (upwards_ != b.upwards_))
@@ -70,6 +76,8 @@ bool Path::operator==(const Path &b) const noexcept {
 }
 
 bool Path::operator!=(const Path &b) const noexcept {
+  if (hash_ != b.hash_)
+    return true;
   if (absolute_ != b.absolute_)
     return true;
   if (!absolute_ && (upwards_ != b.upwards_))
@@ -78,13 +86,11 @@ bool Path::operator!=(const Path &b) const noexcept {
 }
 
 bool Path::operator<(const Path &b) const noexcept {
-  // TODO could be improved
-  return path_ < b.path_;
+  return PathView(*this).compare(b) < 0;
 }
 
 bool Path::operator>(const Path &b) const noexcept {
-  // TODO could be improved
-  return path_ > b.path_;
+  return PathView(*this).compare(b) > 0;
 }
 
 Path::operator std::string() const noexcept { return path_; }
@@ -93,9 +99,7 @@ Path::operator const std::string &() const noexcept { return path_; }
 
 const std::string &Path::string() const noexcept { return path_; }
 
-std::size_t Path::hash() const noexcept {
-  return std::hash<std::string>{}(path_);
-}
+std::size_t Path::hash() const noexcept { return hash_; }
 
 bool Path::root() const noexcept {
   return (upwards_ == 0) && (downwards_ == 0);
@@ -111,7 +115,7 @@ bool Path::parentOf(const Path &b) const {
   if (absolute_ != b.absolute_)
     throw std::invalid_argument("cannot compare absolute and relative path");
   // TODO we need to check upwards as well
-  return (downwards_ + 1 == b.downwards_) && (b.path_.rfind(path_, 0) == 0);
+  return (downwards_ + 1 == b.downwards_) && PathView(b).startsWith(*this);
 }
 
 bool Path::ancestorOf(const Path &b) const { return b.descendantOf(*this); }
@@ -120,7 +124,7 @@ bool Path::descendantOf(const Path &b) const {
   if (absolute_ != b.absolute_)
     throw std::invalid_argument("cannot compare absolute and relative path");
   // TODO we need to check upwards as well
-  return (downwards_ < b.downwards_) && (b.path_.rfind(path_, 0) == 0);
+  return (downwards_ < b.downwards_) && PathView(b).startsWith(*this);
 }
 
 std::string Path::basename() const noexcept {
@@ -141,15 +145,27 @@ std::string Path::extension() const noexcept {
 Path Path::parent() const {
   Path result(*this);
   result.parent_();
+  result.hash_ = PathView::hash(result.path_);
   return result;
 }
 
 Path Path::join(const Path &b) const {
   if (b.absolute_)
     throw std::invalid_argument("cannot join an absolute path");
-  // TODO could be done directly
-  const std::string result = path_ + "/" + b.path_;
-  return Path(result);
+  // `b` is normalized already, so its segments apply one by one
+  Path result(*this);
+  result.path_.reserve(path_.size() + 1 + b.path_.size());
+  const std::string_view segments = b.path_;
+  std::size_t pos = 0;
+  while (pos < segments.size()) {
+    std::size_t next = segments.find('/', pos);
+    if (next == std::string_view::npos)
+      next = segments.size();
+    result.join_(segments.substr(pos, next - pos));
+    pos = next + 1;
+  }
+  result.hash_ = PathView::hash(result.path_);
+  return result;
 }
 
 Path Path::rebase(const Path &on) const {
@@ -163,5 +179,34 @@ std::ostream &operator<<(std::ostream &os, const Path &p) {
   return os << p.path_;
 }
 
+int PathView::compare(const PathView b) const noexcept {
+  const std::size_t size = std::min(path_.size(), b.path_.size());
+  for (std::size_t i = 0; i < size; ++i) {
+    if (path_[i] == b.path_[i])
+      continue;
+    if (path_[i] == '/')
+      return -1;
+    if (b.path_[i] == '/')
+      return 1;
+    return static_cast<unsigned char>(path_[i]) <
+                   static_cast<unsigned char>(b.path_[i])
+               ? -1
+               : 1;
+  }
+  if (path_.size() == b.path_.size())
+    return 0;
+  return path_.size() < b.path_.size() ? -1 : 1;
+}
+
+bool PathView::startsWith(const PathView prefix) const noexcept {
+  if (path_.compare(0, prefix.path_.size(), prefix.path_) != 0)
+    return false;
+  // the root and the empty path are prefixes of everything below them
+  if ((prefix.path_.size() == path_.size()) || prefix.path_.empty() ||
+      (prefix.path_.back() == '/'))
+    return true;
+  return path_[prefix.path_.size()] == '/';
+}
+
 } // namespace access
 } // namespace odr
@@ -0,0 +1,283 @@
+#include <access/FileUtil.h>
+#include <access/Prefetcher.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#ifdef ODR_IO_URING
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <liburing.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace odr {
+namespace access {
+
+namespace {
+void readFile(Prefetcher::File &file) {
+  try {
+    file.data = FileUtil::read(file.path);
+  } catch (const std::exception &e) {
+    file.error = e.what();
+  }
+}
+
+#ifdef ODR_IO_URING
+constexpr std::size_t maxRound = 256;
+// a single read is capped by the kernel anyway; the rest is read again
+constexpr std::size_t maxRead = 1u << 30;
+
+// submits the reads of a whole round before waiting for any of them, so the
+// device sees the full queue depth and can merge and reorder them. falls back
+// to plain reads if the kernel refuses to set up a ring or the ring breaks
+class RoundReader final {
+public:
+  explicit RoundReader(const std::size_t depth)
+      : limit_(std::min(std::max<std::size_t>(depth, 1), maxRound)) {
+    ring_ok_ = io_uring_queue_init(limit_, &ring_, 0) == 0;
+  }
+
+  ~RoundReader() {
+    if (ring_ok_)
+      io_uring_queue_exit(&ring_);
+  }
+
+  std::size_t limit() const { return ring_ok_ ? limit_ : 1; }
+
+  void read(Prefetcher::File *files, const std::size_t count) {
+    if (!ring_ok_) {
+      for (std::size_t i = 0; i < count; ++i)
+        readFile(files[i]);
+      return;
+    }
+
+    std::vector<Pending> pending(count);
+    std::size_t inFlight = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (open(files[i], pending[i])) {
+        submit(files, pending, i);
+        ++inFlight;
+      }
+    }
+    io_uring_submit(&ring_);
+
+    while (inFlight > 0) {
+      io_uring_cqe *cqe = nullptr;
+      const int error = io_uring_wait_cqe(&ring_, &cqe);
+      if (error == -EINTR)
+        continue;
+      if (error < 0) {
+        abandon(files, pending, count, -error);
+        return;
+      }
+      const auto i =
+          reinterpret_cast<std::uintptr_t>(io_uring_cqe_get_data(cqe));
+      const int result = cqe->res;
+      io_uring_cqe_seen(&ring_, cqe);
+
+      Prefetcher::File &file = files[i];
+      if (result < 0) {
+        file.error = std::strerror(-result);
+        file.data.clear();
+      } else if (result == 0) {
+        // the file shrank since it was opened
+        file.data.resize(pending[i].offset);
+      } else {
+        pending[i].offset += result;
+        if (pending[i].offset < file.data.size()) {
+          submit(files, pending, i);
+          io_uring_submit(&ring_);
+          continue;
+        }
+      }
+      ::close(pending[i].fd);
+      pending[i].fd = -1;
+      --inFlight;
+    }
+  }
+
+private:
+  struct Pending {
+    int fd{-1};
+    std::size_t offset{0};
+  };
+
+  static bool open(Prefetcher::File &file, Pending &pending) {
+    const int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      file.error = std::strerror(errno);
+      return false;
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+      file.error = std::strerror(errno);
+      ::close(fd);
+      return false;
+    }
+    try {
+      file.data.resize(status.st_size);
+    } catch (const std::exception &e) {
+      file.error = e.what();
+      ::close(fd);
+      return false;
+    }
+    if (file.data.empty()) {
+      ::close(fd);
+      return false;
+    }
+    pending.fd = fd;
+    return true;
+  }
+
+  // the reads still in flight may write into their buffers at any time, so
+  // those are kept here instead of being handed out. their files fail and
+  // later rounds use plain reads
+  void abandon(Prefetcher::File *files, std::vector<Pending> &pending,
+               const std::size_t count, const int error) {
+    io_uring_queue_exit(&ring_);
+    ring_ok_ = false;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (pending[i].fd < 0)
+        continue;
+      ::close(pending[i].fd);
+      abandoned_.push_back(std::move(files[i].data));
+      files[i].data.clear();
+      files[i].error = std::strerror(error);
+    }
+  }
+
+  void submit(Prefetcher::File *files, std::vector<Pending> &pending,
+              const std::size_t i) {
+    // at most one read per file is queued, so the ring cannot be full
+    io_uring_sqe *sqe = io_uring_get_sqe(&ring_);
+    const std::size_t offset = pending[i].offset;
+    const std::size_t length =
+        std::min(files[i].data.size() - offset, maxRead);
+    io_uring_prep_read(sqe, pending[i].fd, &files[i].data[offset], length,
+                       offset);
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(i));
+  }
+
+  const std::size_t limit_;
+  bool ring_ok_{false};
+  io_uring ring_{};
+  std::vector<std::string> abandoned_;
+};
+#else
+// one read after the other; the disk still overlaps with the workers but
+// sees a single request at a time
+class RoundReader final {
+public:
+  explicit RoundReader(std::size_t) {}
+
+  std::size_t limit() const { return 1; }
+
+  void read(Prefetcher::File *files, const std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i)
+      readFile(files[i]);
+  }
+};
+#endif
+} // namespace
+
+class Prefetcher::Impl final {
+public:
+  Impl(std::vector<std::string> paths, const std::size_t depth)
+      : paths_(std::move(paths)), depth_(std::max<std::size_t>(depth, 1)),
+        reader_(depth_), thread_([this] { run(); }) {}
+
+  ~Impl() {
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    space_.notify_all();
+    thread_.join();
+  }
+
+  bool next(File &file) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [&] { return done_ || !ready_.empty(); });
+    if (ready_.empty())
+      return false;
+    file = std::move(ready_.front());
+    ready_.pop_front();
+    lock.unlock();
+    space_.notify_one();
+    return true;
+  }
+
+private:
+  void run() {
+    std::vector<File> round;
+    for (std::size_t begin = 0; begin < paths_.size();) {
+      std::size_t count;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_.wait(lock, [&] { return stopped_ || ready_.size() < depth_; });
+        if (stopped_)
+          break;
+        count = std::min({depth_ - ready_.size(), paths_.size() - begin,
+                          reader_.limit()});
+      }
+
+      round.resize(count);
+      for (std::size_t i = 0; i < count; ++i)
+        round[i] = File{begin + i, paths_[begin + i], {}, {}};
+      try {
+        reader_.read(round.data(), count);
+      } catch (const std::exception &e) {
+        // only the bookkeeping before the first read can throw; every file
+        // reports the failure instead of taking down the process
+        for (auto &&file : round) {
+          file.data.clear();
+          file.error = e.what();
+        }
+      }
+      begin += count;
+
+      {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &&file : round)
+          ready_.push_back(std::move(file));
+      }
+      available_.notify_all();
+    }
+
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    available_.notify_all();
+  }
+
+  const std::vector<std::string> paths_;
+  const std::size_t depth_;
+  RoundReader reader_;
+
+  std::mutex mutex_;
+  std::condition_variable available_;
+  std::condition_variable space_;
+  std::deque<File> ready_;
+  bool stopped_{false};
+  bool done_{false};
+
+  std::thread thread_;
+};
+
+Prefetcher::Prefetcher(std::vector<std::string> paths, const std::size_t depth)
+    : impl_(std::make_unique<Impl>(std::move(paths), depth)) {}
+
+Prefetcher::~Prefetcher() = default;
+
+bool Prefetcher::next(File &file) { return impl_->next(file); }
+
+} // namespace access
+} // namespace odr
@@ -0,0 +1,51 @@
+#include <access/SharedStream.h>
+#include <streambuf>
+#include <utility>
+
+namespace odr {
+namespace access {
+
+class SharedIstream::Buf final : public std::streambuf {
+public:
+  explicit Buf(std::shared_ptr<const std::string> data)
+      : data_(std::move(data)) {
+    char *begin = const_cast<char *>(data_->data());
+    setg(begin, begin, begin + data_->size());
+  }
+
+protected:
+  pos_type seekoff(const off_type off, const std::ios_base::seekdir dir,
+                   const std::ios_base::openmode which) final {
+    if (!(which & std::ios_base::in))
+      return pos_type(off_type(-1));
+    off_type base = gptr() - eback();
+    if (dir == std::ios_base::beg)
+      base = 0;
+    else if (dir == std::ios_base::end)
+      base = egptr() - eback();
+    return seekpos(pos_type(base + off), which);
+  }
+
+  pos_type seekpos(const pos_type pos,
+                   const std::ios_base::openmode which) final {
+    const off_type off = pos;
+    if (!(which & std::ios_base::in) || (off < 0) ||
+        (off > egptr() - eback()))
+      return pos_type(off_type(-1));
+    setg(eback(), eback() + off, egptr());
+    return pos;
+  }
+
+private:
+  const std::shared_ptr<const std::string> data_;
+};
+
+SharedIstream::SharedIstream(std::shared_ptr<const std::string> data)
+    : std::istream(nullptr), buf_(std::make_unique<Buf>(std::move(data))) {
+  rdbuf(buf_.get());
+}
+
+SharedIstream::~SharedIstream() = default;
+
+} // namespace access
+} // namespace odr
@@ -5,7 +5,7 @@
 namespace odr {
 namespace access {
 
-std::string StorageUtil::read(const ReadStorage &storage, const Path &path) {
+std::string StorageUtil::read(const ReadStorage &storage, const PathView path) {
   std::string result;
   auto in = storage.read(path);
   return StreamUtil::read(*in);
@@ -9,19 +9,19 @@ const SystemStorage &SystemStorage::instance() {
   return instance;
 }
 
-bool SystemStorage::isSomething(const Path &) const {
+bool SystemStorage::isSomething(PathView) const {
   return false; // TODO
 }
 
-bool SystemStorage::isFile(const Path &) const {
+bool SystemStorage::isFile(PathView) const {
   return false; // TODO
 }
 
-bool SystemStorage::isDirectory(const Path &) const {
+bool SystemStorage::isDirectory(PathView) const {
   return false; // TODO
 }
 
-bool SystemStorage::isReadable(const Path &) const {
+bool SystemStorage::isReadable(PathView) const {
   return false; // TODO
 }
 
@@ -29,7 +29,7 @@ bool SystemStorage::isWriteable(const Path &) const {
   return false; // TODO
 }
 
-std::uint64_t SystemStorage::size(const Path &) const {
+std::uint64_t SystemStorage::size(PathView) const {
   return 0; // TODO
 }
 
@@ -53,7 +53,7 @@ void SystemStorage::visit(Visitor) const {
   // TODO
 }
 
-std::unique_ptr<std::istream> SystemStorage::read(const Path &) const {
+std::unique_ptr<std::istream> SystemStorage::read(PathView) const {
   return nullptr; // TODO
 }
 
@@ -0,0 +1,116 @@
+#include <access/Trace.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace odr {
+namespace access {
+
+namespace {
+struct Event {
+  const char *name;
+  std::string path;
+  std::int64_t index;
+  std::int64_t begin;
+  std::int64_t duration;
+  std::uint32_t thread;
+};
+
+std::atomic<bool> enabled_{false};
+std::mutex mutex_;
+std::vector<Event> events_;
+std::chrono::steady_clock::time_point epoch_;
+std::atomic<std::uint32_t> threads_{0};
+
+std::int64_t now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - epoch_)
+      .count();
+}
+
+// small sequential ids read better in the viewer than hashed thread ids
+std::uint32_t thread() {
+  thread_local const std::uint32_t id = ++threads_;
+  return id;
+}
+
+void writeString(std::ostream &out, const std::string &string) {
+  out << '"';
+  for (auto &&c : string) {
+    if ((c == '"') || (c == '\\'))
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      out << ' ';
+    else
+      out << c;
+  }
+  out << '"';
+}
+} // namespace
+
+void Trace::start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  epoch_ = std::chrono::steady_clock::now();
+  enabled_ = true;
+}
+
+void Trace::stop(std::ostream &out) {
+  enabled_ = false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  out << "{\"traceEvents\":[";
+  for (auto &&event : events_) {
+    if (&event != &events_.front())
+      out << ",";
+    out << "{\"name\":";
+    writeString(out, event.name);
+    out << ",\"cat\":\"odr\",\"ph\":\"X\"";
+    out << ",\"ts\":" << event.begin;
+    out << ",\"dur\":" << event.duration;
+    out << ",\"pid\":1,\"tid\":" << event.thread;
+    out << ",\"args\":{";
+    if (!event.path.empty()) {
+      out << "\"path\":";
+      writeString(out, event.path);
+    }
+    if (event.index >= 0) {
+      if (!event.path.empty())
+        out << ",";
+      out << "\"index\":" << event.index;
+    }
+    out << "}}";
+  }
+  out << "],\"displayTimeUnit\":\"ms\"}";
+  events_.clear();
+}
+
+bool Trace::enabled() noexcept {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+Trace::Span::Span(const char *name) : name_(name) {
+  if (enabled())
+    begin_ = now();
+}
+
+Trace::Span::Span(const char *name, const std::string_view path,
+                  const std::int64_t index)
+    : name_(name), index_(index) {
+  if (!enabled())
+    return;
+  path_ = path;
+  begin_ = now();
+}
+
+Trace::Span::~Span() {
+  if ((begin_ < 0) || !enabled())
+    return;
+  const std::int64_t end = now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back({name_, std::move(path_), index_, begin_, end - begin_,
+                     thread()});
+}
+
+} // namespace access
+} // namespace odr
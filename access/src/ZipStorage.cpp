@@ -1,5 +1,7 @@
 #include <access/Path.h>
+#include <access/Trace.h>
 #include <access/ZipStorage.h>
+#include <memory>
 #include <miniz.h>
 #include <sstream>
 #include <streambuf>
@@ -13,11 +15,14 @@ constexpr std::uint64_t buffer_size_ = 4098;
 
 class ZipReaderBuf final : public std::streambuf {
 public:
-  explicit ZipReaderBuf(mz_zip_reader_extract_iter_state *iter)
+  ZipReaderBuf(mz_zip_reader_extract_iter_state *iter, const PathView path)
       : iter_(iter), remaining_(iter->file_stat.m_uncomp_size),
-        buffer_(new char[buffer_size_]) {}
+        buffer_(new char[buffer_size_]), span_("zip", path.string()) {}
 
-  ~ZipReaderBuf() final { delete[] buffer_; }
+  ~ZipReaderBuf() final {
+    mz_zip_reader_extract_iter_free(iter_);
+    delete[] buffer_;
+  }
 
   int underflow() final {
     if (remaining_ <= 0)
@@ -36,6 +41,8 @@ private:
   mz_zip_reader_extract_iter_state *iter_;
   std::uint64_t remaining_;
   char *buffer_;
+  // the member is inflated while it is read
+  const Trace::Span span_;
 };
 
 class ZipWriterBuf final : public std::stringbuf {
@@ -57,8 +64,9 @@ private:
 
 class ZipReaderIstream final : public std::istream {
 public:
-  explicit ZipReaderIstream(mz_zip_reader_extract_iter_state *iter)
-      : ZipReaderIstream(new ZipReaderBuf(iter)) {}
+  ZipReaderIstream(mz_zip_reader_extract_iter_state *iter,
+                   const PathView path)
+      : ZipReaderIstream(new ZipReaderBuf(iter, path)) {}
   explicit ZipReaderIstream(ZipReaderBuf *sbuf)
       : std::istream(sbuf), sbuf_(sbuf) {}
   ~ZipReaderIstream() final { delete sbuf_; }
@@ -84,8 +92,8 @@ class ZipReader::Impl final {
 public:
   Impl(const void *mem, const std::uint64_t size) {
     memset(&zip, 0, sizeof(zip));
-    const mz_bool status = mz_zip_reader_init_mem(
-        &zip, mem, size, MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
+    // the sorted central directory makes lookups logarithmic
+    const mz_bool status = mz_zip_reader_init_mem(&zip, mem, size, 0);
     if (!status)
       throw NoZipFileException("memory");
   }
@@ -93,62 +101,76 @@ public:
   explicit Impl(std::string data) : buffer(std::move(data)) {
     memset(&zip, 0, sizeof(zip));
     const mz_bool status =
-        mz_zip_reader_init_mem(&zip, buffer.data(), buffer.size(),
-                               MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
+        mz_zip_reader_init_mem(&zip, buffer.data(), buffer.size(), 0);
+    if (!status)
+      throw NoZipFileException("memory");
+  }
+
+  explicit Impl(std::shared_ptr<const std::string> data)
+      : shared(std::move(data)) {
+    memset(&zip, 0, sizeof(zip));
+    const mz_bool status =
+        mz_zip_reader_init_mem(&zip, shared->data(), shared->size(), 0);
     if (!status)
       throw NoZipFileException("memory");
   }
 
   explicit Impl(const Path &path) {
     memset(&zip, 0, sizeof(zip));
-    const mz_bool status = mz_zip_reader_init_file(
-        &zip, path.string().data(), MZ_ZIP_FLAG_DO_NOT_SORT_CENTRAL_DIRECTORY);
+    const mz_bool status =
+        mz_zip_reader_init_file(&zip, path.string().data(), 0);
     if (!status)
       throw NoZipFileException(path.string());
   }
 
   ~Impl() { mz_zip_reader_end(&zip); }
 
-  bool stat(const std::string &path,
-            mz_zip_archive_file_stat &result) noexcept {
+  bool stat(const PathView path, mz_zip_archive_file_stat &result) noexcept {
     mz_uint i;
     if (!find(path, i))
       return false;
     return mz_zip_reader_file_stat(&zip, i, &result);
   }
 
-  bool find(const std::string &path, mz_uint &i) noexcept {
-    int tmp = mz_zip_reader_locate_file(&zip, path.data(), nullptr, 0);
+  bool find(const PathView path, mz_uint &i) noexcept {
+    int tmp = mz_zip_reader_locate_file(&zip, path.c_str(), nullptr, 0);
     if (tmp < 0)
       return false;
     i = tmp;
     return true;
   }
 
-  bool isSomething(const Path &path) noexcept {
+  bool isSomething(const PathView path) noexcept {
     mz_uint dummy;
     return find(path, dummy);
   }
 
-  bool isFile(const Path &path) noexcept {
+  bool isFile(const PathView path) noexcept {
     mz_uint i;
     return find(path, i) && !mz_zip_reader_is_file_a_directory(&zip, i);
   }
 
-  bool isDirectory(const Path &path) noexcept {
+  bool isDirectory(const PathView path) noexcept {
     mz_uint i;
-    return find(path.string() + "/", i) &&
+    const std::string directory = std::string(path.string()) + "/";
+    return find(directory.c_str(), i) &&
            mz_zip_reader_is_file_a_directory(&zip, i);
   }
 
-  bool isReadable(const Path &path) noexcept { return isFile(path); }
+  bool isReadable(const PathView path) noexcept { return isFile(path); }
 
-  std::uint64_t size(const Path &path) noexcept {
+  std::uint64_t size(const PathView path) noexcept {
     if (!stat(path, tmp_stat))
       return false;
     return tmp_stat.m_uncomp_size;
   }
 
+  std::uint32_t checksum(const PathView path) noexcept {
+    if (!stat(path, tmp_stat))
+      return 0;
+    return tmp_stat.m_crc32;
+  }
+
   void visit(Visitor visitor) {
     for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&zip); ++i) {
       mz_zip_reader_get_filename(&zip, i, tmp_stat.m_filename,
@@ -157,16 +179,22 @@ public:
     }
   }
 
-  std::unique_ptr<std::istream> read(const Path &path) noexcept {
-    auto iter =
-        mz_zip_reader_extract_file_iter_new(&zip, path.string().c_str(), 0);
+  std::unique_ptr<std::istream> read(const PathView path) {
+    auto iter = mz_zip_reader_extract_file_iter_new(&zip, path.c_str(), 0);
     if (iter == nullptr)
       return nullptr;
-    return std::make_unique<ZipReaderIstream>(iter);
+    const std::uint64_t size = iter->file_stat.m_uncomp_size;
+    if ((size > ZipBombException::size) &&
+        (size / ZipBombException::ratio > iter->file_stat.m_comp_size)) {
+      mz_zip_reader_extract_iter_free(iter);
+      throw ZipBombException(std::string(path.string()));
+    }
+    return std::make_unique<ZipReaderIstream>(iter, path);
   }
 
   // private:
   std::string buffer;
+  std::shared_ptr<const std::string> shared;
   mz_zip_archive zip{};
   mz_zip_archive_file_stat tmp_stat{};
 };
@@ -214,31 +242,40 @@ ZipReader::ZipReader(const void *mem, const std::uint64_t size)
 ZipReader::ZipReader(const std::string &data, bool)
     : impl(std::make_unique<Impl>(data)) {}
 
+ZipReader::ZipReader(std::shared_ptr<const std::string> data)
+    : impl(std::make_unique<Impl>(std::move(data))) {}
+
 ZipReader::ZipReader(const Path &path) : impl(std::make_unique<Impl>(path)) {}
 
 ZipReader::~ZipReader() = default;
 
-bool ZipReader::isSomething(const Path &path) const {
+bool ZipReader::isSomething(const PathView path) const {
   return impl->isSomething(path);
 }
 
-bool ZipReader::isFile(const Path &path) const { return impl->isFile(path); }
+bool ZipReader::isFile(const PathView path) const {
+  return impl->isFile(path);
+}
 
-bool ZipReader::isDirectory(const Path &path) const {
+bool ZipReader::isDirectory(const PathView path) const {
   return impl->isDirectory(path);
 }
 
-bool ZipReader::isReadable(const Path &path) const {
+bool ZipReader::isReadable(const PathView path) const {
   return impl->isReadable(path);
 }
 
-std::uint64_t ZipReader::size(const Path &path) const {
+std::uint64_t ZipReader::size(const PathView path) const {
   return impl->size(path);
 }
 
+std::uint32_t ZipReader::checksum(const PathView path) const {
+  return impl->checksum(path);
+}
+
 void ZipReader::visit(Visitor visitor) const { return impl->visit(visitor); }
 
-std::unique_ptr<std::istream> ZipReader::read(const Path &path) const {
+std::unique_ptr<std::istream> ZipReader::read(const PathView path) const {
   return impl->read(path);
 }
 
@@ -0,0 +1,446 @@
+#include <access/Path.h>
+#include <access/SharedStream.h>
+#include <access/Trace.h>
+#include <access/ZipStorage.h>
+#include <cstdio>
+#include <deque>
+#include <miniz.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace odr {
+namespace access {
+
+namespace {
+constexpr std::uint32_t localHeader = 0x04034b50;
+constexpr std::uint32_t dataDescriptor = 0x08074b50;
+constexpr std::uint32_t centralHeader = 0x02014b50;
+constexpr std::uint32_t endOfCentral = 0x06054b50;
+constexpr std::uint16_t zip64Extra = 0x0001;
+constexpr std::uint16_t flagEncrypted = 0x0001;
+constexpr std::uint16_t flagDescriptor = 0x0008;
+constexpr std::size_t chunkSize = 65536;
+
+std::uint64_t little(const char *data, const int size) {
+  std::uint64_t result = 0;
+  for (int i = size - 1; i >= 0; --i)
+    result = (result << 8) | static_cast<unsigned char>(data[i]);
+  return result;
+}
+
+// buffers the stream without ever waiting for more than has arrived
+class Input final {
+public:
+  explicit Input(std::unique_ptr<std::istream> in)
+      : in_(std::move(in)), buffer_(chunkSize) {}
+
+  // at least one byte unless the stream ended
+  bool fill() {
+    if (pos_ < end_)
+      return true;
+    pos_ = 0;
+    end_ = 0;
+    std::streambuf &buf = *in_->rdbuf();
+    if (buf.in_avail() <= 0) {
+      using Traits = std::char_traits<char>;
+      const auto c = buf.sbumpc();
+      if (Traits::eq_int_type(c, Traits::eof()))
+        return false;
+      buffer_[end_++] = Traits::to_char_type(c);
+    }
+    const std::streamsize available = buf.in_avail();
+    if (available > 0)
+      end_ += buf.sgetn(buffer_.data() + end_,
+                        std::min<std::streamsize>(available,
+                                                  buffer_.size() - end_));
+    return true;
+  }
+
+  std::size_t available() const { return end_ - pos_; }
+  const char *data() const { return buffer_.data() + pos_; }
+  void consume(const std::size_t size) { pos_ += size; }
+
+  void read(char *out, std::size_t size) {
+    while (size > 0) {
+      if (!fill())
+        throw NoZipFileException("stream");
+      const std::size_t amount = std::min(size, available());
+      std::copy(data(), data() + amount, out);
+      consume(amount);
+      out += amount;
+      size -= amount;
+    }
+  }
+
+  std::string read(const std::size_t size) {
+    std::string result(size, '\0');
+    read(result.data(), size);
+    return result;
+  }
+
+  std::uint64_t readLittle(const int size) {
+    char data[8];
+    read(data, size);
+    return little(data, size);
+  }
+
+private:
+  const std::unique_ptr<std::istream> in_;
+  std::vector<char> buffer_;
+  std::size_t pos_{0};
+  std::size_t end_{0};
+};
+} // namespace
+
+class ZipStreamReader::Impl final {
+public:
+  Impl(std::unique_ptr<std::istream> in, const std::uint64_t memoryBudget,
+       const std::uint64_t spoolBudget)
+      : input_(std::move(in)), memoryBudget_(memoryBudget),
+        spoolBudget_(spoolBudget) {
+    // fails early for anything which does not start like a zip
+    if (!input_.fill() || (input_.available() >= 4 &&
+                           little(input_.data(), 4) != localHeader))
+      throw NoZipFileException("stream");
+  }
+
+  ~Impl() {
+    if (spool_ != nullptr)
+      std::fclose(spool_);
+  }
+
+  struct Entry {
+    Path path;
+    std::size_t hash{0};
+    bool directory{false};
+    // neither stored nor deflated
+    bool supported{true};
+    std::uint64_t size{0};
+    std::uint32_t crc{0};
+    std::shared_ptr<const std::string> data;
+    // offset in the spool if `data` is empty
+    std::uint64_t offset{0};
+  };
+
+  const Entry *find(const PathView path) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (const Entry *entry = lookup_(path))
+      return entry;
+    while (next_()) {
+      const Entry &entry = entries_.back();
+      if (entry.path.string() == path.string())
+        return &entry;
+    }
+    return nullptr;
+  }
+
+  Path first() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.empty() && !next_())
+      return Path();
+    return entries_.front().path;
+  }
+
+  void visit(const Visitor &visitor) {
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      while (next_())
+        ;
+    }
+    // entries are never changed or removed once parsed
+    for (auto &&entry : entries_)
+      visitor(entry.path);
+  }
+
+  std::unique_ptr<std::istream> read(const PathView path) {
+    const Entry *entry = find(path);
+    if ((entry == nullptr) || entry->directory || !entry->supported)
+      return nullptr;
+    if (entry->data)
+      return std::make_unique<SharedIstream>(entry->data);
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto data = std::make_shared<std::string>(entry->size, '\0');
+    if ((std::fseek(spool_, static_cast<long>(entry->offset), SEEK_SET) !=
+         0) ||
+        (std::fread(data->data(), 1, data->size(), spool_) != data->size()))
+      throw ZipSpoolFullException();
+    return std::make_unique<SharedIstream>(std::move(data));
+  }
+
+private:
+  const Entry *lookup_(const PathView path) const {
+    const auto range = index_.equal_range(path.hash());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (entries_[it->second].path.string() == path.string())
+        return &entries_[it->second];
+    }
+    return nullptr;
+  }
+
+  // parses the next member; false once the central directory is reached
+  bool next_() {
+    if (finished_)
+      return false;
+    if (!input_.fill()) {
+      finished_ = true;
+      return false;
+    }
+    const auto signature = static_cast<std::uint32_t>(input_.readLittle(4));
+    if ((signature == centralHeader) || (signature == endOfCentral)) {
+      // the rest is the directory of what we already have
+      finished_ = true;
+      return false;
+    }
+    if (signature != localHeader)
+      throw NoZipFileException("stream");
+
+    input_.readLittle(2); // version
+    const auto flags = static_cast<std::uint16_t>(input_.readLittle(2));
+    const auto method = static_cast<std::uint16_t>(input_.readLittle(2));
+    input_.readLittle(4); // time and date
+    std::uint32_t crc = input_.readLittle(4);
+    std::uint64_t compressedSize = input_.readLittle(4);
+    std::uint64_t size = input_.readLittle(4);
+    const auto nameLength = static_cast<std::uint16_t>(input_.readLittle(2));
+    const auto extraLength = static_cast<std::uint16_t>(input_.readLittle(2));
+    const std::string name = input_.read(nameLength);
+    const std::string extra = input_.read(extraLength);
+
+    bool zip64 = false;
+    for (std::size_t pos = 0; pos + 4 <= extra.size();) {
+      const auto id = little(extra.data() + pos, 2);
+      const auto length = little(extra.data() + pos + 2, 2);
+      if ((id == zip64Extra) && (pos + 4 + length <= extra.size())) {
+        zip64 = true;
+        std::size_t field = pos + 4;
+        if ((size == 0xffffffff) && (field + 8 <= pos + 4 + length)) {
+          size = little(extra.data() + field, 8);
+          field += 8;
+        }
+        if ((compressedSize == 0xffffffff) &&
+            (field + 8 <= pos + 4 + length))
+          compressedSize = little(extra.data() + field, 8);
+      }
+      pos += 4 + length;
+    }
+
+    if (flags & flagEncrypted)
+      throw NoZipFileException("stream");
+    // the header lacks the sizes until the descriptor after the data
+    const bool descriptor = (flags & flagDescriptor) != 0;
+
+    Entry entry;
+    entry.directory = !name.empty() && (name.back() == '/');
+    entry.path = Path(entry.directory ? name.substr(0, name.size() - 1) : name);
+    entry.hash = entry.path.hash();
+    const Trace::Span span("zip stream", entry.path.string());
+
+    std::uint32_t actualCrc = MZ_CRC32_INIT;
+    Sink sink(*this, entry);
+    const auto write = [&](const char *data, const std::size_t size) {
+      actualCrc = static_cast<std::uint32_t>(mz_crc32(
+          actualCrc, reinterpret_cast<const unsigned char *>(data), size));
+      sink.write(data, size);
+    };
+
+    if (method == MZ_DEFLATED) {
+      inflate_(name, write);
+    } else if ((method == 0) && !descriptor) {
+      for (std::uint64_t remaining = compressedSize; remaining > 0;) {
+        if (!input_.fill())
+          throw NoZipFileException("stream");
+        const std::size_t amount =
+            std::min<std::uint64_t>(remaining, input_.available());
+        write(input_.data(), amount);
+        input_.consume(amount);
+        remaining -= amount;
+      }
+    } else if (!descriptor) {
+      // kept as an entry which cannot be read, like miniz does
+      entry.supported = false;
+      for (std::uint64_t remaining = compressedSize; remaining > 0;) {
+        if (!input_.fill())
+          throw NoZipFileException("stream");
+        const std::size_t amount =
+            std::min<std::uint64_t>(remaining, input_.available());
+        input_.consume(amount);
+        remaining -= amount;
+      }
+    } else {
+      // without a length nothing tells where the member ends
+      throw NoZipFileException("stream");
+    }
+
+    if (descriptor) {
+      crc = static_cast<std::uint32_t>(input_.readLittle(4));
+      if (crc == dataDescriptor)
+        crc = static_cast<std::uint32_t>(input_.readLittle(4));
+      input_.readLittle(zip64 ? 8 : 4); // compressed size
+      size = input_.readLittle(zip64 ? 8 : 4);
+    }
+    sink.finish();
+    if (!entry.supported)
+      entry.size = size;
+    else if ((entry.size != size) || (actualCrc != crc))
+      throw NoZipFileException("stream");
+    entry.crc = crc;
+
+    index_.emplace(entry.hash, entries_.size());
+    entries_.push_back(std::move(entry));
+    return true;
+  }
+
+  template <typename Write>
+  void inflate_(const std::string &name, const Write &write) {
+    mz_stream stream{};
+    if (mz_inflateInit2(&stream, -MZ_DEFAULT_WINDOW_BITS) != MZ_OK)
+      throw NoZipFileException("stream");
+    std::vector<char> out(chunkSize);
+    std::uint64_t consumed = 0;
+    std::uint64_t produced = 0;
+    int status = MZ_OK;
+    try {
+      while (status != MZ_STREAM_END) {
+        if (!input_.fill())
+          throw NoZipFileException("stream");
+        stream.next_in =
+            reinterpret_cast<const unsigned char *>(input_.data());
+        stream.avail_in = static_cast<unsigned int>(input_.available());
+        stream.next_out = reinterpret_cast<unsigned char *>(out.data());
+        stream.avail_out = static_cast<unsigned int>(out.size());
+        status = mz_inflate(&stream, MZ_NO_FLUSH);
+        if ((status != MZ_OK) && (status != MZ_STREAM_END))
+          throw NoZipFileException("stream");
+        // what follows the deflate stream belongs to the next header
+        const std::size_t in = input_.available() - stream.avail_in;
+        const std::size_t amount = out.size() - stream.avail_out;
+        input_.consume(in);
+        consumed += in;
+        produced += amount;
+        if ((produced > ZipBombException::size) &&
+            (produced / ZipBombException::ratio > consumed))
+          throw ZipBombException(name);
+        write(out.data(), amount);
+      }
+    } catch (...) {
+      mz_inflateEnd(&stream);
+      throw;
+    }
+    mz_inflateEnd(&stream);
+  }
+
+  // collects a member in memory and moves it to the spool once the memory
+  // budget runs out
+  class Sink final {
+  public:
+    Sink(Impl &impl, Entry &entry) : impl_(impl), entry_(entry) {}
+
+    void write(const char *data, const std::size_t size) {
+      if (!spooled_ &&
+          (impl_.memory_ + buffer_.size() + size > impl_.memoryBudget_)) {
+        spooled_ = true;
+        entry_.offset = impl_.spoolSize_;
+        spool_(buffer_.data(), buffer_.size());
+        buffer_ = std::string();
+      }
+      if (spooled_)
+        spool_(data, size);
+      else
+        buffer_.append(data, size);
+      entry_.size += size;
+    }
+
+    void finish() {
+      if (spooled_)
+        return;
+      impl_.memory_ += buffer_.size();
+      entry_.data = std::make_shared<const std::string>(std::move(buffer_));
+    }
+
+  private:
+    void spool_(const char *data, const std::size_t size) {
+      if (size == 0)
+        return;
+      if (impl_.spoolSize_ + size > impl_.spoolBudget_)
+        throw ZipSpoolFullException();
+      if (impl_.spool_ == nullptr)
+        impl_.spool_ = std::tmpfile();
+      if ((impl_.spool_ == nullptr) ||
+          (std::fseek(impl_.spool_, 0, SEEK_END) != 0) ||
+          (std::fwrite(data, 1, size, impl_.spool_) != size))
+        throw ZipSpoolFullException();
+      impl_.spoolSize_ += size;
+    }
+
+    Impl &impl_;
+    Entry &entry_;
+    std::string buffer_;
+    bool spooled_{false};
+  };
+
+  Input input_;
+  const std::uint64_t memoryBudget_;
+  const std::uint64_t spoolBudget_;
+
+  std::mutex mutex_;
+  bool finished_{false};
+  std::deque<Entry> entries_;
+  std::unordered_multimap<std::size_t, std::size_t> index_;
+  std::uint64_t memory_{0};
+  std::FILE *spool_{nullptr};
+  std::uint64_t spoolSize_{0};
+};
+
+ZipStreamReader::ZipStreamReader(std::unique_ptr<std::istream> in,
+                                 const std::uint64_t memoryBudget,
+                                 const std::uint64_t spoolBudget)
+    : impl(std::make_unique<Impl>(std::move(in), memoryBudget, spoolBudget)) {}
+
+ZipStreamReader::~ZipStreamReader() = default;
+
+bool ZipStreamReader::isSomething(const PathView path) const {
+  return impl->find(path) != nullptr;
+}
+
+bool ZipStreamReader::isFile(const PathView path) const {
+  const auto entry = impl->find(path);
+  return (entry != nullptr) && !entry->directory;
+}
+
+bool ZipStreamReader::isDirectory(const PathView path) const {
+  const auto entry = impl->find(path);
+  return (entry != nullptr) && entry->directory;
+}
+
+bool ZipStreamReader::isReadable(const PathView path) const {
+  const auto entry = impl->find(path);
+  return (entry != nullptr) && !entry->directory && entry->supported;
+}
+
+std::uint64_t ZipStreamReader::size(const PathView path) const {
+  const auto entry = impl->find(path);
+  return entry == nullptr ? 0 : entry->size;
+}
+
+std::uint32_t ZipStreamReader::checksum(const PathView path) const {
+  const auto entry = impl->find(path);
+  return entry == nullptr ? 0 : entry->crc;
+}
+
+bool ZipStreamReader::resident() const { return true; }
+
+void ZipStreamReader::visit(Visitor visitor) const { impl->visit(visitor); }
+
+Path ZipStreamReader::first() const { return impl->first(); }
+
+std::unique_ptr<std::istream>
+ZipStreamReader::read(const PathView path) const {
+  return impl->read(path);
+}
+
+} // namespace access
+} // namespace odr
@@ -0,0 +1,113 @@
+#include <AllocationStats.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <pugixml.hpp>
+
+namespace odr {
+
+namespace {
+// keeps the size in front of the block; maximal fundamental alignment
+constexpr std::size_t header_ = alignof(std::max_align_t);
+
+std::atomic<std::uint64_t> count_{0};
+std::atomic<std::uint64_t> bytes_{0};
+std::atomic<std::uint64_t> live_{0};
+std::atomic<std::uint64_t> peak_{0};
+
+void *allocate(const std::size_t size) noexcept {
+  auto block = static_cast<char *>(std::malloc(header_ + size));
+  if (block == nullptr)
+    return nullptr;
+  *reinterpret_cast<std::size_t *>(block) = size;
+
+  count_.fetch_add(1, std::memory_order_relaxed);
+  bytes_.fetch_add(size, std::memory_order_relaxed);
+  const std::uint64_t live =
+      live_.fetch_add(size, std::memory_order_relaxed) + size;
+  std::uint64_t peak = peak_.load(std::memory_order_relaxed);
+  while ((live > peak) && !peak_.compare_exchange_weak(
+                              peak, live, std::memory_order_relaxed)) {
+  }
+
+  return block + header_;
+}
+
+void deallocate(void *pointer) noexcept {
+  if (pointer == nullptr)
+    return;
+  char *block = static_cast<char *>(pointer) - header_;
+  live_.fetch_sub(*reinterpret_cast<std::size_t *>(block),
+                  std::memory_order_relaxed);
+  std::free(block);
+}
+
+void *allocateOrThrow(const std::size_t size) {
+  void *result = allocate(size);
+  if (result == nullptr)
+    throw std::bad_alloc();
+  return result;
+}
+
+// pugixml allocates its pages with malloc unless told otherwise
+const bool pugixmlHooks_ = [] {
+  pugi::set_memory_management_functions(allocate, deallocate);
+  return true;
+}();
+
+std::uint64_t beginCount_{0};
+std::uint64_t beginBytes_{0};
+} // namespace
+
+void AllocationStats::begin() {
+  beginCount_ = count_.load();
+  beginBytes_ = bytes_.load();
+  peak_ = live_.load();
+}
+
+AllocationStats::Phase AllocationStats::end() {
+  Phase result;
+  result.count = count_.load() - beginCount_;
+  result.bytes = bytes_.load() - beginBytes_;
+  result.peak = peak_.load();
+  return result;
+}
+
+} // namespace odr
+
+void *operator new(const std::size_t size) {
+  return odr::allocateOrThrow(size);
+}
+
+void *operator new[](const std::size_t size) {
+  return odr::allocateOrThrow(size);
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept {
+  return odr::allocate(size);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept {
+  return odr::allocate(size);
+}
+
+void operator delete(void *pointer) noexcept { odr::deallocate(pointer); }
+
+void operator delete[](void *pointer) noexcept { odr::deallocate(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  odr::deallocate(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  odr::deallocate(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+  odr::deallocate(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+  odr::deallocate(pointer);
+}
@@ -0,0 +1,26 @@
+#ifndef ODR_CLI_ALLOCATION_STATS_H
+#define ODR_CLI_ALLOCATION_STATS_H
+
+#include <cstdint>
+
+namespace odr {
+
+// Counts the allocations of the process through replaced `operator new` /
+// `operator delete` and the pugixml memory hooks. Only linked into the
+// benchmark with `ODR_ALLOCATION_ACCOUNTING`.
+namespace AllocationStats {
+struct Phase {
+  std::uint64_t count{0};
+  std::uint64_t bytes{0};
+  // highest live heap while the phase ran
+  std::uint64_t peak{0};
+};
+
+// starts a phase; phases do not nest
+void begin();
+Phase end();
+} // namespace AllocationStats
+
+} // namespace odr
+
+#endif // ODR_CLI_ALLOCATION_STATS_H
@@ -0,0 +1,24 @@
+#ifndef ODR_CLI_PERCENTILE_H
+#define ODR_CLI_PERCENTILE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace odr {
+
+// nearest rank on sorted values: the smallest value which at least `p` of all
+// values are less than or equal to
+inline double percentile(const std::vector<double> &sorted, const double p) {
+  if (sorted.empty())
+    return 0;
+  // p * n is rounded up; the tolerance keeps 0.07 * 100 at rank 7
+  const double rank = std::ceil(p * sorted.size() - 1e-9);
+  const std::size_t index = rank > 1 ? static_cast<std::size_t>(rank) - 1 : 0;
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace odr
+
+#endif // ODR_CLI_PERCENTILE_H
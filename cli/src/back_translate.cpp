@@ -22,7 +22,10 @@ int main(int, char **argv) {
     return 1;
   }
 
-  document.translate(output, config);
+  if (!document.translate(output, config)) {
+    std::cerr << "could not write " << output << std::endl;
+    return 2;
+  }
 
   const std::string backDiff = odr::access::FileUtil::read(diff);
   document.edit(backDiff);
@@ -0,0 +1,176 @@
+#include <access/Prefetcher.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <odr/Config.h>
+#include <odr/Document.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Translates many documents into a directory. The inputs are read ahead of
+// the workers by `access::Prefetcher`, so with enough prefetch depth the
+// workers only ever see memory and the batch is bound by disk bandwidth or
+// cpu, whichever runs out first. `--prefetch 0` opens every input from its
+// path on the worker instead, which is the baseline to compare against.
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::string baseName(const std::string &input) {
+  const std::size_t slash = input.find_last_of('/');
+  return slash == std::string::npos ? input : input.substr(slash + 1);
+}
+
+std::string outputPath(const std::string &directory, const std::string &name,
+                       const odr::TranslationFormat format) {
+  switch (format) {
+  case odr::TranslationFormat::TEXT:
+    return directory + "/" + name + ".txt";
+  case odr::TranslationFormat::JSON:
+    return directory + "/" + name + ".json";
+  default:
+    return directory + "/" + name + ".html";
+  }
+}
+
+// one output per input; inputs which share their file name are told apart by
+// their position, otherwise workers would write the same output at once
+std::vector<std::string> outputPaths(const std::string &directory,
+                                     const std::vector<std::string> &inputs,
+                                     const odr::TranslationFormat format) {
+  std::unordered_map<std::string, std::size_t> counts;
+  for (auto &&input : inputs)
+    ++counts[baseName(input)];
+  std::vector<std::string> result;
+  result.reserve(inputs.size());
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    std::string name = baseName(inputs[i]);
+    if (counts[name] > 1)
+      name = std::to_string(i) + "-" + name;
+    result.push_back(outputPath(directory, name, format));
+  }
+  return result;
+}
+
+// returns an empty string on success and the reason otherwise
+std::string translate(const odr::Document &document, const std::string &output,
+                      const odr::Config &config) {
+  if (document.encrypted())
+    return "encrypted";
+  if (!document.translatable())
+    return "not translatable";
+  if (!document.translate(output, config))
+    return "could not write " + output;
+  return "";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+  std::size_t prefetch = 16;
+  odr::Config config;
+  config.editable = true;
+  std::vector<std::string> arguments;
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument{argv[i]};
+    if ((argument == "--threads") && (i + 1 < argc))
+      threads = std::max(1ul, std::stoul(argv[++i]));
+    else if ((argument == "--prefetch") && (i + 1 < argc))
+      prefetch = std::stoul(argv[++i]);
+    else if ((argument == "--format") && (i + 1 < argc)) {
+      const std::string format{argv[++i]};
+      if (format == "text")
+        config.format = odr::TranslationFormat::TEXT;
+      else if (format == "json")
+        config.format = odr::TranslationFormat::JSON;
+    } else
+      arguments.push_back(argument);
+  }
+  if (arguments.size() < 2) {
+    std::cerr << "usage: batch [--threads n] [--prefetch depth] "
+                 "[--format html|text|json] output_directory input..."
+              << std::endl;
+    return 1;
+  }
+
+  const std::string directory = arguments[0];
+  const std::vector<std::string> inputs(arguments.begin() + 1,
+                                        arguments.end());
+  const std::vector<std::string> outputs =
+      outputPaths(directory, inputs, config.format);
+
+  std::unique_ptr<odr::access::Prefetcher> prefetcher;
+  if (prefetch > 0)
+    prefetcher =
+        std::make_unique<odr::access::Prefetcher>(inputs, prefetch);
+  std::atomic<std::size_t> nextInput{0};
+
+  std::mutex mutex;
+  std::size_t failures = 0;
+  const auto fail = [&](const std::string &input, const std::string &reason) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    ++failures;
+    std::cerr << input << ": " << reason << std::endl;
+  };
+
+  const auto start = Clock::now();
+  std::vector<std::thread> workers;
+  for (std::uint32_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      while (true) {
+        std::string input;
+        std::string reason;
+        try {
+          if (prefetcher) {
+            odr::access::Prefetcher::File file;
+            if (!prefetcher->next(file))
+              return;
+            input = file.path;
+            reason = file.error;
+            if (reason.empty()) {
+              const auto document =
+                  odr::Document::fromBuffer(std::move(file.data));
+              reason = translate(document, outputs[file.index], config);
+            }
+          } else {
+            const std::size_t index = nextInput++;
+            if (index >= inputs.size())
+              return;
+            input = inputs[index];
+            const odr::Document document(input);
+            reason = translate(document, outputs[index], config);
+          }
+        } catch (const std::exception &e) {
+          reason = e.what();
+        } catch (...) {
+          reason = "unknown error";
+        }
+        if (!reason.empty())
+          fail(input, reason);
+      }
+    });
+  }
+  for (auto &&worker : workers)
+    worker.join();
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  const nlohmann::json result{
+      {"documents", inputs.size()},
+      {"failures", failures},
+      {"threads", threads},
+      {"prefetch", prefetch},
+      {"seconds", seconds},
+      {"documentsPerSecond", seconds > 0 ? inputs.size() / seconds : 0},
+  };
+  std::cout << result.dump(4) << std::endl;
+
+  return failures > 0 ? 2 : 0;
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <odr/Config.h>
+#include <odr/Document.h>
+#include <odr/Meta.h>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef ODR_ALLOCATION_ACCOUNTING
+#include <AllocationStats.h>
+#endif
+
+namespace {
+struct Phase {
+  double seconds{0};
+  std::uint64_t allocations{0};
+  std::uint64_t allocatedBytes{0};
+  std::uint64_t peakBytes{0};
+
+  void add(const Phase &phase) {
+    seconds += phase.seconds;
+    allocations += phase.allocations;
+    allocatedBytes += phase.allocatedBytes;
+    peakBytes = std::max(peakBytes, phase.peakBytes);
+  }
+
+  nlohmann::json json() const {
+    nlohmann::json result{{"seconds", seconds}};
+#ifdef ODR_ALLOCATION_ACCOUNTING
+    result["allocations"] = allocations;
+    result["allocatedBytes"] = allocatedBytes;
+    result["peakBytes"] = peakBytes;
+#endif
+    return result;
+  }
+};
+
+struct Result {
+  std::uint64_t files{0};
+  std::uint64_t parseBytes{0};
+  // from Document::estimateCost
+  std::uint64_t estimatedNodes{0};
+  std::uint64_t estimatedCells{0};
+  Phase open;
+  Phase translate;
+
+  void add(const Result &result) {
+    files += result.files;
+    parseBytes += result.parseBytes;
+    estimatedNodes += result.estimatedNodes;
+    estimatedCells += result.estimatedCells;
+    open.add(result.open);
+    translate.add(result.translate);
+  }
+
+  nlohmann::json json() const {
+    const double seconds = open.seconds + translate.seconds;
+    nlohmann::json result{
+        {"files", files},
+        {"parseBytes", parseBytes},
+        {"estimatedNodes", estimatedNodes},
+        {"estimatedCells", estimatedCells},
+        {"bytesPerSecond", seconds > 0 ? parseBytes / seconds : 0},
+        {"open", open.json()},
+        {"translate", translate.json()},
+    };
+#ifdef ODR_ALLOCATION_ACCOUNTING
+    // ratios are taken against the cost estimate, not counted nodes and cells
+    for (const char *phase : {"open", "translate"}) {
+      const double allocations = result[phase]["allocations"];
+      result[phase]["allocationsPerEstimatedNode"] =
+          estimatedNodes > 0 ? allocations / estimatedNodes : 0;
+      result[phase]["allocationsPerEstimatedCell"] =
+          estimatedCells > 0 ? allocations / estimatedCells : 0;
+    }
+#endif
+    return result;
+  }
+};
+
+// every thread translates all inputs with its own documents
+nlohmann::json scaling(const std::vector<std::string> &inputs,
+                       const std::string &output, const odr::Config &config,
+                       const std::uint32_t maxThreads) {
+  nlohmann::json result = nlohmann::json::array();
+  double baseline = 0;
+  for (std::uint32_t threads = 1; threads <= maxThreads;
+       threads = (threads == maxThreads) ? threads + 1
+                                         : std::min(threads * 2, maxThreads)) {
+    std::atomic<std::uint64_t> documents{0};
+    std::vector<std::thread> workers;
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::uint32_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        // threads must not share an output file
+        const std::string path =
+            output == "/dev/null" ? output : output + "." + std::to_string(t);
+        for (auto &&input : inputs) {
+          try {
+            const odr::Document document(input);
+            if (document.encrypted() || !document.translatable())
+              continue;
+            document.translate(path, config);
+            ++documents;
+          } catch (...) {
+          }
+        }
+      });
+    }
+    for (auto &&worker : workers)
+      worker.join();
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    const double throughput = seconds > 0 ? documents / seconds : 0;
+    if (threads == 1)
+      baseline = throughput;
+    result.push_back({
+        {"threads", threads},
+        {"documents", documents.load()},
+        {"seconds", seconds},
+        {"documentsPerSecond", throughput},
+        // 1 means linear scaling
+        {"efficiency", baseline > 0 ? throughput / (baseline * threads) : 0},
+    });
+  }
+  return result;
+}
+
+// runs `function` as a phase and accounts its time and allocations
+template <typename Function> Phase measure(Function &&function) {
+  Phase result;
+#ifdef ODR_ALLOCATION_ACCOUNTING
+  odr::AllocationStats::begin();
+#endif
+  const auto begin = std::chrono::steady_clock::now();
+  function();
+  const auto end = std::chrono::steady_clock::now();
+  result.seconds = std::chrono::duration<double>(end - begin).count();
+#ifdef ODR_ALLOCATION_ACCOUNTING
+  const auto stats = odr::AllocationStats::end();
+  result.allocations = stats.count;
+  result.allocatedBytes = stats.bytes;
+  result.peakBytes = stats.peak;
+#endif
+  return result;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string output = "/dev/null";
+  std::uint32_t threads = 0;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument{argv[i]};
+    if ((argument == "--output") && (i + 1 < argc))
+      output = argv[++i];
+    else if ((argument == "--threads") && (i + 1 < argc))
+      threads = std::stoul(argv[++i]);
+    else
+      inputs.push_back(argument);
+  }
+  if (inputs.empty()) {
+    std::cerr << "usage: benchmark [--output path] [--threads n] input..."
+              << std::endl;
+    return 1;
+  }
+
+  odr::Config config;
+  config.editable = true;
+
+  if (threads > 0) {
+    // scales 1, 2, 4, ... up to `threads`
+    const nlohmann::json json{
+        {"scaling", scaling(inputs, output, config, threads)}};
+    std::cout << json.dump(4) << std::endl;
+    return 0;
+  }
+
+  std::map<std::string, Result> formats;
+  nlohmann::json files = nlohmann::json::object();
+  for (auto &&input : inputs) {
+    Result result;
+    result.files = 1;
+    try {
+      std::unique_ptr<odr::Document> document;
+      result.open.add(measure(
+          [&] { document = std::make_unique<odr::Document>(input); }));
+      if (document->encrypted() || !document->translatable())
+        continue;
+
+      const odr::DocumentCost cost = document->estimateCost();
+      result.parseBytes = cost.parseBytes;
+      result.estimatedNodes = cost.nodeCount;
+      result.estimatedCells = cost.cellCount;
+
+      result.translate.add(
+          measure([&] { document->translate(output, config); }));
+
+      files[input] = result.json();
+      formats[document->meta().typeAsString()].add(result);
+    } catch (...) {
+      std::cerr << "failed: " << input << std::endl;
+    }
+  }
+
+  nlohmann::json json{{"files", files}, {"formats", nlohmann::json::object()}};
+  for (auto &&format : formats)
+    json["formats"][format.first] = format.second.json();
+  std::cout << json.dump(4) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,351 @@
+#include <Percentile.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <odr/Config.h>
+#include <odr/Document.h>
+#include <odr/Meta.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+// Replays a manifest of documents against the library at their arrival times
+// and reports latency percentiles per request type. The manifest has one json
+// object per line:
+//
+//   {"at": 0.5, "input": "a.ods", "type": "preview", "config": {...}}
+//
+// `at` is the arrival in seconds after the start; `type` defaults to the file
+// type and `config` takes the member names of `odr::Config`. Latency is
+// measured from the arrival, so it includes the time spent waiting for a
+// worker; service time starts when a worker picks the request up.
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Request {
+  double at{0};
+  std::string input;
+  std::string type;
+  odr::Config config;
+};
+
+struct Sample {
+  bool failed{false};
+  double latency{0};
+  double service{0};
+  double cpu{0};
+};
+
+odr::TranslationFormat parseFormat(const std::string &format) {
+  if (format == "text")
+    return odr::TranslationFormat::TEXT;
+  if (format == "json")
+    return odr::TranslationFormat::JSON;
+  return odr::TranslationFormat::HTML;
+}
+
+odr::Config parseConfig(const nlohmann::json &json) {
+  odr::Config result;
+  result.editable = true;
+  if (json.contains("format"))
+    result.format = parseFormat(json["format"].get<std::string>());
+  const auto get = [&](const char *name, auto &member) {
+    if (json.contains(name))
+      json[name].get_to(member);
+  };
+  get("entryOffset", result.entryOffset);
+  get("entryCount", result.entryCount);
+  get("sheetName", result.sheetName);
+  get("splitEntries", result.splitEntries);
+  get("editable", result.editable);
+  get("pruneStyles", result.pruneStyles);
+  get("compact", result.compact);
+  get("gzip", result.gzip);
+  get("gzipLevel", result.gzipLevel);
+  get("pipeline", result.pipeline);
+  get("tableOffsetRows", result.tableOffsetRows);
+  get("tableOffsetCols", result.tableOffsetCols);
+  get("tableLimitRows", result.tableLimitRows);
+  get("tableLimitCols", result.tableLimitCols);
+  get("tableLimitByDimensions", result.tableLimitByDimensions);
+  return result;
+}
+
+std::vector<Request> parseManifest(std::istream &in) {
+  std::vector<Request> result;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+    const auto json = nlohmann::json::parse(line);
+    Request &request = result.emplace_back();
+    request.at = json.value("at", 0.0);
+    request.input = json.at("input").get<std::string>();
+    request.type = json.value("type", "");
+    if (json.contains("config"))
+      request.config = parseConfig(json["config"]);
+    else
+      request.config = parseConfig(nlohmann::json::object());
+  }
+  std::stable_sort(result.begin(), result.end(),
+                   [](const Request &a, const Request &b) {
+                     return a.at < b.at;
+                   });
+  return result;
+}
+
+double threadCpuSeconds() {
+  timespec time{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// high-water mark of the whole process, not of a single request
+std::uint64_t processPeakRss() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+nlohmann::json distribution(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  double sum = 0;
+  for (auto &&value : values)
+    sum += value;
+  return {
+      {"mean", values.empty() ? 0 : sum / values.size()},
+      {"p50", odr::percentile(values, 0.50)},
+      {"p95", odr::percentile(values, 0.95)},
+      {"p99", odr::percentile(values, 0.99)},
+      {"max", values.empty() ? 0 : values.back()},
+  };
+}
+
+nlohmann::json summarize(const std::vector<const Sample *> &samples,
+                         const double seconds) {
+  std::vector<double> latency;
+  std::vector<double> service;
+  std::vector<double> cpu;
+  std::uint64_t failures = 0;
+  for (auto &&sample : samples) {
+    if (sample->failed) {
+      ++failures;
+      continue;
+    }
+    latency.push_back(sample->latency);
+    service.push_back(sample->service);
+    cpu.push_back(sample->cpu);
+  }
+  return {
+      {"requests", samples.size()},
+      {"failures", failures},
+      {"requestsPerSecond", seconds > 0 ? latency.size() / seconds : 0},
+      {"latencySeconds", distribution(latency)},
+      {"serviceSeconds", distribution(service)},
+      {"cpuSeconds", distribution(cpu)},
+  };
+}
+
+nlohmann::json replay(std::vector<Request> &requests,
+                      const std::uint32_t concurrency, const double speed,
+                      const std::string &output) {
+  std::vector<Sample> samples(requests.size());
+  std::deque<std::size_t> queue;
+  bool closed = false;
+  std::mutex mutex;
+  std::condition_variable available;
+
+  const auto start = Clock::now();
+  const auto arrival = [&](const Request &request) {
+    return start + std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(request.at / speed));
+  };
+
+  std::vector<std::thread> workers;
+  for (std::uint32_t t = 0; t < concurrency; ++t) {
+    workers.emplace_back([&, t] {
+      // workers must not share an output file
+      const std::string path =
+          output == "/dev/null" ? output : output + "." + std::to_string(t);
+      while (true) {
+        std::size_t index;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          available.wait(lock, [&] { return closed || !queue.empty(); });
+          if (queue.empty())
+            return;
+          index = queue.front();
+          queue.pop_front();
+        }
+
+        Request &request = requests[index];
+        Sample &sample = samples[index];
+        const auto begin = Clock::now();
+        const double cpu = threadCpuSeconds();
+        try {
+          const odr::Document document(request.input);
+          if (request.type.empty())
+            request.type = document.meta().typeAsString();
+          if (document.encrypted() || !document.translatable())
+            sample.failed = true;
+          else
+            document.translate(path, request.config);
+        } catch (...) {
+          sample.failed = true;
+        }
+        const auto end = Clock::now();
+        sample.cpu = threadCpuSeconds() - cpu;
+        sample.service = std::chrono::duration<double>(end - begin).count();
+        sample.latency =
+            std::chrono::duration<double>(end - arrival(request)).count();
+      }
+    });
+  }
+
+  // open loop: requests arrive on time even if the workers are behind
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    std::this_thread::sleep_until(arrival(requests[i]));
+    {
+      const std::lock_guard<std::mutex> lock(mutex);
+      queue.push_back(i);
+    }
+    available.notify_one();
+  }
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+  }
+  available.notify_all();
+  for (auto &&worker : workers)
+    worker.join();
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<const Sample *> all;
+  std::map<std::string, std::vector<const Sample *>> types;
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    all.push_back(&samples[i]);
+    // failed opens leave the type empty
+    types[requests[i].type.empty() ? "unknown" : requests[i].type].push_back(
+        &samples[i]);
+  }
+
+  nlohmann::json result{
+      {"version", odr::Document::version()},
+      {"commit", odr::Document::commit()},
+      {"concurrency", concurrency},
+      {"speed", speed},
+      {"seconds", seconds},
+      // the whole process; requests of all types share it
+      {"processPeakRssBytes", processPeakRss()},
+      {"total", summarize(all, seconds)},
+      {"types", nlohmann::json::object()},
+  };
+  for (auto &&type : types)
+    result["types"][type.first] = summarize(type.second, seconds);
+  return result;
+}
+
+// relative change of the metrics which matter for tail latency; a ratio above
+// 1 means the candidate is slower or uses more
+nlohmann::json compare(const nlohmann::json &baseline,
+                       const nlohmann::json &candidate) {
+  const auto ratio = [](const nlohmann::json &a, const nlohmann::json &b) {
+    const double x = a.get<double>();
+    const double y = b.get<double>();
+    return nlohmann::json{
+        {"baseline", x}, {"candidate", y}, {"ratio", x > 0 ? y / x : 0}};
+  };
+  const auto metrics = [&](const nlohmann::json &a, const nlohmann::json &b) {
+    nlohmann::json result = nlohmann::json::object();
+    for (auto &&distribution : {"latencySeconds", "cpuSeconds"}) {
+      for (auto &&p : {"p50", "p95", "p99"})
+        result[std::string(distribution) + "." + p] =
+            ratio(a[distribution][p], b[distribution][p]);
+    }
+    result["requestsPerSecond"] =
+        ratio(a["requestsPerSecond"], b["requestsPerSecond"]);
+    result["failures"] = ratio(a["failures"], b["failures"]);
+    return result;
+  };
+
+  nlohmann::json result{
+      {"baseline", baseline.value("commit", "")},
+      {"candidate", candidate.value("commit", "")},
+      {"processPeakRssBytes", ratio(baseline["processPeakRssBytes"],
+                                    candidate["processPeakRssBytes"])},
+      {"total", metrics(baseline["total"], candidate["total"])},
+      {"types", nlohmann::json::object()},
+  };
+  for (auto &&type : baseline["types"].items()) {
+    if (candidate["types"].contains(type.key()))
+      result["types"][type.key()] =
+          metrics(type.value(), candidate["types"][type.key()]);
+  }
+  return result;
+}
+
+nlohmann::json readJson(const std::string &path) {
+  std::ifstream in(path);
+  return nlohmann::json::parse(in);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  std::string output = "/dev/null";
+  std::uint32_t concurrency = 1;
+  double speed = 1;
+  std::vector<std::string> arguments;
+  bool comparison = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument{argv[i]};
+    if ((argument == "--output") && (i + 1 < argc))
+      output = argv[++i];
+    else if ((argument == "--concurrency") && (i + 1 < argc))
+      concurrency = std::max(1ul, std::stoul(argv[++i]));
+    else if ((argument == "--speed") && (i + 1 < argc))
+      speed = std::stod(argv[++i]);
+    else if (argument == "--compare")
+      comparison = true;
+    else
+      arguments.push_back(argument);
+  }
+
+  if (comparison) {
+    if (arguments.size() != 2) {
+      std::cerr << "usage: replay --compare baseline.json candidate.json"
+                << std::endl;
+      return 1;
+    }
+    std::cout << compare(readJson(arguments[0]), readJson(arguments[1])).dump(4)
+              << std::endl;
+    return 0;
+  }
+
+  if ((arguments.size() != 1) || !(speed > 0)) {
+    std::cerr << "usage: replay [--output path] [--concurrency n] [--speed x] "
+                 "manifest.jsonl"
+              << std::endl;
+    return 1;
+  }
+
+  std::ifstream manifest(arguments[0]);
+  if (!manifest.is_open()) {
+    std::cerr << "cannot open " << arguments[0] << std::endl;
+    return 1;
+  }
+  auto requests = parseManifest(manifest);
+  std::cout << replay(requests, concurrency, speed, output).dump(4)
+            << std::endl;
+
+  return 0;
+}
@@ -1,24 +1,73 @@
+#include <access/Trace.h>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <odr/Config.h>
 #include <odr/Document.h>
 #include <odr/Meta.h>
 #include <string>
+#include <vector>
 
 int main(int argc, char **argv) {
-  const std::string input{argv[1]};
-  const std::string output{argv[2]};
+  // synced with stdio, std::cin hands out one byte per read; a streamed input
+  // would be parsed byte by byte. has to come before any other i/o
+  std::ios::sync_with_stdio(false);
 
-  bool hasPassword = argc >= 4;
+  // `--trace <path>` writes chrome trace-event json, `--ir-cache <directory>`
+  // keeps the text and json representation between runs; the rest is
+  // positional
+  std::vector<std::string> arguments;
+  std::string tracePath;
+  std::string irCache;
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument{argv[i]};
+    if ((argument == "--trace") && (i + 1 < argc))
+      tracePath = argv[++i];
+    else if ((argument == "--ir-cache") && (i + 1 < argc))
+      irCache = argv[++i];
+    else
+      arguments.push_back(argument);
+  }
+  if (arguments.size() < 2) {
+    std::cerr << "usage: translate [--trace trace.json] [--ir-cache directory] "
+                 "input output [password]"
+              << std::endl;
+    return 3;
+  }
+
+  const std::string input{arguments[0]};
+  const std::string output{arguments[1]};
+
+  bool hasPassword = arguments.size() >= 3;
   std::string password;
   if (hasPassword)
-    password = argv[3];
+    password = arguments[2];
+
+  if (!tracePath.empty())
+    odr::access::Trace::start();
 
   odr::Config config;
   config.entryOffset = 0;
   config.entryCount = 0;
   config.editable = true;
+  config.irCache = irCache;
 
-  const odr::Document document{input};
+  std::string extension = output.substr(output.find_last_of('.') + 1);
+  if (extension == "gz") {
+    config.gzip = true;
+    const std::string stem = output.substr(0, output.find_last_of('.'));
+    extension = stem.substr(stem.find_last_of('.') + 1);
+  }
+  if (extension == "txt")
+    config.format = odr::TranslationFormat::TEXT;
+  else if (extension == "json")
+    config.format = odr::TranslationFormat::JSON;
+
+  // `-` reads the input from stdin and translates it while it still arrives
+  const odr::Document document =
+      input == "-" ? odr::Document::fromStream(
+                         std::make_unique<std::istream>(std::cin.rdbuf()))
+                   : odr::Document(input);
 
   if (document.encrypted()) {
     if (hasPassword) {
@@ -32,7 +81,17 @@ int main(int argc, char **argv) {
     }
   }
 
-  document.translate(output, config);
+  const bool translated = document.translate(output, config);
+
+  if (!tracePath.empty()) {
+    std::ofstream trace(tracePath);
+    odr::access::Trace::stop(trace);
+  }
+
+  if (!translated) {
+    std::cerr << "could not write " << output << std::endl;
+    return 3;
+  }
 
   return 0;
 }
@@ -0,0 +1,24 @@
+#ifndef ODR_COMMON_COST_H
+#define ODR_COMMON_COST_H
+
+namespace odr {
+struct FileMeta;
+struct DocumentCost;
+
+namespace access {
+class ReadStorage;
+}
+
+namespace common {
+
+namespace Cost {
+// uses only the sizes listed by the storage (zip central directory, cfb
+// directory) and the statistics already in `meta`
+DocumentCost estimate(const access::ReadStorage &storage,
+                      const FileMeta &meta);
+} // namespace Cost
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_COST_H
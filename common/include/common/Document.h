@@ -1,7 +1,9 @@
 #ifndef ODR_COMMON_DOCUMENT_H
 #define ODR_COMMON_DOCUMENT_H
 
+#include <odr/Diagnostics.h>
 #include <odr/Meta.h>
+#include <vector>
 
 namespace odr {
 struct Config;
@@ -17,6 +19,10 @@ public:
   virtual ~Document() = default;
 
   virtual const FileMeta &meta() const noexcept = 0;
+  virtual DocumentCost estimateCost() const = 0;
+  virtual std::string fingerprint(bool content) const = 0;
+  // problems of the last translation
+  virtual std::vector<Diagnostic> diagnostics() const = 0;
 
   virtual bool decrypted() const noexcept = 0;
   virtual bool translatable() const noexcept = 0;
@@ -25,9 +31,12 @@ public:
 
   virtual bool decrypt(const std::string &password) = 0;
 
-  virtual void translate(const access::Path &path, const Config &config) = 0;
+  // false if the output could not be written completely
+  virtual bool translate(const access::Path &path, const Config &config) = 0;
 
   virtual void edit(const std::string &diff) = 0;
+  // json object mapping ids of blocks modified by `edit` to their translation
+  virtual std::string retranslate() = 0;
 
   virtual void save(const access::Path &path) const = 0;
   virtual void save(const access::Path &path,
@@ -0,0 +1,27 @@
+#ifndef ODR_COMMON_FINGERPRINT_H
+#define ODR_COMMON_FINGERPRINT_H
+
+#include <string>
+
+namespace odr {
+namespace access {
+class ReadStorage;
+}
+
+namespace common {
+
+namespace Fingerprint {
+// 128 bit hash as 32 hex digits over the names, sizes and checksums listed by
+// the storage; reads nothing but the directory. storages without checksums
+// (cfb) only contribute names and sizes, so edits which keep the sizes are
+// not detected.
+std::string directory(const access::ReadStorage &storage);
+// same as `directory` but hashes the content of every file instead of the
+// checksums
+std::string content(const access::ReadStorage &storage);
+} // namespace Fingerprint
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_FINGERPRINT_H
@@ -19,6 +19,12 @@ const char *defaultHeaders() noexcept;
 
 const char *odfDefaultStyle() noexcept;
 const char *odfSpreadsheetDefaultStyle() noexcept;
+// replaces the table attributes omitted in compact output
+const char *odfCompactStyle() noexcept;
+// shared svg definitions referenced by drawn shapes
+const char *odfShapeSymbols() noexcept;
+// strips comments and whitespace which does not separate tokens
+std::string minifyCss(const std::string &css);
 
 const char *defaultScript() noexcept;
 
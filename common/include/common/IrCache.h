@@ -0,0 +1,29 @@
+#ifndef ODR_COMMON_IR_CACHE_H
+#define ODR_COMMON_IR_CACHE_H
+
+#include <string>
+
+namespace odr {
+namespace access {
+class ReadStorage;
+}
+
+namespace common {
+class IrDocument;
+
+// Keeps the representation of a document in a directory between runs, keyed
+// by the content fingerprint of its storage. Reopening an unchanged document
+// then renders text and json without parsing its content again.
+namespace IrCache {
+// false if nothing is cached for `storage` or the cached file is unreadable
+bool load(const std::string &directory, const access::ReadStorage &storage,
+          IrDocument &out);
+// failures to write are ignored; the next run builds the representation again
+void store(const std::string &directory, const access::ReadStorage &storage,
+           const IrDocument &in);
+} // namespace IrCache
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_IR_CACHE_H
@@ -0,0 +1,107 @@
+#ifndef ODR_COMMON_IR_DOCUMENT_H
+#define ODR_COMMON_IR_DOCUMENT_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace odr {
+namespace common {
+
+struct NoIrFileException final : public std::exception {
+  const char *what() const noexcept final { return "not an ir file"; }
+};
+
+enum class IrType : std::uint8_t {
+  ROOT,
+  TEXT,
+  PARAGRAPH,
+  SPAN,
+  LINK,
+  BOOKMARK,
+  SPACE,
+  TAB,
+  LINE_BREAK,
+  LIST,
+  LIST_ITEM,
+  PAGE,
+  SHEET,
+  TABLE,
+  TABLE_COLUMN,
+  TABLE_ROW,
+  TABLE_CELL,
+  FRAME,
+  SHAPE,
+  IMAGE,
+};
+
+struct IrString {
+  std::uint32_t offset{0};
+  std::uint32_t length{0};
+};
+
+struct IrNode {
+  static constexpr std::uint32_t noStyle = 0xFFFFFFFF;
+
+  IrType type{IrType::ROOT};
+  // index after the last descendant; children directly follow their parent
+  std::uint32_t end{0};
+  // index into `IrDocument::styles`
+  std::uint32_t style{noStyle};
+  // repetitions of spaces, table columns, rows and cells
+  std::uint32_t repeat{1};
+  std::uint32_t colSpan{1};
+  std::uint32_t rowSpan{1};
+  // text content, link target, bookmark, image path or entry name
+  IrString text;
+};
+
+// Flat pre-order representation of a document's content shared by the
+// translation backends. Built once per document and serializable.
+class IrDocument final {
+public:
+  static IrDocument read(std::istream &);
+
+  IrDocument();
+
+  void write(std::ostream &) const;
+
+  bool empty() const noexcept { return nodes_.size() <= 1; }
+  void clear();
+
+  const std::vector<IrNode> &nodes() const noexcept { return nodes_; }
+  const IrNode &node(std::uint32_t index) const { return nodes_[index]; }
+  std::string_view string(const IrString &) const noexcept;
+  std::string_view text(std::uint32_t index) const noexcept;
+  std::string_view style(std::uint32_t index) const noexcept;
+
+  // building
+  std::uint32_t open(IrType type, const std::string &style = "");
+  void close();
+  std::uint32_t leaf(IrType type, const std::string &style = "");
+  void appendText(const char *text);
+  void setText(std::uint32_t index, const std::string &text);
+  void setRepeat(std::uint32_t index, std::uint32_t repeat);
+  void setSpan(std::uint32_t index, std::uint32_t colSpan,
+               std::uint32_t rowSpan);
+
+private:
+  std::vector<IrNode> nodes_;
+  std::vector<IrString> styles_;
+  std::string arena_;
+
+  std::unordered_map<std::string, std::uint32_t> styleIds_;
+  std::vector<std::uint32_t> open_;
+  bool mergeText_{false};
+
+  IrString intern_(const char *text, std::size_t length);
+  std::uint32_t styleId_(const std::string &style);
+};
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_IR_DOCUMENT_H
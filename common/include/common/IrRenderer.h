@@ -0,0 +1,22 @@
+#ifndef ODR_COMMON_IR_RENDERER_H
+#define ODR_COMMON_IR_RENDERER_H
+
+#include <iostream>
+
+namespace odr {
+struct Config;
+
+namespace common {
+class IrDocument;
+
+namespace IrRenderer {
+// respects the entry selection as well as the table offsets and limits
+void text(const IrDocument &in, const Config &config, std::ostream &out);
+// respects the entry selection; repetitions are kept as attributes
+void json(const IrDocument &in, const Config &config, std::ostream &out);
+} // namespace IrRenderer
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_IR_RENDERER_H
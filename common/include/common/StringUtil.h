@@ -2,13 +2,14 @@
 #define ODR_COMMON_STRINGUTIL_H
 
 #include <string>
+#include <string_view>
 
 namespace odr {
 namespace common {
 
 namespace StringUtil {
-bool startsWith(const std::string &string, const std::string &with);
-bool endsWith(const std::string &string, const std::string &with);
+bool startsWith(std::string_view string, std::string_view with);
+bool endsWith(std::string_view string, std::string_view with);
 void findAndReplaceAll(std::string &string, const std::string &search,
                        const std::string &replace);
 } // namespace StringUtil
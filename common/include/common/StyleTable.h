@@ -0,0 +1,37 @@
+#ifndef ODR_COMMON_STYLE_TABLE_H
+#define ODR_COMMON_STYLE_TABLE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace odr {
+namespace common {
+
+// interns inline css declaration blocks into generated classes so that
+// repeated property sets are written once
+class StyleTable final {
+public:
+  // returns the class name for the declarations
+  std::string intern(const std::string &declarations);
+
+  bool empty() const noexcept { return declarations_.empty(); }
+  std::uint32_t size() const noexcept { return declarations_.size(); }
+  void clear() noexcept;
+
+  // writes one rule per class in the order of interning
+  void css(std::ostream &out) const;
+
+private:
+  std::unordered_map<std::string, std::uint32_t> ids_;
+  std::vector<const std::string *> declarations_;
+
+  static std::string name_(std::uint32_t id);
+};
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_STYLE_TABLE_H
@@ -3,7 +3,7 @@
 
 #include <common/TablePosition.h>
 #include <cstdint>
-#include <list>
+#include <vector>
 
 namespace odr {
 namespace common {
@@ -22,14 +22,18 @@ public:
   std::uint32_t col() const noexcept { return col_; }
 
 private:
-  struct Range {
+  // columns [start, end) occupied by a rowspan in rows [firstRow, lastRow)
+  struct Span {
     std::uint32_t start;
     std::uint32_t end;
+    std::uint64_t firstRow;
+    std::uint64_t lastRow;
   };
 
   std::uint32_t row_{0};
   std::uint32_t col_{0};
-  std::list<std::list<Range>> sparse_;
+  // sorted by start; one entry per spanning cell regardless of its rowspan
+  std::vector<Span> spans_;
 
   void handleRowspan() noexcept;
 };
@@ -0,0 +1,81 @@
+#ifndef ODR_COMMON_XML_TRAVERSAL_H
+#define ODR_COMMON_XML_TRAVERSAL_H
+
+#include <cstdint>
+#include <pugixml.hpp>
+#include <vector>
+
+namespace odr {
+namespace common {
+
+namespace XmlTraversal {
+// nodes nested deeper than this are skipped
+constexpr std::uint32_t defaultMaxDepth = 1024;
+
+template <typename State> struct Frame {
+  pugi::xml_node node;
+  // next node to visit below `node`; defaults to the first child of `node`.
+  // `enter` can clear it to skip the children or redirect it to any other node.
+  pugi::xml_node next;
+  // visit only `next` instead of `next` and its following siblings
+  bool single{false};
+  // number of times `node` was entered before; see `leave`
+  std::uint32_t iteration{0};
+  // kept between `enter` and `leave` and across iterations
+  State state{};
+};
+
+// Depth-first traversal with an explicit stack instead of recursion.
+//
+// `bool enter(Frame<State> &)` is called before the children of a node are
+// visited. Returning false skips the node entirely and `leave` is not called.
+//
+// `bool leave(Frame<State> &)` is called after the children were visited.
+// Returning true enters the same node again with an incremented iteration
+// which is used to repeat elements (e.g. `table:number-rows-repeated`).
+template <typename State, typename Enter, typename Leave>
+void traverse(const pugi::xml_node &root, Enter &&enter, Leave &&leave,
+              const std::uint32_t maxDepth = defaultMaxDepth) {
+  std::vector<Frame<State>> stack;
+
+  const auto push = [&](const pugi::xml_node &node) {
+    if (stack.size() >= maxDepth)
+      return;
+    Frame<State> &frame = stack.emplace_back();
+    frame.node = node;
+    frame.next = node.first_child();
+    if (!enter(frame))
+      stack.pop_back();
+  };
+
+  push(root);
+
+  while (!stack.empty()) {
+    Frame<State> &top = stack.back();
+
+    if (top.next) {
+      const pugi::xml_node child = top.next;
+      top.next = top.single ? pugi::xml_node() : child.next_sibling();
+      // invalidates `top`
+      push(child);
+      continue;
+    }
+
+    if (!leave(top)) {
+      stack.pop_back();
+      continue;
+    }
+
+    ++top.iteration;
+    top.next = top.node.first_child();
+    top.single = false;
+    if (!enter(top))
+      stack.pop_back();
+  }
+}
+} // namespace XmlTraversal
+
+} // namespace common
+} // namespace odr
+
+#endif // ODR_COMMON_XML_TRAVERSAL_H
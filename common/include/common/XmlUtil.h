@@ -10,7 +10,7 @@ class xml_document;
 
 namespace odr {
 namespace access {
-class Path;
+class PathView;
 class ReadStorage;
 } // namespace access
 } // namespace odr
@@ -25,7 +25,7 @@ struct NotXmlException final : public std::exception {
 namespace XmlUtil {
 pugi::xml_document parse(const std::string &);
 pugi::xml_document parse(std::istream &);
-pugi::xml_document parse(const access::ReadStorage &, const access::Path &);
+pugi::xml_document parse(const access::ReadStorage &, access::PathView);
 } // namespace XmlUtil
 
 } // namespace common
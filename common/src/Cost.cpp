@@ -0,0 +1,110 @@
+#include <access/Path.h>
+#include <access/Storage.h>
+#include <common/Cost.h>
+#include <odr/Meta.h>
+#include <string>
+#include <unordered_set>
+
+namespace odr {
+namespace common {
+
+namespace {
+// rough averages of the test documents; to be recalibrated with the benchmark
+// whenever the translators change considerably
+constexpr double bytesPerNode = 48;
+constexpr double bytesPerCell = 64;
+constexpr double parseBytesPerSecond = 200e6;
+constexpr double nodesPerSecond = 10e6;
+constexpr double imageBytesPerSecond = 1e9;
+// pugixml node including its share of attributes
+constexpr double memoryPerNode = 96;
+// images are base64 encoded into the output
+constexpr double memoryPerImageByte = 4.0 / 3.0;
+
+// `Path::extension` starts at the first dot which breaks `.xml.rels`
+std::string extensionOf(const access::Path &path) {
+  const std::string &string = path.string();
+  const auto pos = string.rfind('.');
+  if ((pos == std::string::npos) ||
+      (string.find('/', pos) != std::string::npos))
+    return "";
+  return string.substr(pos + 1);
+}
+
+bool isMarkup(const access::Path &path) {
+  const std::string extension = extensionOf(path);
+  return (extension == "xml") || (extension == "rels");
+}
+
+bool isImage(const access::Path &path) {
+  static const std::unordered_set<std::string> extensions = {
+      "png", "jpg", "jpeg", "gif", "bmp", "svg",
+      "tif", "tiff", "wmf", "emf", "svm",
+  };
+  return extensions.find(extensionOf(path)) != extensions.end();
+}
+
+// binary streams of legacy and encrypted documents
+bool isStream(const access::Path &path) {
+  static const std::unordered_set<std::string> streams = {
+      "WordDocument", "0Table", "1Table", "PowerPoint Document",
+      "Workbook",     "EncryptedPackage",
+  };
+  return streams.find(path.basename()) != streams.end();
+}
+
+bool isSheet(const access::Path &path, const FileMeta &meta) {
+  switch (meta.type) {
+  case FileType::OPENDOCUMENT_SPREADSHEET:
+    return path == "content.xml";
+  case FileType::OFFICE_OPEN_XML_WORKBOOK:
+    return path.string().rfind("xl/worksheets/", 0) == 0;
+  default:
+    return false;
+  }
+}
+} // namespace
+
+DocumentCost Cost::estimate(const access::ReadStorage &storage,
+                            const FileMeta &meta) {
+  DocumentCost result;
+
+  std::uint64_t markupBytes = 0;
+  std::uint64_t sheetBytes = 0;
+  storage.visit([&](const access::Path &path) {
+    if (!storage.isFile(path))
+      return;
+    const std::uint64_t size = storage.size(path);
+    if (isMarkup(path)) {
+      markupBytes += size;
+      if (isSheet(path, meta))
+        sheetBytes += size;
+    } else if (isStream(path)) {
+      result.parseBytes += size;
+    } else if (isImage(path)) {
+      result.imageBytes += size;
+    }
+  });
+  result.parseBytes += markupBytes;
+
+  result.nodeCount = markupBytes / bytesPerNode;
+  for (auto &&entry : meta.entries) {
+    result.cellCount +=
+        static_cast<std::uint64_t>(entry.rowCount) * entry.columnCount;
+  }
+  // fall back to the size of the sheets if the dimensions are unknown
+  if (result.cellCount == 0)
+    result.cellCount = sheetBytes / bytesPerCell;
+
+  result.seconds = result.parseBytes / parseBytesPerSecond +
+                   result.nodeCount / nodesPerSecond +
+                   result.imageBytes / imageBytesPerSecond;
+  result.memoryBytes = result.parseBytes +
+                       result.nodeCount * memoryPerNode +
+                       result.imageBytes * memoryPerImageByte;
+
+  return result;
+}
+
+} // namespace common
+} // namespace odr
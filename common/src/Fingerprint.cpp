@@ -0,0 +1,102 @@
+#include <access/Path.h>
+#include <access/Storage.h>
+#include <algorithm>
+#include <common/Fingerprint.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace odr {
+namespace common {
+
+namespace {
+// two independently seeded 64 bit fnv-1a lanes; the result is stable across
+// platforms and runs, which is all a cache key needs
+class Hash final {
+public:
+  void update(const char *data, const std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+      const auto byte = static_cast<unsigned char>(data[i]);
+      a_ = (a_ ^ byte) * 0x100000001b3ull;
+      b_ = (b_ ^ byte) * 0x9e3779b97f4a7c15ull;
+    }
+  }
+
+  void update(const std::string &string) {
+    // the length keeps concatenated fields apart
+    update(static_cast<std::uint64_t>(string.size()));
+    update(string.data(), string.size());
+  }
+
+  void update(const std::uint64_t value) {
+    char bytes[8];
+    for (std::size_t i = 0; i < 8; ++i)
+      bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    update(bytes, sizeof(bytes));
+  }
+
+  std::string hex() const {
+    const std::uint64_t high = mix(a_ ^ (b_ >> 1));
+    const std::uint64_t low = mix(b_ ^ (a_ << 1));
+    static const char digits[] = "0123456789abcdef";
+    std::string result(32, '0');
+    for (std::size_t i = 0; i < 16; ++i) {
+      result[15 - i] = digits[(high >> (4 * i)) & 0xf];
+      result[31 - i] = digits[(low >> (4 * i)) & 0xf];
+    }
+    return result;
+  }
+
+private:
+  // splitmix64 finalizer
+  static std::uint64_t mix(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  std::uint64_t a_{0xcbf29ce484222325ull};
+  std::uint64_t b_{0x84222325cbf29ce4ull};
+};
+
+// files sorted by name so that the order in the container does not matter
+std::vector<access::Path> files(const access::ReadStorage &storage) {
+  std::vector<access::Path> result;
+  storage.visit([&](const access::Path &path) {
+    if (storage.isFile(path))
+      result.push_back(path);
+  });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+} // namespace
+
+std::string Fingerprint::directory(const access::ReadStorage &storage) {
+  Hash hash;
+  for (auto &&path : files(storage)) {
+    hash.update(path.string());
+    hash.update(storage.size(path));
+    hash.update(static_cast<std::uint64_t>(storage.checksum(path)));
+  }
+  return hash.hex();
+}
+
+std::string Fingerprint::content(const access::ReadStorage &storage) {
+  Hash hash;
+  char buffer[4096];
+  for (auto &&path : files(storage)) {
+    hash.update(path.string());
+    hash.update(storage.size(path));
+    const auto in = storage.read(path);
+    if (!in)
+      continue;
+    while (*in) {
+      in->read(buffer, sizeof(buffer));
+      hash.update(buffer, in->gcount());
+    }
+  }
+  return hash.hex();
+}
+
+} // namespace common
+} // namespace odr
@@ -0,0 +1,52 @@
+#include <common/Fingerprint.h>
+#include <common/IrCache.h>
+#include <common/IrDocument.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+
+namespace odr {
+namespace common {
+
+namespace {
+// keyed by the content: the checksums listed in a directory are easily
+// forged, which would let one upload read or replace another's entry
+std::string path(const std::string &directory,
+                 const access::ReadStorage &storage) {
+  return directory + "/" + Fingerprint::content(storage) + ".odri";
+}
+} // namespace
+
+bool IrCache::load(const std::string &directory,
+                   const access::ReadStorage &storage, IrDocument &out) {
+  std::ifstream in(path(directory, storage), std::ios::binary);
+  if (!in.is_open())
+    return false;
+  try {
+    out = IrDocument::read(in);
+  } catch (const NoIrFileException &) {
+    return false;
+  }
+  return true;
+}
+
+void IrCache::store(const std::string &directory,
+                    const access::ReadStorage &storage, const IrDocument &in) {
+  const std::string target = path(directory, storage);
+  // written aside under a unique name and renamed so that readers never see
+  // a partial file and concurrent writers do not interleave
+  std::string temporary = target + ".XXXXXX";
+  const int fd = ::mkstemp(&temporary[0]);
+  if (fd < 0)
+    return;
+  ::close(fd);
+  std::ofstream out(temporary, std::ios::binary);
+  in.write(out);
+  out.close();
+  if (!out || std::rename(temporary.c_str(), target.c_str()) != 0)
+    std::remove(temporary.c_str());
+}
+
+} // namespace common
+} // namespace odr
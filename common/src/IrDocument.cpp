@@ -0,0 +1,231 @@
+#include <common/IrDocument.h>
+#include <cstring>
+
+namespace odr {
+namespace common {
+
+namespace {
+constexpr char magic[4] = {'o', 'd', 'r', 'i'};
+constexpr std::uint32_t version = 1;
+
+template <typename T> void writePrimitive(std::ostream &out, const T &in) {
+  out.write((const char *)&in, sizeof(in));
+}
+
+template <typename T> void readPrimitive(std::istream &in, T &out) {
+  in.read((char *)&out, sizeof(out));
+  if (!in)
+    throw NoIrFileException();
+}
+
+void writeString(std::ostream &out, const IrString &string) {
+  writePrimitive(out, string.offset);
+  writePrimitive(out, string.length);
+}
+
+void readString(std::istream &in, IrString &string) {
+  readPrimitive(in, string.offset);
+  readPrimitive(in, string.length);
+}
+
+bool inside(const IrString &string, const std::size_t size) {
+  return (string.offset <= size) && (string.length <= size - string.offset);
+}
+} // namespace
+
+IrDocument IrDocument::read(std::istream &in) {
+  char header[sizeof(magic)];
+  in.read(header, sizeof(header));
+  if (!in || (std::memcmp(header, magic, sizeof(magic)) != 0))
+    throw NoIrFileException();
+  std::uint32_t fileVersion;
+  readPrimitive(in, fileVersion);
+  if (fileVersion != version)
+    throw NoIrFileException();
+
+  IrDocument result;
+  result.nodes_.clear();
+
+  std::uint32_t nodeCount;
+  std::uint32_t styleCount;
+  std::uint32_t arenaSize;
+  readPrimitive(in, nodeCount);
+  readPrimitive(in, styleCount);
+  readPrimitive(in, arenaSize);
+
+  result.arena_.resize(arenaSize);
+  in.read(result.arena_.data(), arenaSize);
+  if (!in)
+    throw NoIrFileException();
+
+  result.styles_.resize(styleCount);
+  for (auto &&style : result.styles_) {
+    readString(in, style);
+    if (!inside(style, arenaSize))
+      throw NoIrFileException();
+  }
+
+  result.nodes_.resize(nodeCount);
+  // ends of the ancestors of the current node; subtrees have to nest
+  std::vector<std::uint32_t> ends{nodeCount};
+  for (std::uint32_t i = 0; i < nodeCount; ++i) {
+    IrNode &node = result.nodes_[i];
+    std::uint8_t type;
+    readPrimitive(in, type);
+    if (type > (std::uint8_t)IrType::IMAGE)
+      throw NoIrFileException();
+    node.type = (IrType)type;
+    readPrimitive(in, node.end);
+    readPrimitive(in, node.style);
+    readPrimitive(in, node.repeat);
+    readPrimitive(in, node.colSpan);
+    readPrimitive(in, node.rowSpan);
+    readString(in, node.text);
+    if ((node.end <= i) || (node.end > nodeCount) ||
+        ((node.style != IrNode::noStyle) && (node.style >= styleCount)) ||
+        !inside(node.text, arenaSize))
+      throw NoIrFileException();
+    while (ends.back() <= i)
+      ends.pop_back();
+    if (node.end > ends.back())
+      throw NoIrFileException();
+    ends.push_back(node.end);
+  }
+  if (result.nodes_.empty() || (result.nodes_[0].end != nodeCount))
+    throw NoIrFileException();
+
+  return result;
+}
+
+IrDocument::IrDocument() { clear(); }
+
+void IrDocument::write(std::ostream &out) const {
+  out.write(magic, sizeof(magic));
+  writePrimitive(out, version);
+  writePrimitive(out, (std::uint32_t)nodes_.size());
+  writePrimitive(out, (std::uint32_t)styles_.size());
+  writePrimitive(out, (std::uint32_t)arena_.size());
+  out.write(arena_.data(), arena_.size());
+  for (auto &&style : styles_)
+    writeString(out, style);
+  for (auto &&node : nodes_) {
+    writePrimitive(out, (std::uint8_t)node.type);
+    writePrimitive(out, node.end);
+    writePrimitive(out, node.style);
+    writePrimitive(out, node.repeat);
+    writePrimitive(out, node.colSpan);
+    writePrimitive(out, node.rowSpan);
+    writeString(out, node.text);
+  }
+}
+
+void IrDocument::clear() {
+  nodes_.clear();
+  styles_.clear();
+  arena_.clear();
+  styleIds_.clear();
+  open_.clear();
+  mergeText_ = false;
+
+  // the root stays open until the document is cleared again
+  nodes_.emplace_back().end = 1;
+  open_.push_back(0);
+}
+
+std::string_view IrDocument::string(const IrString &string) const noexcept {
+  return std::string_view(arena_).substr(string.offset, string.length);
+}
+
+std::string_view IrDocument::text(const std::uint32_t index) const noexcept {
+  return string(nodes_[index].text);
+}
+
+std::string_view IrDocument::style(const std::uint32_t index) const noexcept {
+  const std::uint32_t style = nodes_[index].style;
+  if (style == IrNode::noStyle)
+    return {};
+  return string(styles_[style]);
+}
+
+std::uint32_t IrDocument::open(const IrType type, const std::string &style) {
+  const std::uint32_t index = leaf(type, style);
+  open_.push_back(index);
+  return index;
+}
+
+void IrDocument::close() {
+  mergeText_ = false;
+  if (open_.size() <= 1)
+    return;
+  nodes_[open_.back()].end = (std::uint32_t)nodes_.size();
+  open_.pop_back();
+}
+
+std::uint32_t IrDocument::leaf(const IrType type, const std::string &style) {
+  mergeText_ = false;
+  const auto index = (std::uint32_t)nodes_.size();
+  IrNode &node = nodes_.emplace_back();
+  node.type = type;
+  node.end = index + 1;
+  if (!style.empty())
+    node.style = styleId_(style);
+  // open nodes get their end on `close`; the root is never closed
+  nodes_[0].end = index + 1;
+  return index;
+}
+
+void IrDocument::appendText(const char *text) {
+  const std::size_t length = std::strlen(text);
+  if (length == 0)
+    return;
+
+  // adjacent text is merged into one node
+  if (mergeText_ && (nodes_.back().text.offset + nodes_.back().text.length ==
+                     arena_.size())) {
+    arena_.append(text, length);
+    nodes_.back().text.length += (std::uint32_t)length;
+    return;
+  }
+
+  const std::uint32_t index = leaf(IrType::TEXT);
+  nodes_[index].text = intern_(text, length);
+  mergeText_ = true;
+}
+
+void IrDocument::setText(const std::uint32_t index, const std::string &text) {
+  mergeText_ = false;
+  nodes_[index].text = intern_(text.data(), text.size());
+}
+
+void IrDocument::setRepeat(const std::uint32_t index,
+                           const std::uint32_t repeat) {
+  nodes_[index].repeat = repeat;
+}
+
+void IrDocument::setSpan(const std::uint32_t index,
+                         const std::uint32_t colSpan,
+                         const std::uint32_t rowSpan) {
+  nodes_[index].colSpan = colSpan;
+  nodes_[index].rowSpan = rowSpan;
+}
+
+IrString IrDocument::intern_(const char *text, const std::size_t length) {
+  IrString result;
+  result.offset = (std::uint32_t)arena_.size();
+  result.length = (std::uint32_t)length;
+  arena_.append(text, length);
+  return result;
+}
+
+std::uint32_t IrDocument::styleId_(const std::string &style) {
+  const auto it = styleIds_.find(style);
+  if (it != styleIds_.end())
+    return it->second;
+  const auto id = (std::uint32_t)styles_.size();
+  styles_.push_back(intern_(style.data(), style.size()));
+  styleIds_.emplace(style, id);
+  return id;
+}
+
+} // namespace common
+} // namespace odr
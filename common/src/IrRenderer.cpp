@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <common/IrDocument.h>
+#include <common/IrRenderer.h>
+#include <cstdio>
+#include <odr/Config.h>
+#include <vector>
+
+namespace odr {
+namespace common {
+
+namespace {
+bool isEntry(const IrType type) {
+  return (type == IrType::PAGE) || (type == IrType::SHEET);
+}
+
+bool selected(const std::uint32_t entry, const Config &config) {
+  if (entry < config.entryOffset)
+    return false;
+  return (config.entryCount == 0) ||
+         (entry - config.entryOffset < config.entryCount);
+}
+
+const char *typeName(const IrType type) {
+  switch (type) {
+  case IrType::ROOT:
+    return "root";
+  case IrType::TEXT:
+    return "text";
+  case IrType::PARAGRAPH:
+    return "paragraph";
+  case IrType::SPAN:
+    return "span";
+  case IrType::LINK:
+    return "link";
+  case IrType::BOOKMARK:
+    return "bookmark";
+  case IrType::SPACE:
+    return "space";
+  case IrType::TAB:
+    return "tab";
+  case IrType::LINE_BREAK:
+    return "line-break";
+  case IrType::LIST:
+    return "list";
+  case IrType::LIST_ITEM:
+    return "list-item";
+  case IrType::PAGE:
+    return "page";
+  case IrType::SHEET:
+    return "sheet";
+  case IrType::TABLE:
+    return "table";
+  case IrType::TABLE_COLUMN:
+    return "table-column";
+  case IrType::TABLE_ROW:
+    return "table-row";
+  case IrType::TABLE_CELL:
+    return "table-cell";
+  case IrType::FRAME:
+    return "frame";
+  case IrType::SHAPE:
+    return "shape";
+  case IrType::IMAGE:
+    return "image";
+  }
+  return "unknown";
+}
+
+void jsonString(const std::string_view &string, std::ostream &out) {
+  out << '"';
+  for (auto &&c : string) {
+    switch (c) {
+    case '"':
+      out << "\\\"";
+      break;
+    case '\\':
+      out << "\\\\";
+      break;
+    case '\n':
+      out << "\\n";
+      break;
+    case '\t':
+      out << "\\t";
+      break;
+    default:
+      if ((unsigned char)c < 0x20) {
+        char escaped[7];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out << escaped;
+      } else {
+        out << c;
+      }
+    }
+  }
+  out << '"';
+}
+
+struct TextFrame {
+  std::uint32_t index{0};
+  std::uint32_t next{0};
+  std::uint32_t iteration{0};
+  std::uint32_t repeat{1};
+  // first visible row or column of a repeated row or cell
+  std::uint32_t first{0};
+  // next row of a table or next column of a row including invisible ones
+  std::uint32_t position{0};
+  // last row or column that produced output
+  std::uint32_t last{0};
+  bool any{false};
+};
+
+// visible part of `repeat` rows or columns starting at `position`; returns
+// the number of visible repetitions and sets `first` relative to `offset`
+std::uint32_t visible(const std::uint32_t position, const std::uint32_t repeat,
+                      const std::uint32_t offset, const std::uint32_t limit,
+                      std::uint32_t &first) {
+  const std::uint64_t begin = std::max(position, offset);
+  const std::uint64_t end =
+      std::min((std::uint64_t)position + repeat, (std::uint64_t)offset + limit);
+  if (begin >= end)
+    return 0;
+  first = (std::uint32_t)(begin - offset);
+  return (std::uint32_t)(end - begin);
+}
+
+std::uint32_t advance(const std::uint32_t position,
+                      const std::uint32_t repeat) {
+  return (std::uint32_t)std::min<std::uint64_t>(
+      (std::uint64_t)position + repeat, 0xFFFFFFFF);
+}
+} // namespace
+
+void IrRenderer::text(const IrDocument &in, const Config &config,
+                      std::ostream &out) {
+  const auto &nodes = in.nodes();
+  std::vector<TextFrame> stack;
+  std::uint32_t entry = 0;
+  std::uint32_t cellDepth = 0;
+
+  // emits the separator in front of each iteration of a row or cell
+  const auto begin = [&](TextFrame &frame, TextFrame &parent) {
+    const IrType type = nodes[frame.index].type;
+    if ((type != IrType::TABLE_ROW) && (type != IrType::TABLE_CELL))
+      return;
+    const std::uint32_t position = frame.first + frame.iteration;
+    for (std::uint32_t i = parent.last; i < position; ++i)
+      out << (type == IrType::TABLE_ROW ? '\n' : '\t');
+    parent.last = position;
+    parent.any = true;
+  };
+
+  stack.push_back({0, 1});
+  while (!stack.empty()) {
+    TextFrame &top = stack.back();
+    const IrNode &node = nodes[top.index];
+
+    if (top.next < node.end) {
+      const std::uint32_t index = top.next;
+      const IrNode &child = nodes[index];
+      top.next = child.end;
+
+      TextFrame frame;
+      frame.index = index;
+      frame.next = index + 1;
+
+      switch (child.type) {
+      case IrType::TEXT:
+        out << in.text(index);
+        continue;
+      case IrType::SPACE:
+        for (std::uint32_t i = 0; i < child.repeat; ++i)
+          out << ' ';
+        continue;
+      case IrType::TAB:
+        out << '\t';
+        continue;
+      case IrType::LINE_BREAK:
+        out << '\n';
+        continue;
+      case IrType::TABLE_COLUMN:
+        continue;
+      case IrType::TABLE_ROW: {
+        const std::uint32_t position = top.position;
+        top.position = advance(top.position, child.repeat);
+        frame.repeat =
+            visible(position, child.repeat, config.tableOffsetRows,
+                    config.tableLimitRows, frame.first);
+        // empty rows only advance the position
+        if ((frame.repeat == 0) || (child.end == index + 1))
+          continue;
+      } break;
+      case IrType::TABLE_CELL: {
+        const std::uint32_t position = top.position;
+        top.position = advance(top.position, child.repeat);
+        frame.repeat =
+            visible(position, child.repeat, config.tableOffsetCols,
+                    config.tableLimitCols, frame.first);
+        if ((frame.repeat == 0) || (child.end == index + 1))
+          continue;
+        ++cellDepth;
+      } break;
+      default:
+        break;
+      }
+
+      if (isEntry(child.type) && !selected(entry++, config))
+        continue;
+
+      // invalidates `top`
+      stack.push_back(frame);
+      begin(stack.back(), stack[stack.size() - 2]);
+      continue;
+    }
+
+    if (++top.iteration < top.repeat) {
+      top.next = top.index + 1;
+      top.position = 0;
+      top.last = 0;
+      top.any = false;
+      begin(top, stack[stack.size() - 2]);
+      continue;
+    }
+
+    switch (node.type) {
+    case IrType::PARAGRAPH:
+      out << (cellDepth > 0 ? ' ' : '\n');
+      break;
+    case IrType::TABLE_CELL:
+      --cellDepth;
+      break;
+    case IrType::TABLE:
+    case IrType::SHEET:
+      if (top.any)
+        out << '\n';
+      break;
+    case IrType::PAGE:
+      out << '\n';
+      break;
+    default:
+      break;
+    }
+    stack.pop_back();
+  }
+}
+
+void IrRenderer::json(const IrDocument &in, const Config &config,
+                      std::ostream &out) {
+  const auto &nodes = in.nodes();
+  struct JsonFrame {
+    std::uint32_t index;
+    std::uint32_t next;
+    bool first;
+  };
+  std::vector<JsonFrame> stack;
+  std::uint32_t entry = 0;
+
+  const auto open = [&](const std::uint32_t index) {
+    const IrNode &node = nodes[index];
+    out << "{\"type\":\"" << typeName(node.type) << "\"";
+    if (node.style != IrNode::noStyle) {
+      out << ",\"style\":";
+      jsonString(in.style(index), out);
+    }
+    if (node.text.length > 0) {
+      out << ",\"text\":";
+      jsonString(in.text(index), out);
+    }
+    if (node.repeat != 1)
+      out << ",\"repeat\":" << node.repeat;
+    if (node.colSpan != 1)
+      out << ",\"colSpan\":" << node.colSpan;
+    if (node.rowSpan != 1)
+      out << ",\"rowSpan\":" << node.rowSpan;
+    if (node.end == index + 1) {
+      out << "}";
+      return;
+    }
+    out << ",\"children\":[";
+    stack.push_back({index, index + 1, true});
+  };
+
+  open(0);
+  while (!stack.empty()) {
+    auto &top = stack.back();
+    const IrNode &node = nodes[top.index];
+
+    if (top.next < node.end) {
+      const std::uint32_t index = top.next;
+      const IrNode &child = nodes[index];
+      top.next = child.end;
+
+      if (isEntry(child.type) && !selected(entry++, config))
+        continue;
+      if (!top.first)
+        out << ",";
+      top.first = false;
+      // invalidates `top`
+      open(index);
+      continue;
+    }
+
+    out << "]}";
+    stack.pop_back();
+  }
+}
+
+} // namespace common
+} // namespace odr
@@ -3,12 +3,13 @@
 namespace odr {
 namespace common {
 
-bool StringUtil::startsWith(const std::string &string,
-                            const std::string &with) {
-  return string.rfind(with, 0) == 0;
+bool StringUtil::startsWith(const std::string_view string,
+                            const std::string_view with) {
+  return string.substr(0, with.length()) == with;
 }
 
-bool StringUtil::endsWith(const std::string &string, const std::string &with) {
+bool StringUtil::endsWith(const std::string_view string,
+                          const std::string_view with) {
   return (string.length() >= with.length()) &&
          (string.compare(string.length() - with.length(), with.length(),
                          with) == 0);
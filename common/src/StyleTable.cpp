@@ -0,0 +1,31 @@
+#include <common/StyleTable.h>
+#include <ostream>
+
+namespace odr {
+namespace common {
+
+std::string StyleTable::intern(const std::string &declarations) {
+  const auto it =
+      ids_.emplace(declarations, static_cast<std::uint32_t>(ids_.size()));
+  if (it.second)
+    declarations_.push_back(&it.first->first);
+  return name_(it.first->second);
+}
+
+void StyleTable::clear() noexcept {
+  ids_.clear();
+  declarations_.clear();
+}
+
+void StyleTable::css(std::ostream &out) const {
+  for (std::uint32_t i = 0; i < declarations_.size(); ++i) {
+    out << "." << name_(i) << " {" << *declarations_[i] << "}\n";
+  }
+}
+
+std::string StyleTable::name_(const std::uint32_t id) {
+  return "odr-i" + std::to_string(id);
+}
+
+} // namespace common
+} // namespace odr
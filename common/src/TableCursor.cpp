@@ -1,9 +1,10 @@
+#include <algorithm>
 #include <common/TableCursor.h>
 
 namespace odr {
 namespace common {
 
-TableCursor::TableCursor() noexcept { sparse_.emplace_back(); }
+TableCursor::TableCursor() noexcept = default;
 
 void TableCursor::addCol(const std::uint32_t repeat) noexcept {
   col_ += repeat;
@@ -12,14 +13,11 @@ void TableCursor::addCol(const std::uint32_t repeat) noexcept {
 void TableCursor::addRow(const std::uint32_t repeat) noexcept {
   row_ += repeat;
   col_ = 0;
-  if (repeat > 1) {
-    // TODO assert trivial
-    sparse_.clear();
-  } else if (repeat == 1) {
-    sparse_.pop_front();
-  }
-  if (sparse_.empty())
-    sparse_.emplace_back();
+  spans_.erase(std::remove_if(spans_.begin(), spans_.end(),
+                              [&](const Span &span) {
+                                return span.lastRow <= row_;
+                              }),
+               spans_.end());
   handleRowspan();
 }
 
@@ -29,12 +27,14 @@ void TableCursor::addCell(const std::uint32_t colspan,
   const auto newNextCols = col_ + colspan * repeat;
 
   // handle rowspan
-  auto it = sparse_.begin();
-  for (std::uint32_t i = 1; i < rowspan; ++i) {
-    if (std::next(it) == sparse_.end())
-      sparse_.emplace_back();
-    ++it;
-    it->emplace_back(Range{col_, newNextCols});
+  if (rowspan > 1) {
+    const auto it = std::upper_bound(
+        spans_.begin(), spans_.end(), col_,
+        [](const std::uint32_t col, const Span &span) {
+          return col < span.start;
+        });
+    spans_.insert(it, Span{col_, newNextCols, (std::uint64_t)row_ + 1,
+                           (std::uint64_t)row_ + rowspan});
   }
 
   col_ = newNextCols;
@@ -42,13 +42,14 @@ void TableCursor::addCell(const std::uint32_t colspan,
 }
 
 void TableCursor::handleRowspan() noexcept {
-  auto &s = sparse_.front();
-  auto it = s.begin();
-  while ((it != s.end()) && (col_ == it->start)) {
-    col_ = it->end;
-    ++it;
+  auto it = std::lower_bound(spans_.begin(), spans_.end(), col_,
+                             [](const Span &span, const std::uint32_t col) {
+                               return span.start < col;
+                             });
+  for (; (it != spans_.end()) && (it->start <= col_); ++it) {
+    if ((it->start == col_) && (it->firstRow <= row_))
+      col_ = it->end;
   }
-  s.erase(s.begin(), it);
 }
 
 } // namespace common
@@ -1,6 +1,7 @@
 #include <access/Path.h>
 #include <access/Storage.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
 #include <common/XmlUtil.h>
 #include <pugixml.hpp>
 
@@ -24,11 +25,12 @@ pugi::xml_document XmlUtil::parse(std::istream &in) {
 }
 
 pugi::xml_document XmlUtil::parse(const access::ReadStorage &storage,
-                                  const access::Path &path) {
+                                  const access::PathView path) {
+  const access::Trace::Span span("parse", path.string());
   pugi::xml_document result;
   auto in = storage.read(path);
   if (!in)
-    throw access::FileNotFoundException(path.string());
+    throw access::FileNotFoundException(std::string(path.string()));
   const auto success = result.load(*in);
   if (!success)
     throw NotXmlException();
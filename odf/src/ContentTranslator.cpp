@@ -3,14 +3,19 @@
 #include <access/Path.h>
 #include <access/Storage.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
+#include <algorithm>
+#include <common/IrDocument.h>
 #include <common/StringUtil.h>
+#include <common/XmlTraversal.h>
 #include <crypto/CryptoUtil.h>
 #include <cstring>
-#include <glog/logging.h>
 #include <odr/Config.h>
 #include <odr/Meta.h>
 #include <pugixml.hpp>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <svm/Svm2Svg.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -19,6 +24,19 @@ namespace odr {
 namespace odf {
 
 namespace {
+// `text:c` of a single `text:s` is clamped to this; the attribute alone could
+// otherwise expand a few bytes of input to gigabytes of output
+constexpr std::uint32_t maxSpaces = 1024;
+
+// the configuration axes checked per node are fixed for a whole translation;
+// they are resolved once in `ContentTranslator::html` so the inner loops are
+// free of these branches
+template <bool Editable, bool Spreadsheet> struct TranslationPolicy {
+  static constexpr bool editable = Editable;
+  static constexpr bool spreadsheet = Spreadsheet;
+};
+
+template <typename Policy>
 void TextTranslator(const pugi::xml_text &in, std::ostream &out,
                     Context &context) {
   std::string text = in.as_string();
@@ -26,57 +44,64 @@ void TextTranslator(const pugi::xml_text &in, std::ostream &out,
   common::StringUtil::findAndReplaceAll(text, "<", "&lt;");
   common::StringUtil::findAndReplaceAll(text, ">", "&gt;");
 
-  if (!context.config->editable) {
+  if constexpr (!Policy::editable) {
     out << text;
   } else {
-    out << R"(<span contenteditable="true" data-odr-cid=")"
-        << context.currentTextTranslationIndex << "\">" << text << "</span>";
-    context.textTranslation[context.currentTextTranslationIndex] = &in;
+    // an empty comment marks translated text; the client derives the index
+    // from the marker's position inside its block
+    out << "<!---->" << text;
+    if (context.currentTextTranslationIndex >= context.textTranslation.size())
+      context.textTranslation.resize(context.currentTextTranslationIndex + 1);
+    context.textTranslation[context.currentTextTranslationIndex] = in;
     ++context.currentTextTranslationIndex;
   }
 }
 
 void StyleClassTranslator(const std::string &name, std::ostream &out,
                           Context &context) {
-  out << name;
+  out << StyleTranslator::className(name, context);
+  if (context.referencedStyles != nullptr)
+    context.referencedStyles->insert(name);
 
   { // handle style dependencies
     const auto it = context.styleDependencies.find(name);
     if (it == context.styleDependencies.end()) {
-      // TODO remove ?
-      LOG(WARNING) << "unknown style: " << name;
+      context.diagnostics.report("unknown style", name);
     } else {
       for (auto i = it->second.rbegin(); i != it->second.rend(); ++i) {
-        out << " " << *i;
+        out << " " << StyleTranslator::className(*i, context);
       }
     }
   }
 }
 
+// `classes` are written in front of the style classes
+template <typename Policy>
 void StyleClassTranslator(const pugi::xml_node &in, std::ostream &out,
-                          Context &context) {
-  static std::unordered_set<std::string> styleAttributes{
+                          Context &context, const char *classes = "") {
+  static const std::unordered_set<std::string_view> styleAttributes{
       "text:style-name",         "table:style-name",
       "draw:style-name",         "draw:text-style-name",
       "presentation:style-name", "draw:master-page-name",
   };
 
-  out << " class=\"";
+  out << " class=\"" << classes;
 
-  // TODO this is ods specific
-  if (!in.attribute("table:style-name")) {
+  if (Policy::spreadsheet && !in.attribute("table:style-name")) {
     const auto it = context.defaultCellStyles.find(context.tableCursor.col());
     if (it != context.defaultCellStyles.end()) {
       StyleClassTranslator(it->second, out, context);
       out << " ";
     }
   }
+  // only floats are styled by default; compact output omits the others
   if (const auto valueTypeAttr = in.attribute("office:value-type");
-      valueTypeAttr)
+      valueTypeAttr && (!context.config->compact ||
+                        (std::strcmp(valueTypeAttr.as_string(), "float") == 0)))
     out << "odr-value-type-" << valueTypeAttr.as_string() << " ";
 
   for (auto &&a : in.attributes()) {
-    const std::string attribute = a.name();
+    const std::string_view attribute = a.name();
     if (styleAttributes.find(attribute) == styleAttributes.end())
       continue;
     std::string name = StyleTranslator::escapeStyleName(a.as_string());
@@ -88,84 +113,152 @@ void StyleClassTranslator(const pugi::xml_node &in, std::ostream &out,
   out << "\"";
 }
 
+template <typename Policy>
+void BlockAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
+                              Context &context) {
+  if (!Policy::editable || (context.currentBlock >= context.blocks.size()) ||
+      (context.blocks[context.currentBlock].node != in))
+    return;
+  out << R"( contenteditable="true" data-odr-bid=")" << context.currentBlock
+      << "\"";
+}
+
+template <typename Policy>
 void ElementAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
-                                Context &context) {
-  StyleClassTranslator(in, out, context);
+                                Context &context, const char *classes = "") {
+  StyleClassTranslator<Policy>(in, out, context, classes);
+  BlockAttributeTranslator<Policy>(in, out, context);
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context);
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context);
+struct ElementTranslator;
+
+struct ElementState {
+  const ElementTranslator *translator{nullptr};
+  bool open{false};
+};
+
+typedef common::XmlTraversal::Frame<ElementState> Frame;
+
+struct ElementTranslator {
+  // writes the opening part; returns false to skip the element entirely
+  bool (*enter)(Frame &, std::ostream &, Context &);
+  // writes the closing part; returns true to repeat the element
+  bool (*leave)(Frame &, std::ostream &, Context &);
+};
+
+bool NoLeave(Frame &, std::ostream &, Context &) { return false; }
 
-void ParagraphTranslator(const pugi::xml_node &in, std::ostream &out,
-                         Context &context) {
+template <typename Policy>
+bool ParagraphEnter(Frame &frame, std::ostream &out, Context &context) {
   out << "<p";
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator<Policy>(frame.node, out, context);
   out << ">";
 
-  if (in.first_child())
-    ElementChildrenTranslator(in, out, context);
-  else
+  if (!frame.node.first_child())
     out << "<br>";
 
+  return true;
+}
+
+bool ParagraphLeave(Frame &, std::ostream &out, Context &) {
   out << "</p>";
+  return false;
+}
+
+bool WhitespaceElement(const pugi::xml_node &in) {
+  const char *element = in.name();
+  if (std::strcmp(element, "text:s") == 0)
+    return in.attribute("text:c").as_uint(1) > 0;
+  return std::strcmp(element, "text:tab") == 0;
+}
+
+// adjacent whitespace elements share one span in compact output
+void WhitespaceOpen(const pugi::xml_node &in, std::ostream &out,
+                    Context &context) {
+  if (!context.config->compact || !WhitespaceElement(in.previous_sibling()))
+    out << "<span class=\"odr-whitespace\">";
 }
 
-void SpaceTranslator(const pugi::xml_node &in, std::ostream &out, Context &) {
-  const auto count = in.attribute("text:c").as_uint(1);
+void WhitespaceClose(const pugi::xml_node &in, std::ostream &out,
+                     Context &context) {
+  if (!context.config->compact || !WhitespaceElement(in.next_sibling()))
+    out << "</span>";
+}
+
+bool SpaceEnter(Frame &frame, std::ostream &out, Context &context) {
+  auto count = frame.node.attribute("text:c").as_uint(1);
   if (count <= 0)
-    return;
+    return false;
+  if (count > maxSpaces) {
+    context.diagnostics.report("spaces clamped", std::to_string(count));
+    count = maxSpaces;
+  }
 
-  out << "<span class=\"odr-whitespace\">";
+  WhitespaceOpen(frame.node, out, context);
   for (std::uint32_t i = 0; i < count; ++i) {
     out << " ";
   }
-  out << "</span>";
+  WhitespaceClose(frame.node, out, context);
+  frame.next = {};
+  return true;
 }
 
-void TabTranslator(const pugi::xml_node &, std::ostream &out, Context &) {
-  out << "<span class=\"odr-whitespace\">&emsp;</span>";
+bool TabEnter(Frame &frame, std::ostream &out, Context &context) {
+  WhitespaceOpen(frame.node, out, context);
+  out << "&emsp;";
+  WhitespaceClose(frame.node, out, context);
+  frame.next = {};
+  return true;
 }
 
-void LineBreakTranslator(const pugi::xml_node &, std::ostream &out, Context &) {
+bool LineBreakEnter(Frame &frame, std::ostream &out, Context &) {
   out << "<br>";
+  frame.next = {};
+  return true;
 }
 
-void LinkTranslator(const pugi::xml_node &in, std::ostream &out,
-                    Context &context) {
+template <typename Policy>
+bool LinkEnter(Frame &frame, std::ostream &out, Context &context) {
   out << "<a";
-  if (const auto href = in.attribute("xlink:href"); href) {
+  if (const auto href = frame.node.attribute("xlink:href"); href) {
     out << " href=\"" << href.as_string() << "\"";
     // NOTE: there is a trim in java
     if ((std::strlen(href.as_string()) > 0) && (href.as_string()[0] == '#')) {
       out << " target=\"_self\"";
     }
   } else {
-    LOG(WARNING) << "empty link";
+    context.diagnostics.report("link without href");
   }
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator<Policy>(frame.node, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool LinkLeave(Frame &, std::ostream &out, Context &) {
   out << "</a>";
+  return false;
 }
 
-void BookmarkTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
+template <typename Policy>
+bool BookmarkEnter(Frame &frame, std::ostream &out, Context &context) {
   out << "<a";
-  if (const auto id = in.attribute("text:name"); id) {
+  if (const auto id = frame.node.attribute("text:name"); id) {
     out << " id=\"" << id.as_string() << "\"";
   } else {
-    LOG(WARNING) << "empty bookmark";
+    context.diagnostics.report("bookmark without name");
   }
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator<Policy>(frame.node, out, context);
   out << ">";
 
   out << "</a>";
+  frame.next = {};
+  return true;
 }
 
-void FrameTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+template <typename Policy>
+bool FrameEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   out << "<div style=\"";
 
   if (const auto widthAttr = in.attribute("svg:width"); widthAttr)
@@ -179,14 +272,20 @@ void FrameTranslator(const pugi::xml_node &in, std::ostream &out,
 
   out << "\"";
 
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator<Policy>(in, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool FrameLeave(Frame &, std::ostream &out, Context &) {
   out << "</div>";
+  return false;
 }
 
-void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+template <typename Policy>
+bool ImageEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   out << "<img style=\"width:100%;height:100%\"";
 
   if (const auto hrefAttr = in.attribute("xlink:href"); hrefAttr) {
@@ -195,6 +294,7 @@ void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
     out << " src=\"";
     try {
       const access::Path path{href};
+      const access::Trace::Span span("image", path.string());
       if (!context.storage->isFile(path)) {
         // TODO sometimes `ObjectReplacements` does not exist
         out << path;
@@ -203,9 +303,10 @@ void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
             access::StreamUtil::read(*context.storage->read(path));
         if ((href.find("ObjectReplacements", 0) != std::string::npos) ||
             (href.find(".svm", 0) != std::string::npos)) {
+          const access::Trace::Span svmSpan("svm", path.string());
           std::istringstream svmIn(image);
           std::ostringstream svgOut;
-          svm::Translator::svg(svmIn, svgOut);
+          svm::Translator::svg(svmIn, svgOut, &context.diagnostics);
           image = svgOut.str();
           out << "data:image/svg+xml;base64, ";
         } else {
@@ -215,31 +316,35 @@ void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
         out << crypto::Util::base64Encode(image);
       }
     } catch (...) {
+      context.diagnostics.report("image not readable", href);
       out << href;
     }
     out << "\"";
   } else {
     out << " alt=\"Error: image path not specified";
-    LOG(ERROR) << "image href not found";
+    context.diagnostics.report("image without href");
   }
 
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator<Policy>(in, out, context);
   out << ">";
   // TODO children for image?
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool ImageLeave(Frame &, std::ostream &out, Context &) {
   out << "</img>";
+  return false;
 }
 
-void TableTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+template <typename Policy>
+bool TableEnter(Frame &frame, std::ostream &out, Context &context) {
   context.tableRange = {
       {context.config->tableOffsetRows, context.config->tableOffsetCols},
       context.config->tableLimitRows,
       context.config->tableLimitCols};
 
-  // TODO remove file check; add simple table translator for odt/odp
-  if ((context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET) &&
-      context.config->tableLimitByDimensions) {
+  // TODO add simple table translator for odt/odp
+  if (Policy::spreadsheet && context.config->tableLimitByDimensions) {
     const common::TablePosition end{
         context.meta->entries[context.entry].rowCount,
         context.meta->entries[context.entry].columnCount};
@@ -251,17 +356,24 @@ void TableTranslator(const pugi::xml_node &in, std::ostream &out,
   context.defaultCellStyles.clear();
 
   out << "<table";
-  ElementAttributeTranslator(in, out, context);
-  out << R"( cellpadding="0" border="0" cellspacing="0")";
+  ElementAttributeTranslator<Policy>(frame.node, out, context);
+  // compact output relies on `Html::odfCompactStyle` instead
+  if (!context.config->compact)
+    out << R"( cellpadding="0" border="0" cellspacing="0")";
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool TableLeave(Frame &, std::ostream &out, Context &context) {
   out << "</table>";
 
   ++context.entry;
+  return false;
 }
 
-void TableColumnTranslator(const pugi::xml_node &in, std::ostream &out,
-                           Context &context) {
+template <typename Policy>
+bool TableColumnEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
   const auto repeated =
       in.attribute("table:number-columns-repeated").as_uint(1);
   const auto defaultCellStyleAttribute =
@@ -271,73 +383,96 @@ void TableColumnTranslator(const pugi::xml_node &in, std::ostream &out,
     if (context.tableCursor.col() >= context.tableRange.to().col())
       break;
     if (context.tableCursor.col() >= context.tableRange.from().col()) {
-      if (defaultCellStyleAttribute)
+      if (Policy::spreadsheet && defaultCellStyleAttribute)
         context.defaultCellStyles[context.tableCursor.col()] =
             defaultCellStyleAttribute.as_string();
       out << "<col";
-      ElementAttributeTranslator(in, out, context);
+      ElementAttributeTranslator<Policy>(in, out, context);
       out << ">";
     }
     context.tableCursor.addCol();
   }
+  frame.next = {};
+  return true;
 }
 
-void TableRowTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
-  const auto repeated = in.attribute("table:number-rows-repeated").as_uint(1);
-  context.tableCursor.addRow(0); // TODO hacky
-  for (std::uint32_t i = 0; i < repeated; ++i) {
-    if (context.tableCursor.row() >= context.tableRange.to().row())
-      break;
-    if (context.tableCursor.row() >= context.tableRange.from().row()) {
-      out << "<tr";
-      ElementAttributeTranslator(in, out, context);
-      out << ">";
-      ElementChildrenTranslator(in, out, context);
-      out << "</tr>";
-    }
-    context.tableCursor.addRow();
+template <typename Policy>
+bool TableRowEnter(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.iteration == 0)
+    context.tableCursor.addRow(0); // TODO hacky
+  if (context.tableCursor.row() >= context.tableRange.to().row())
+    return false;
+  frame.state.open =
+      context.tableCursor.row() >= context.tableRange.from().row();
+  if (frame.state.open) {
+    out << "<tr";
+    ElementAttributeTranslator<Policy>(frame.node, out, context);
+    out << ">";
+  } else {
+    frame.next = {};
   }
+  return true;
 }
 
-void TableCellTranslator(const pugi::xml_node &in, std::ostream &out,
-                         Context &context) {
+bool TableRowLeave(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.state.open)
+    out << "</tr>";
+  context.tableCursor.addRow();
+  const auto repeated =
+      frame.node.attribute("table:number-rows-repeated").as_uint(1);
+  return frame.iteration + 1 < repeated;
+}
+
+template <typename Policy>
+bool TableCellEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+  if (context.tableCursor.col() >= context.tableRange.to().col())
+    return false;
+  frame.state.open =
+      context.tableCursor.col() >= context.tableRange.from().col();
+  if (frame.state.open) {
+    const auto colspan =
+        in.attribute("table:number-columns-spanned").as_uint(1);
+    const auto rowspan = in.attribute("table:number-rows-spanned").as_uint(1);
+    out << "<td";
+    ElementAttributeTranslator<Policy>(in, out, context);
+    // TODO check for >1?
+    if (in.attribute("table:number-columns-spanned"))
+      out << " colspan=\"" << colspan << "\"";
+    if (in.attribute("table:number-rows-spanned"))
+      out << " rowspan=\"" << rowspan << "\"";
+    out << ">";
+  } else {
+    frame.next = {};
+  }
+  return true;
+}
+
+bool TableCellLeave(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+  if (frame.state.open)
+    out << "</td>";
   const auto repeated =
       in.attribute("table:number-columns-repeated").as_uint(1);
   const auto colspan = in.attribute("table:number-columns-spanned").as_uint(1);
   const auto rowspan = in.attribute("table:number-rows-spanned").as_uint(1);
-  for (std::uint32_t i = 0; i < repeated; ++i) {
-    if (context.tableCursor.col() >= context.tableRange.to().col())
-      break;
-    if (context.tableCursor.col() >= context.tableRange.from().col()) {
-      out << "<td";
-      ElementAttributeTranslator(in, out, context);
-      // TODO check for >1?
-      if (in.attribute("table:number-columns-spanned"))
-        out << " colspan=\"" << colspan << "\"";
-      if (in.attribute("table:number-rows-spanned"))
-        out << " rowspan=\"" << rowspan << "\"";
-      out << ">";
-      ElementChildrenTranslator(in, out, context);
-      out << "</td>";
-    }
-    context.tableCursor.addCell(colspan, rowspan);
-  }
+  context.tableCursor.addCell(colspan, rowspan);
+  return frame.iteration + 1 < repeated;
 }
 
-void DrawLineTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
+template <typename Policy>
+bool DrawLineEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
   const auto x1 = in.attribute("svg:x1");
   const auto y1 = in.attribute("svg:y1");
   const auto x2 = in.attribute("svg:x2");
   const auto y2 = in.attribute("svg:y2");
 
   if (!x1 || !y1 || !x2 || !y2)
-    return;
+    return false;
 
-  out << R"(<svg xmlns="http://www.w3.org/2000/svg" version="1.1" overflow="visible" style="z-index:-1;position:absolute;top:0;left:0;")";
-
-  ElementAttributeTranslator(in, out, context);
+  out << "<svg";
+  ElementAttributeTranslator<Policy>(in, out, context, "odr-line ");
   out << ">";
 
   out << "<line";
@@ -349,10 +484,14 @@ void DrawLineTranslator(const pugi::xml_node &in, std::ostream &out,
   out << " />";
 
   out << "</svg>";
+  frame.next = {};
+  return true;
 }
 
-void DrawRectTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
+template <typename Policy>
+bool DrawShapeEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   out << "<div style=\"";
 
   out << "position:absolute;";
@@ -366,54 +505,127 @@ void DrawRectTranslator(const pugi::xml_node &in, std::ostream &out,
     out << "top:" << y.as_string() << ";";
   out << "\"";
 
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator<Policy>(in, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
-  out << R"(<svg xmlns="http://www.w3.org/2000/svg" version="1.1" overflow="visible" preserveAspectRatio="none" style="z-index:-1;width:inherit;height:inherit;position:absolute;top:0;left:0;padding:inherit;"><rect x="0" y="0" width="100%" height="100%"></rect></svg>)";
+  return true;
+}
+
+// the shapes reference symbols from `Html::odfShapeSymbols`. svg 1.1 viewers
+// only resolve `xlink:href`, svg 2 prefers `href`; both are written
+bool DrawRectLeave(Frame &, std::ostream &out, Context &context) {
+  out << R"(<svg class="odr-shape">)"
+      << R"(<use href="#odr-rect" xlink:href="#odr-rect"/></svg>)";
   out << "</div>";
+  context.shapeSymbols = true;
+  return false;
 }
 
-void DrawCircleTranslator(const pugi::xml_node &in, std::ostream &out,
-                          Context &context) {
-  out << "<div style=\"";
+bool DrawCircleLeave(Frame &, std::ostream &out, Context &context) {
+  out << R"(<svg class="odr-shape">)"
+      << R"(<use href="#odr-circle" xlink:href="#odr-circle"/></svg>)";
+  out << "</div>";
+  context.shapeSymbols = true;
+  return false;
+}
 
-  out << "position:absolute;";
-  if (const auto width = in.attribute("svg:width"); width)
-    out << "width:" << width.as_string() << ";";
-  if (const auto height = in.attribute("svg:height"); height)
-    out << "height:" << height.as_string() << ";";
-  if (const auto x = in.attribute("svg:x"); x)
-    out << "left:" << x.as_string() << ";";
-  if (const auto y = in.attribute("svg:y"); y)
-    out << "top:" << y.as_string() << ";";
-  out << "\"";
+template <typename Policy>
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context);
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &context);
+
+bool ChildrenEnter(Frame &, std::ostream &, Context &) { return true; }
 
-  ElementAttributeTranslator(in, out, context);
+// stored by the last application which laid out the document; counts the
+// pages of text as they are translated
+bool SoftPageBreakEnter(Frame &, std::ostream &, Context &context) {
+  ++context.page;
+  return false;
+}
+
+// wrappers like `text:section` or `text:table-of-content` are translated
+// through their children only; an editable block needs an element of its own
+// to carry the bid
+template <typename Policy>
+bool BlockEnter(Frame &frame, std::ostream &out, Context &context) {
+  out << "<div";
+  BlockAttributeTranslator<Policy>(frame.node, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
-  out << R"(<svg xmlns="http://www.w3.org/2000/svg" version="1.1" overflow="visible" preserveAspectRatio="none" style="z-index:-1;width:inherit;height:inherit;position:absolute;top:0;left:0;padding:inherit;"><circle cx="50%" cy="50%" r="50%"></rect></svg>)";
+  return true;
+}
+
+bool BlockLeave(Frame &, std::ostream &out, Context &) {
   out << "</div>";
+  return false;
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context) {
-  for (auto &&n : in) {
-    if (n.type() == pugi::node_pcdata)
-      TextTranslator(n.text(), out, context);
-    else if (n.type() == pugi::node_element)
-      ElementTranslator(n, out, context);
-  }
+bool BlockWrapper(const pugi::xml_node &in, const Context &context) {
+  if ((context.currentBlock >= context.blocks.size()) ||
+      (context.blocks[context.currentBlock].node != in))
+    return false;
+  // declarations without any text stay without an element
+  return !in.find_node([](const pugi::xml_node &node) {
+              return node.type() == pugi::node_pcdata;
+            }).empty();
 }
 
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
+template <typename Policy> struct ElementTranslators {
+  static constexpr ElementTranslator paragraph{ParagraphEnter<Policy>,
+                                               ParagraphLeave};
+  static constexpr ElementTranslator space{SpaceEnter, NoLeave};
+  static constexpr ElementTranslator tab{TabEnter, NoLeave};
+  static constexpr ElementTranslator lineBreak{LineBreakEnter, NoLeave};
+  static constexpr ElementTranslator link{LinkEnter<Policy>, LinkLeave};
+  static constexpr ElementTranslator bookmark{BookmarkEnter<Policy>, NoLeave};
+  static constexpr ElementTranslator frame{FrameEnter<Policy>, FrameLeave};
+  static constexpr ElementTranslator image{ImageEnter<Policy>, ImageLeave};
+  static constexpr ElementTranslator table{TableEnter<Policy>, TableLeave};
+  static constexpr ElementTranslator tableColumn{TableColumnEnter<Policy>,
+                                                 NoLeave};
+  static constexpr ElementTranslator tableRow{TableRowEnter<Policy>,
+                                              TableRowLeave};
+  static constexpr ElementTranslator tableCell{TableCellEnter<Policy>,
+                                               TableCellLeave};
+  static constexpr ElementTranslator drawLine{DrawLineEnter<Policy>, NoLeave};
+  static constexpr ElementTranslator drawRect{DrawShapeEnter<Policy>,
+                                              DrawRectLeave};
+  static constexpr ElementTranslator drawCircle{DrawShapeEnter<Policy>,
+                                                DrawCircleLeave};
+  static constexpr ElementTranslator substitution{SubstitutionEnter<Policy>,
+                                                  SubstitutionLeave};
+  static constexpr ElementTranslator softPageBreak{SoftPageBreakEnter,
+                                                   NoLeave};
+  static constexpr ElementTranslator children{ChildrenEnter, NoLeave};
+  static constexpr ElementTranslator block{BlockEnter<Policy>, BlockLeave};
+};
+
+const char *substitution(const std::string_view element) {
+  static const std::unordered_map<std::string_view, const char *> substitution{
       {"text:span", "span"},
       {"text:list", "ul"},
       {"text:list-item", "li"},
       {"draw:page", "div"},
   };
-  static std::unordered_set<std::string> skippers{
+
+  const auto it = substitution.find(element);
+  if (it == substitution.end())
+    return nullptr;
+  return it->second;
+}
+
+template <typename Policy>
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context) {
+  out << "<" << substitution(frame.node.name());
+  ElementAttributeTranslator<Policy>(frame.node, out, context);
+  out << ">";
+  return true;
+}
+
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &) {
+  out << "</" << substitution(frame.node.name()) << ">";
+  return false;
+}
+
+bool skipped(const std::string_view element) {
+  static const std::unordered_set<std::string_view> skippers{
       "svg:desc",
       // odt
       "text:index-title-template",
@@ -425,56 +637,231 @@ void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
       "table:covered-table-cell",
   };
 
-  const std::string element = in.name();
-  if (skippers.find(element) != skippers.end())
-    return;
+  return skippers.find(element) != skippers.end();
+}
+
+template <typename Policy>
+const ElementTranslator *lookupElementTranslator(const pugi::xml_node &in) {
+  typedef ElementTranslators<Policy> Translators;
+  const std::string_view element = in.name();
+  if (skipped(element))
+    return nullptr;
 
   if (element == "text:p" || element == "text:h")
-    ParagraphTranslator(in, out, context);
+    return &Translators::paragraph;
   else if (element == "text:s")
-    SpaceTranslator(in, out, context);
+    return &Translators::space;
   else if (element == "text:tab")
-    TabTranslator(in, out, context);
+    return &Translators::tab;
   else if (element == "text:line-break")
-    LineBreakTranslator(in, out, context);
+    return &Translators::lineBreak;
+  else if (element == "text:soft-page-break")
+    return &Translators::softPageBreak;
   else if (element == "text:a")
-    LinkTranslator(in, out, context);
+    return &Translators::link;
   else if (element == "text:bookmark" || element == "text:bookmark-start")
-    BookmarkTranslator(in, out, context);
+    return &Translators::bookmark;
   else if (element == "draw:frame" || element == "draw:custom-shape")
-    FrameTranslator(in, out, context);
+    return &Translators::frame;
   else if (element == "draw:image")
-    ImageTranslator(in, out, context);
+    return &Translators::image;
   else if (element == "table:table")
-    TableTranslator(in, out, context);
+    return &Translators::table;
   else if (element == "table:table-column")
-    TableColumnTranslator(in, out, context);
+    return &Translators::tableColumn;
   else if (element == "table:table-row")
-    TableRowTranslator(in, out, context);
+    return &Translators::tableRow;
   else if (element == "table:table-cell")
-    TableCellTranslator(in, out, context);
+    return &Translators::tableCell;
   else if (element == "draw:line")
-    DrawLineTranslator(in, out, context);
+    return &Translators::drawLine;
   else if (element == "draw:rect")
-    DrawRectTranslator(in, out, context);
+    return &Translators::drawRect;
   else if (element == "draw:circle")
-    DrawCircleTranslator(in, out, context);
-  else {
-    const auto it = substitution.find(element);
-    if (it != substitution.end()) {
-      out << "<" << it->second;
-      ElementAttributeTranslator(in, out, context);
-      out << ">";
-    }
-    ElementChildrenTranslator(in, out, context);
-    if (it != substitution.end())
-      out << "</" << it->second << ">";
+    return &Translators::drawCircle;
+  else if (substitution(element) != nullptr)
+    return &Translators::substitution;
+  return &Translators::children;
+}
+
+template <typename Policy>
+bool NodeEnter(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.node.type() == pugi::node_pcdata) {
+    TextTranslator<Policy>(frame.node.text(), out, context);
+    frame.next = {};
+    return true;
+  }
+  if (frame.node.type() != pugi::node_element)
+    return false;
+
+  if (frame.state.translator == nullptr) {
+    frame.state.translator = lookupElementTranslator<Policy>(frame.node);
+    if (frame.state.translator == nullptr)
+      return false;
+    if (Policy::editable &&
+        (frame.state.translator == &ElementTranslators<Policy>::children) &&
+        BlockWrapper(frame.node, context))
+      frame.state.translator = &ElementTranslators<Policy>::block;
   }
+  return frame.state.translator->enter(frame, out, context);
+}
+
+bool NodeLeave(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.state.translator == nullptr)
+    return false;
+  return frame.state.translator->leave(frame, out, context);
+}
+
+struct IrState {
+  bool open{false};
+};
+
+typedef common::XmlTraversal::Frame<IrState> IrFrame;
+
+std::string IrStyle(const pugi::xml_node &in) {
+  for (auto &&name : {"text:style-name", "table:style-name", "draw:style-name",
+                      "presentation:style-name"}) {
+    if (const auto attribute = in.attribute(name); attribute)
+      return StyleTranslator::escapeStyleName(attribute.as_string());
+  }
+  return "";
+}
+
+std::uint32_t IrRepeat(const pugi::xml_node &in, const char *name) {
+  return std::max(1u, in.attribute(name).as_uint(1));
+}
+
+bool IrEnter(IrFrame &frame, common::IrDocument &out, Context &context) {
+  static const std::unordered_map<std::string_view, common::IrType> types{
+      {"text:p", common::IrType::PARAGRAPH},
+      {"text:h", common::IrType::PARAGRAPH},
+      {"text:span", common::IrType::SPAN},
+      {"text:a", common::IrType::LINK},
+      {"text:bookmark", common::IrType::BOOKMARK},
+      {"text:bookmark-start", common::IrType::BOOKMARK},
+      {"text:s", common::IrType::SPACE},
+      {"text:tab", common::IrType::TAB},
+      {"text:line-break", common::IrType::LINE_BREAK},
+      {"text:list", common::IrType::LIST},
+      {"text:list-item", common::IrType::LIST_ITEM},
+      {"draw:page", common::IrType::PAGE},
+      {"table:table", common::IrType::TABLE},
+      {"table:table-column", common::IrType::TABLE_COLUMN},
+      {"table:table-row", common::IrType::TABLE_ROW},
+      {"table:table-cell", common::IrType::TABLE_CELL},
+      {"draw:frame", common::IrType::FRAME},
+      {"draw:custom-shape", common::IrType::SHAPE},
+      {"draw:line", common::IrType::SHAPE},
+      {"draw:rect", common::IrType::SHAPE},
+      {"draw:circle", common::IrType::SHAPE},
+      {"draw:image", common::IrType::IMAGE},
+  };
+
+  const pugi::xml_node &in = frame.node;
+  if (in.type() == pugi::node_pcdata) {
+    out.appendText(in.value());
+    return false;
+  }
+  if (in.type() != pugi::node_element)
+    return false;
+
+  const std::string_view element = in.name();
+  if (skipped(element))
+    return false;
+  const auto it = types.find(element);
+  if (it == types.end())
+    return true;
+
+  common::IrType type = it->second;
+  if ((type == common::IrType::TABLE) &&
+      (context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET) &&
+      (std::strcmp(in.parent().name(), "office:spreadsheet") == 0))
+    type = common::IrType::SHEET;
+
+  const std::uint32_t index = out.open(type, IrStyle(in));
+  frame.state.open = true;
+
+  switch (type) {
+  case common::IrType::LINK:
+    out.setText(index, in.attribute("xlink:href").as_string());
+    break;
+  case common::IrType::BOOKMARK:
+    out.setText(index, in.attribute("text:name").as_string());
+    frame.next = {};
+    break;
+  case common::IrType::SPACE:
+    out.setRepeat(index, std::min(IrRepeat(in, "text:c"), maxSpaces));
+    frame.next = {};
+    break;
+  case common::IrType::TAB:
+  case common::IrType::LINE_BREAK:
+    frame.next = {};
+    break;
+  case common::IrType::PAGE:
+    out.setText(index, in.attribute("draw:name").as_string());
+    break;
+  case common::IrType::SHEET:
+  case common::IrType::TABLE:
+    out.setText(index, in.attribute("table:name").as_string());
+    break;
+  case common::IrType::TABLE_COLUMN:
+    out.setRepeat(index, IrRepeat(in, "table:number-columns-repeated"));
+    frame.next = {};
+    break;
+  case common::IrType::TABLE_ROW:
+    out.setRepeat(index, IrRepeat(in, "table:number-rows-repeated"));
+    break;
+  case common::IrType::TABLE_CELL:
+    out.setRepeat(index, IrRepeat(in, "table:number-columns-repeated"));
+    out.setSpan(index, IrRepeat(in, "table:number-columns-spanned"),
+                IrRepeat(in, "table:number-rows-spanned"));
+    break;
+  case common::IrType::IMAGE:
+    out.setText(index, in.attribute("xlink:href").as_string());
+    frame.next = {};
+    break;
+  default:
+    break;
+  }
+  return true;
+}
+
+bool IrLeave(IrFrame &frame, common::IrDocument &out) {
+  if (frame.state.open)
+    out.close();
+  return false;
+}
+
+template <typename Policy>
+void translate(const pugi::xml_node &in, std::ostream &out, Context &context) {
+  common::XmlTraversal::traverse<ElementState>(
+      in, [&](Frame &frame) { return NodeEnter<Policy>(frame, out, context); },
+      [&](Frame &frame) { return NodeLeave(frame, out, context); });
 }
 } // namespace
 
 void ContentTranslator::html(const pugi::xml_node &in, Context &context) {
-  ElementTranslator(in, *context.output, context);
+  std::ostream &out = *context.output;
+  const bool spreadsheet =
+      context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET;
+  if (context.config->editable) {
+    if (spreadsheet)
+      translate<TranslationPolicy<true, true>>(in, out, context);
+    else
+      translate<TranslationPolicy<true, false>>(in, out, context);
+  } else {
+    if (spreadsheet)
+      translate<TranslationPolicy<false, true>>(in, out, context);
+    else
+      translate<TranslationPolicy<false, false>>(in, out, context);
+  }
+}
+
+void ContentTranslator::ir(const pugi::xml_node &in, Context &context,
+                           common::IrDocument &out) {
+  common::XmlTraversal::traverse<IrState>(
+      in, [&](IrFrame &frame) { return IrEnter(frame, out, context); },
+      [&](IrFrame &frame) { return IrLeave(frame, out); });
 }
 
 } // namespace odf
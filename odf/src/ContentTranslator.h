@@ -8,12 +8,18 @@ class xml_node;
 }
 
 namespace odr {
+namespace common {
+class IrDocument;
+}
+
 namespace odf {
 
 struct Context;
 
 namespace ContentTranslator {
 void html(const pugi::xml_node &in, Context &context);
+// lowers the whole content into the intermediate representation
+void ir(const pugi::xml_node &in, Context &context, common::IrDocument &out);
 } // namespace ContentTranslator
 
 } // namespace odf
@@ -1,17 +1,18 @@
 #ifndef ODR_ODF_CONTEXT_H
 #define ODR_ODF_CONTEXT_H
 
+#include <access/Diagnostics.h>
 #include <common/TableCursor.h>
 #include <common/TableRange.h>
 #include <iostream>
 #include <list>
 #include <memory>
+#include <pugixml.hpp>
+#include <set>
 #include <string>
 #include <unordered_map>
-
-namespace pugi {
-class xml_text;
-}
+#include <unordered_set>
+#include <vector>
 
 namespace odr {
 struct Config;
@@ -25,6 +26,15 @@ class ReadStorage;
 namespace odr {
 namespace odf {
 
+// top-level content element which can be translated again on its own
+struct Block {
+  pugi::xml_node node;
+  std::uint32_t entry{0};
+  // text translation indices inside the block
+  std::uint32_t textBegin{0};
+  std::uint32_t textEnd{0};
+};
+
 struct Context {
   const Config *config;
   const FileMeta *meta;
@@ -34,15 +44,32 @@ struct Context {
   std::ostream *output;
 
   std::unordered_map<std::string, std::list<std::string>> styleDependencies;
+  // style names used by the translated content; collected only if set
+  std::unordered_set<std::string> *referencedStyles{nullptr};
+  // short class names by style name in compact mode
+  std::unordered_map<std::string, std::string> classNames;
 
   std::uint32_t entry{0};
   common::TableRange tableRange;
   common::TableCursor tableCursor;
   std::unordered_map<std::uint32_t, std::string> defaultCellStyles;
+  // first page of each top-level text element; built per translation which
+  // selects pages (odt)
+  std::vector<std::uint32_t> pages;
+  // page of text reached so far, counted by the soft page breaks (odt)
+  std::uint32_t page{0};
+  // whether the shared shape symbols are referenced
+  bool shapeSymbols{false};
+  // problems of the last translation
+  access::Diagnostics diagnostics;
 
   // editing
   std::uint32_t currentTextTranslationIndex{0};
-  std::unordered_map<std::uint32_t, const pugi::xml_text *> textTranslation;
+  // indexed by text translation index
+  std::vector<pugi::xml_text> textTranslation;
+  std::vector<Block> blocks;
+  std::uint32_t currentBlock{0};
+  std::set<std::uint32_t> modifiedBlocks;
 };
 
 } // namespace odf
@@ -2,6 +2,7 @@
 #include <access/Storage.h>
 #include <access/StorageUtil.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
 #include <crypto/CryptoUtil.h>
 #include <sstream>
 
@@ -90,19 +91,19 @@ public:
       : parent(std::move(parent)), manifest(std::move(manifest)),
         startKey(std::move(startKey)) {}
 
-  bool isSomething(const access::Path &p) const final {
+  bool isSomething(const access::PathView p) const final {
     return parent->isSomething(p);
   }
-  bool isFile(const access::Path &p) const final {
+  bool isFile(const access::PathView p) const final {
     return parent->isSomething(p);
   }
-  bool isDirectory(const access::Path &p) const final {
+  bool isDirectory(const access::PathView p) const final {
     return parent->isSomething(p);
   }
-  bool isReadable(const access::Path &p) const final { return isFile(p); }
+  bool isReadable(const access::PathView p) const final { return isFile(p); }
 
-  std::uint64_t size(const access::Path &p) const final {
-    const auto it = manifest.entries.find(p);
+  std::uint64_t size(const access::PathView p) const final {
+    const auto it = manifest.entries.find(access::Path(p));
     if (it == manifest.entries.end())
       return parent->size(p);
     return it->second.size;
@@ -110,8 +111,8 @@ public:
 
   void visit(Visitor v) const final { parent->visit(v); }
 
-  std::unique_ptr<std::istream> read(const access::Path &path) const final {
-    const auto it = manifest.entries.find(path);
+  std::unique_ptr<std::istream> read(const access::PathView path) const final {
+    const auto it = manifest.entries.find(access::Path(path));
     if (it == manifest.entries.end())
       return parent->read(path);
     if (!Crypto::canDecrypt(it->second))
@@ -131,6 +132,7 @@ bool Crypto::decrypt(std::unique_ptr<access::ReadStorage> &storage,
                      const std::string &password) {
   if (!manifest.encrypted)
     return true;
+  const access::Trace::Span span("decrypt");
   if (!canDecrypt(*manifest.smallestFileEntry))
     throw UnsupportedCryptoAlgorithmException();
   const std::string startKey =
@@ -8,15 +8,16 @@
 #include <cstring>
 #include <odr/Meta.h>
 #include <pugixml.hpp>
+#include <string_view>
 #include <unordered_map>
 
 namespace odr {
 namespace odf {
 
 namespace {
-bool lookupFileType(const std::string &mimeType, FileType &fileType) {
+bool lookupFileType(const std::string_view mimeType, FileType &fileType) {
   // https://www.openoffice.org/framework/documentation/mimetypes/mimetypes.html
-  static const std::unordered_map<std::string, FileType> MIME_TYPES = {
+  static const std::unordered_map<std::string_view, FileType> MIME_TYPES = {
       {"application/vnd.oasis.opendocument.text", FileType::OPENDOCUMENT_TEXT},
       {"application/vnd.oasis.opendocument.presentation",
        FileType::OPENDOCUMENT_PRESENTATION},
@@ -51,9 +52,9 @@ bool lookupFileType(const std::string &mimeType, FileType &fileType) {
                                            FileType::UNKNOWN);
 }
 
-bool lookupChecksumType(const std::string &checksum,
+bool lookupChecksumType(const std::string_view checksum,
                         Meta::ChecksumType &checksumType) {
-  static const std::unordered_map<std::string, Meta::ChecksumType>
+  static const std::unordered_map<std::string_view, Meta::ChecksumType>
       CHECKSUM_TYPES = {
           {"SHA1", Meta::ChecksumType::SHA1},
           {"SHA1/1K", Meta::ChecksumType::SHA1_1K},
@@ -64,9 +65,9 @@ bool lookupChecksumType(const std::string &checksum,
       CHECKSUM_TYPES, checksum, checksumType, Meta::ChecksumType::UNKNOWN);
 }
 
-bool lookupAlgorithmTypes(const std::string &algorithm,
+bool lookupAlgorithmTypes(const std::string_view algorithm,
                           Meta::AlgorithmType &algorithmType) {
-  static const std::unordered_map<std::string, Meta::AlgorithmType>
+  static const std::unordered_map<std::string_view, Meta::AlgorithmType>
       ALGORITHM_TYPES = {
           {"http://www.w3.org/2001/04/xmlenc#aes256-cbc",
            Meta::AlgorithmType::AES256_CBC},
@@ -77,9 +78,9 @@ bool lookupAlgorithmTypes(const std::string &algorithm,
       ALGORITHM_TYPES, algorithm, algorithmType, Meta::AlgorithmType::UNKNOWN);
 }
 
-bool lookupKeyDerivationTypes(const std::string &keyDerivation,
+bool lookupKeyDerivationTypes(const std::string_view keyDerivation,
                               Meta::KeyDerivationType &keyDerivationType) {
-  static const std::unordered_map<std::string, Meta::KeyDerivationType>
+  static const std::unordered_map<std::string_view, Meta::KeyDerivationType>
       KEY_DERIVATION_TYPES = {
           {"PBKDF2", Meta::KeyDerivationType::PBKDF2},
       };
@@ -88,9 +89,9 @@ bool lookupKeyDerivationTypes(const std::string &keyDerivation,
                                            Meta::KeyDerivationType::UNKNOWN);
 }
 
-bool lookupStartKeyTypes(const std::string &checksum,
+bool lookupStartKeyTypes(const std::string_view checksum,
                          Meta::ChecksumType &checksumType) {
-  static const std::unordered_map<std::string, Meta::ChecksumType>
+  static const std::unordered_map<std::string_view, Meta::ChecksumType>
       STARTKEY_TYPES = {
           {"SHA1", Meta::ChecksumType::SHA1},
           {"http://www.w3.org/2000/09/xmldsig#sha256",
@@ -141,6 +142,7 @@ FileMeta Meta::parseFileMeta(const access::ReadStorage &storage,
                              const bool decrypted) {
   FileMeta result;
   result.confident = true;
+  result.encrypted = decrypted;
 
   if (!storage.isFile("content.xml"))
     throw NoOpenDocumentFileException();
@@ -150,14 +152,26 @@ FileMeta Meta::parseFileMeta(const access::ReadStorage &storage,
     lookupFileType(mimeType, result.type);
   }
 
-  if (storage.isFile("META-INF/manifest.xml")) {
+  // content which parses cannot be encrypted. the manifest, usually the last
+  // member, is then only needed if the mimetype is missing, so a streamed
+  // document opens before it has fully arrived
+  pugi::xml_document contentXml;
+  try {
+    contentXml = common::XmlUtil::parse(storage, "content.xml");
+  } catch (const common::NotXmlException &) {
+  }
+  const auto body =
+      contentXml.child("office:document-content").child("office:body");
+
+  if ((!body || (result.type == FileType::UNKNOWN)) &&
+      storage.isFile("META-INF/manifest.xml")) {
     const auto manifest =
         common::XmlUtil::parse(storage, "META-INF/manifest.xml");
     for (auto &&e : manifest.select_nodes("//manifest:file-entry")) {
       const access::Path path =
           e.node().attribute("manifest:full-path").as_string();
       if (path.root() && e.node().attribute("manifest:media-type")) {
-        const std::string mimeType =
+        const std::string_view mimeType =
             e.node().attribute("manifest:media-type").as_string();
         lookupFileType(mimeType, result.type);
       }
@@ -167,71 +181,52 @@ FileMeta Meta::parseFileMeta(const access::ReadStorage &storage,
     }
   }
 
-  if (result.encrypted == decrypted) {
-    if (storage.isFile("meta.xml")) {
-      const auto metaXml = common::XmlUtil::parse(storage, "meta.xml");
-
-      const pugi::xml_node statistics = metaXml.child("office:document-meta")
-                                            .child("office:meta")
-                                            .child("meta:document-statistic");
-      if (statistics) {
-        switch (result.type) {
-        case FileType::OPENDOCUMENT_TEXT: {
-          const auto pageCount = statistics.attribute("meta:page-count");
-          if (!pageCount)
-            break;
-          result.entryCount = pageCount.as_uint();
-        } break;
-        case FileType::OPENDOCUMENT_PRESENTATION: {
-          result.entryCount = 0;
-        } break;
-        case FileType::OPENDOCUMENT_SPREADSHEET: {
-          const auto tableCount = statistics.attribute("meta:table-count");
-          if (!tableCount)
-            break;
-          result.entryCount = tableCount.as_uint();
-        } break;
-        case FileType::OPENDOCUMENT_GRAPHICS: {
-        } break;
-        default:
-          break;
-        }
-      }
-    }
-
-    // TODO dont load content twice (happens in case of translation)
-    const auto contentXml = common::XmlUtil::parse(storage, "content.xml");
-    const auto body =
-        contentXml.child("office:document-content").child("office:body");
-    if (!body)
-      throw NoOpenDocumentFileException();
+  if (!body) {
+    // nothing but the type is known until the document is decrypted
+    if (result.encrypted && !decrypted)
+      return result;
+    throw NoOpenDocumentFileException();
+  }
 
-    switch (result.type) {
-    case FileType::OPENDOCUMENT_GRAPHICS:
-    case FileType::OPENDOCUMENT_PRESENTATION: {
-      result.entryCount = 0;
-      for (auto &&e : body.select_nodes("//draw:page")) {
-        ++result.entryCount;
-        FileMeta::Entry entry;
-        entry.name = e.node().attribute("draw:name").as_string();
-        result.entries.emplace_back(entry);
-      }
-    } break;
-    case FileType::OPENDOCUMENT_SPREADSHEET: {
-      result.entryCount = 0;
-      for (auto &&e : body.select_nodes("//table:table")) {
-        ++result.entryCount;
-        FileMeta::Entry entry;
-        entry.name = e.node().attribute("table:name").as_string();
-        // TODO configuration
-        estimateTableDimensions(e.node(), entry.rowCount, entry.columnCount,
-                                10000, 500);
-        result.entries.emplace_back(entry);
-      }
-    } break;
-    default:
+  // TODO dont load content twice (happens in case of translation)
+  switch (result.type) {
+  case FileType::OPENDOCUMENT_TEXT: {
+    // only the application which saved the document knows the page count.
+    // other types count their entries in the content below
+    if (!storage.isFile("meta.xml"))
       break;
+    const auto metaXml = common::XmlUtil::parse(storage, "meta.xml");
+    const auto pageCount = metaXml.child("office:document-meta")
+                               .child("office:meta")
+                               .child("meta:document-statistic")
+                               .attribute("meta:page-count");
+    if (pageCount)
+      result.entryCount = pageCount.as_uint();
+  } break;
+  case FileType::OPENDOCUMENT_GRAPHICS:
+  case FileType::OPENDOCUMENT_PRESENTATION: {
+    result.entryCount = 0;
+    for (auto &&e : body.select_nodes("//draw:page")) {
+      ++result.entryCount;
+      FileMeta::Entry entry;
+      entry.name = e.node().attribute("draw:name").as_string();
+      result.entries.emplace_back(entry);
+    }
+  } break;
+  case FileType::OPENDOCUMENT_SPREADSHEET: {
+    result.entryCount = 0;
+    for (auto &&e : body.select_nodes("//table:table")) {
+      ++result.entryCount;
+      FileMeta::Entry entry;
+      entry.name = e.node().attribute("table:name").as_string();
+      // TODO configuration
+      estimateTableDimensions(e.node(), entry.rowCount, entry.columnCount,
+                              10000, 500);
+      result.entries.emplace_back(entry);
     }
+  } break;
+  default:
+    break;
   }
 
   return result;
@@ -259,7 +254,7 @@ Meta::Manifest Meta::parseManifest(const pugi::xml_document &manifest) {
     entry.size = e.attribute("manifest:size").as_uint();
 
     { // checksum
-      const std::string checksumType =
+      const std::string_view checksumType =
           crypto.attribute("manifest:checksum-type").as_string();
       lookupChecksumType(checksumType, entry.checksumType);
       entry.checksum = crypto.attribute("manifest:checksum").as_string();
@@ -267,7 +262,7 @@ Meta::Manifest Meta::parseManifest(const pugi::xml_document &manifest) {
 
     { // encryption algorithm
       const pugi::xml_node algorithm = crypto.child("manifest:algorithm");
-      const std::string algorithmName =
+      const std::string_view algorithmName =
           algorithm.attribute("manifest:algorithm-name").as_string();
       lookupAlgorithmTypes(algorithmName, entry.algorithm);
       entry.initialisationVector =
@@ -276,7 +271,7 @@ Meta::Manifest Meta::parseManifest(const pugi::xml_document &manifest) {
 
     { // key derivation
       const pugi::xml_node key = crypto.child("manifest:key-derivation");
-      const std::string keyDerivationName =
+      const std::string_view keyDerivationName =
           key.attribute("manifest:key-derivation-name").as_string();
       lookupKeyDerivationTypes(keyDerivationName, entry.keyDerivation);
       entry.keySize = key.attribute("manifest:key-size").as_uint(16);
@@ -289,7 +284,7 @@ Meta::Manifest Meta::parseManifest(const pugi::xml_document &manifest) {
       const pugi::xml_node start =
           crypto.child("manifest:start-key-generation");
       if (start) {
-        const std::string startKeyGenerationName =
+        const std::string_view startKeyGenerationName =
             start.attribute("manifest:start-key-generation-name").as_string();
         lookupStartKeyTypes(startKeyGenerationName, entry.startKeyGeneration);
         entry.startKeySize = start.attribute("manifest:key-size").as_uint();
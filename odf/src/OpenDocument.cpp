@@ -3,75 +3,198 @@
 #include <Crypto.h>
 #include <Meta.h>
 #include <StyleTranslator.h>
+#include <access/AsyncStream.h>
+#include <access/CachingStorage.h>
+#include <access/GzipStream.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
 #include <access/ZipStorage.h>
+#include <algorithm>
+#include <common/Cost.h>
+#include <common/Fingerprint.h>
 #include <common/Html.h>
+#include <common/IrCache.h>
+#include <common/IrDocument.h>
+#include <common/IrRenderer.h>
+#include <common/XmlTraversal.h>
 #include <common/XmlUtil.h>
+#include <cstring>
 #include <fstream>
+#include <future>
 #include <nlohmann/json.hpp>
 #include <odf/OpenDocument.h>
 #include <odr/Config.h>
 #include <odr/Meta.h>
+#include <optional>
 #include <pugixml.hpp>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 namespace odr {
 namespace odf {
 
 namespace {
-void generateStyle_(std::ofstream &out, Context &context) {
-  out << common::Html::odfDefaultStyle();
+std::string read_(const access::ReadStorage &storage,
+                  const access::Path &path) {
+  const auto in = storage.read(path);
+  if (!in)
+    throw access::FileNotFoundException(path.string());
+  return access::StreamUtil::read(*in);
+}
 
+void generateDefaultStyle_(std::ostream &out, Context &context) {
+  std::string style = common::Html::odfDefaultStyle();
   if (context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET)
-    out << common::Html::odfSpreadsheetDefaultStyle();
+    style += common::Html::odfSpreadsheetDefaultStyle();
 
-  const auto stylesXml = common::XmlUtil::parse(*context.storage, "styles.xml");
+  if (context.config->compact) {
+    style += common::Html::odfCompactStyle();
+    out << common::Html::minifyCss(style);
+  } else {
+    out << style;
+  }
+}
 
-  const auto fontFaceDecls =
-      stylesXml.child("office:document-styles").child("office:font-face-decls");
-  if (fontFaceDecls)
-    StyleTranslator::css(fontFaceDecls, context);
+// style containers in the order their css is written; those of styles.xml
+// come first and can be translated before content.xml is parsed
+std::vector<pugi::xml_node> styleRoots_(const pugi::xml_node &styles) {
+  const auto documentStyles = styles.child("office:document-styles");
+  return {
+      documentStyles.child("office:font-face-decls"),
+      documentStyles.child("office:styles"),
+      documentStyles.child("office:automatic-styles"),
+      documentStyles.child("office:master-styles"),
+  };
+}
 
-  const auto styles =
-      stylesXml.child("office:document-styles").child("office:styles");
-  if (styles)
-    StyleTranslator::css(styles, context);
+std::vector<pugi::xml_node> contentStyleRoots_(const pugi::xml_node &content) {
+  const auto documentContent = content.child("office:document-content");
+  return {
+      documentContent.child("office:font-face-decls"),
+      documentContent.child("office:automatic-styles"),
+  };
+}
 
-  const auto automaticStyles = stylesXml.child("office:document-styles")
-                                   .child("office:automatic-styles");
-  if (automaticStyles)
-    StyleTranslator::css(automaticStyles, context);
+void generateStyle_(const std::vector<pugi::xml_node> &roots,
+                    Context &context) {
+  const access::Trace::Span span("style");
+  for (auto &&root : roots) {
+    if (root)
+      StyleTranslator::css(root, context);
+  }
+}
 
-  const auto masterStyles =
-      stylesXml.child("office:document-styles").child("office:master-styles");
-  if (masterStyles)
-    StyleTranslator::css(masterStyles, context);
+void generateStyleDependencies_(const std::vector<pugi::xml_node> &roots,
+                                Context &context) {
+  const access::Trace::Span span("style dependencies");
+  for (auto &&root : roots) {
+    if (root)
+      StyleTranslator::dependencies(root, context);
+  }
 }
 
-void generateContentStyle_(const pugi::xml_node &in, Context &context) {
-  const auto fontFaceDecls =
-      in.child("office:document-content").child("office:font-face-decls");
-  if (fontFaceDecls)
-    StyleTranslator::css(fontFaceDecls, context);
+// writes css for the referenced styles and everything they depend on
+void generateReferencedStyle_(const std::vector<pugi::xml_node> &roots,
+                              const std::unordered_set<std::string> &referenced,
+                              Context &context) {
+  const access::Trace::Span span("style");
+  std::unordered_set<std::string> names;
+  std::vector<std::string> pending(referenced.begin(), referenced.end());
+  while (!pending.empty()) {
+    std::string name = std::move(pending.back());
+    pending.pop_back();
+    if (!names.insert(name).second)
+      continue;
+    const auto it = context.styleDependencies.find(name);
+    if (it == context.styleDependencies.end())
+      continue;
+    pending.insert(pending.end(), it->second.begin(), it->second.end());
+  }
 
-  const auto automaticStyles =
-      in.child("office:document-content").child("office:automatic-styles");
-  if (automaticStyles)
-    StyleTranslator::css(automaticStyles, context);
+  for (auto &&root : roots) {
+    if (root)
+      StyleTranslator::css(root, names, context);
+  }
 }
 
-void generateScript_(std::ofstream &out, Context &) {
+void generateScript_(std::ostream &out, Context &context) {
+  if (context.config->editable) {
+    // first text translation index of each block
+    out << "window.odr={textMap:[";
+    for (auto &&block : context.blocks) {
+      if (&block != &context.blocks.front())
+        out << ",";
+      out << block.textBegin;
+    }
+    out << "]};";
+  }
   out << common::Html::defaultScript();
 }
 
+void generateBlock_(const pugi::xml_node &in, Context &context) {
+  context.currentBlock = context.blocks.size();
+  Block &block = context.blocks.emplace_back();
+  block.node = in;
+  block.entry = context.entry;
+  block.textBegin = context.currentTextTranslationIndex;
+
+  ContentTranslator::html(in, context);
+
+  context.blocks[context.currentBlock].textEnd =
+      context.currentTextTranslationIndex;
+}
+
+// first page of each top-level text element followed by the page after the
+// last element. a `text:soft-page-break` inside an element moves the following
+// elements to the next page, so elements can span several pages.
+void generatePageIndex_(const pugi::xml_node &in, Context &context) {
+  std::uint32_t page = 0;
+  for (auto &&e : in) {
+    context.pages.push_back(page);
+    common::XmlTraversal::traverse<bool>(
+        e,
+        [&](auto &frame) {
+          if (std::strcmp(frame.node.name(), "text:soft-page-break") == 0)
+            ++page;
+          return true;
+        },
+        [](auto &) { return false; });
+  }
+  context.pages.push_back(page);
+}
+
+bool pageSelected_(const std::uint32_t first, const std::uint32_t last,
+                   const Config &config) {
+  return (last >= config.entryOffset) &&
+         ((config.entryCount == 0) ||
+          (first < config.entryOffset + config.entryCount));
+}
+
+bool entrySelected_(const std::uint32_t entry, const Config &config) {
+  return pageSelected_(entry, entry, config);
+}
+
 void generateContent_(const pugi::xml_node &in, Context &context) {
   const pugi::xml_node body =
       in.child("office:document-content").child("office:body");
 
+  // entries are the pages of text, the slides, the drawing pages and the
+  // sheets; only drawing pages cannot be selected
   pugi::xml_node content;
   std::string entryName;
+  bool paged = false;
+  bool selectable = true;
   switch (context.meta->type) {
   case FileType::OPENDOCUMENT_TEXT:
+    content = body.child("office:text");
+    paged = true;
+    break;
   case FileType::OPENDOCUMENT_GRAPHICS:
+    content = body.child("office:drawing");
+    entryName = "draw:page";
+    selectable = false;
     break;
   case FileType::OPENDOCUMENT_PRESENTATION:
     content = body.child("office:presentation");
@@ -86,24 +209,68 @@ void generateContent_(const pugi::xml_node &in, Context &context) {
   }
 
   context.entry = 0;
-
-  if (content &&
-      ((context.config->entryOffset > 0) || (context.config->entryCount > 0))) {
-    std::uint32_t i = 0;
-    for (auto &&e : content) {
-      if (e.name() != entryName)
-        continue;
-      if ((i >= context.config->entryOffset) &&
-          ((context.config->entryCount == 0) ||
-           (i < context.config->entryOffset + context.config->entryCount))) {
-        ContentTranslator::html(e, context);
-      } else {
-        ++context.entry; // TODO hacky
+  context.currentTextTranslationIndex = 0;
+  context.textTranslation.clear();
+  context.blocks.clear();
+  context.modifiedBlocks.clear();
+  context.shapeSymbols = false;
+  context.pages.clear();
+  context.page = 0;
+
+  const bool selection =
+      selectable &&
+      ((context.config->entryOffset > 0) || (context.config->entryCount > 0));
+  const bool byName =
+      (context.meta->type == FileType::OPENDOCUMENT_SPREADSHEET) &&
+      !context.config->sheetName.empty();
+  const bool filter = !entryName.empty() && (selection || byName);
+  const bool filterPages = paged && selection;
+  if (filterPages)
+    generatePageIndex_(content, context);
+
+  const access::Trace::Span span("content", "content.xml");
+  // kept open while consecutive elements belong to the same entry
+  std::optional<access::Trace::Span> entrySpan;
+  std::uint32_t spanEntry = 0;
+  const auto enterEntry = [&](const std::uint32_t entry) {
+    if (entrySpan && (spanEntry == entry))
+      return;
+    entrySpan.reset();
+    entrySpan.emplace("entry", "content.xml", entry);
+    spanEntry = entry;
+  };
+
+  // top-level element of text
+  std::uint32_t element = 0;
+  // entry element of the other types
+  std::uint32_t entry = 0;
+  for (auto &&e : content) {
+    if (paged) {
+      // without a selection the page is counted while translating; the
+      // elements skipped by one do not count, so their index is used instead
+      std::uint32_t first = context.page;
+      if (filterPages) {
+        first = context.pages[element];
+        const std::uint32_t last = context.pages[element + 1];
+        ++element;
+        if (!pageSelected_(first, last, *context.config))
+          continue;
       }
-      ++i;
+      enterEntry(first);
+    } else if (!entryName.empty() && (e.name() == entryName)) {
+      const std::uint32_t index = entry++;
+      if (byName ? (context.config->sheetName !=
+                    e.attribute("table:name").as_string())
+                 : (filter && !entrySelected_(index, *context.config)))
+        continue;
+      context.entry = index;
+      enterEntry(index);
+    } else {
+      if (filter)
+        continue;
+      entrySpan.reset();
     }
-  } else {
-    ContentTranslator::html(body, context);
+    generateBlock_(e, context);
   }
 }
 } // namespace
@@ -119,18 +286,19 @@ public:
             std::unique_ptr<access::ReadStorage>(new access::ZipReader(path))) {
   }
 
-  explicit Impl(std::unique_ptr<access::ReadStorage> &&storage) {
-    meta_ = Meta::parseFileMeta(*storage, false);
-    manifest_ = Meta::parseManifest(*storage);
-
-    storage_ = std::move(storage);
-  }
-
-  explicit Impl(std::unique_ptr<access::ReadStorage> &storage) {
-    meta_ = Meta::parseFileMeta(*storage, false);
-    manifest_ = Meta::parseManifest(*storage);
-
-    storage_ = std::move(storage);
+  explicit Impl(std::unique_ptr<access::ReadStorage> &&storage)
+      : Impl(storage) {}
+
+  // the meta is read through the cache, so translation does not read it
+  // again. on failure the storage is handed back for the next probe
+  explicit Impl(std::unique_ptr<access::ReadStorage> &storage)
+      : storage_(std::make_unique<access::CachingStorage>(std::move(storage))) {
+    try {
+      meta_ = Meta::parseFileMeta(*storage_, false);
+    } catch (...) {
+      storage = storage_->release();
+      throw;
+    }
   }
 
   FileType type() const noexcept { return meta_.type; }
@@ -143,6 +311,10 @@ public:
 
   bool decrypted() const noexcept { return decrypted_; }
 
+  std::vector<Diagnostic> diagnostics() const {
+    return context_.diagnostics.summary();
+  }
+
   bool translatable() const noexcept { return true; }
 
   bool editable() const noexcept { return true; }
@@ -156,7 +328,18 @@ public:
   bool decrypt(const std::string &password) {
     // TODO throw if not encrypted
     // TODO throw if decrypted
-    const bool success = Crypto::decrypt(storage_, manifest_, password);
+    // only encrypted documents need the manifest, which usually comes last
+    const Meta::Manifest manifest = Meta::parseManifest(*storage_);
+    // decrypted members are cached from now on instead of the encrypted ones
+    std::unique_ptr<access::ReadStorage> storage = storage_->release();
+    bool success;
+    try {
+      success = Crypto::decrypt(storage, manifest, password);
+    } catch (...) {
+      storage_ = std::make_unique<access::CachingStorage>(std::move(storage));
+      throw;
+    }
+    storage_ = std::make_unique<access::CachingStorage>(std::move(storage));
     if (success)
       meta_ = Meta::parseFileMeta(*storage_, true);
     decrypted_ = success;
@@ -165,27 +348,97 @@ public:
 
   bool translate(const access::Path &path, const Config &config) {
     // TODO throw if not decrypted
-    std::ofstream out(path);
-    if (!out.is_open())
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
       return false;
+    // finished explicitly, so that write failures are reported
+    std::optional<access::GzipOstream> gzip;
+    if (config.gzip)
+      gzip.emplace(file, config.gzipLevel);
+    std::ostream &sink = gzip ? static_cast<std::ostream &>(*gzip) : file;
+    // compression and writing run on their own thread; finished first
+    std::optional<access::AsyncOstream> async;
+    if (config.pipeline)
+      async.emplace(sink);
+    std::ostream &out = async ? static_cast<std::ostream &>(*async) : sink;
+    // the writer first, then the deflate stream, then the file; a failure of
+    // any of them leaves the output truncated
+    const auto finish = [&] {
+      if (async)
+        async->finish();
+      if (gzip)
+        gzip->finish();
+      file.close();
+      return !(async && async->fail()) && !(gzip && gzip->fail()) &&
+             !file.fail();
+    };
+    config_ = config;
     context_.config = &config;
     context_.meta = &meta_;
     context_.storage = storage_.get();
     context_.output = &out;
+    context_.diagnostics.clear();
+
+    if (config.format != TranslationFormat::HTML) {
+      translateIr_(out, config);
+      context_.config = nullptr;
+      context_.output = nullptr;
+      return finish();
+    }
 
-    content_ = common::XmlUtil::parse(*storage_, "content.xml");
+    // the storage is used by one thread at a time: with a pipeline the styles
+    // are inflated first, then the content is inflated and parsed while the
+    // styles are parsed and their css is written
+    std::future<pugi::xml_document> content;
+    if (config.pipeline) {
+      const std::string styles = read_(*storage_, "styles.xml");
+      content = std::async(std::launch::async, [this] {
+        return common::XmlUtil::parse(read_(*storage_, "content.xml"));
+      });
+      style_ = common::XmlUtil::parse(styles);
+    } else {
+      style_ = common::XmlUtil::parse(*storage_, "styles.xml");
+      content_ = common::XmlUtil::parse(*storage_, "content.xml");
+    }
+    auto styleRoots = styleRoots_(style_);
+    context_.styleDependencies.clear();
+    context_.classNames.clear();
+    std::unordered_set<std::string> referencedStyles;
 
     out << common::Html::doctype();
     out << "<html><head>";
     out << common::Html::defaultHeaders();
     out << "<style>";
-    generateStyle_(out, context_);
-    generateContentStyle_(content_, context_);
+    generateDefaultStyle_(out, context_);
+    // the css follows the content once the referenced styles are known
+    if (config.pruneStyles)
+      generateStyleDependencies_(styleRoots, context_);
+    else
+      generateStyle_(styleRoots, context_);
+    if (content.valid())
+      content_ = content.get();
+    const auto contentRoots = contentStyleRoots_(content_);
+    if (config.pruneStyles) {
+      generateStyleDependencies_(contentRoots, context_);
+      context_.referencedStyles = &referencedStyles;
+    } else {
+      generateStyle_(contentRoots, context_);
+    }
+    styleRoots.insert(styleRoots.end(), contentRoots.begin(),
+                      contentRoots.end());
     out << "</style>";
     out << "</head>";
 
     out << "<body " << common::Html::bodyAttributes(config) << ">";
     generateContent_(content_, context_);
+    if (context_.shapeSymbols)
+      out << common::Html::odfShapeSymbols();
+    if (config.pruneStyles) {
+      context_.referencedStyles = nullptr;
+      out << "<style>";
+      generateReferencedStyle_(styleRoots, referencedStyles, context_);
+      out << "</style>";
+    }
     out << "</body>";
 
     out << "<script>";
@@ -195,28 +448,56 @@ public:
 
     context_.config = nullptr;
     context_.output = nullptr;
-    out.close();
-    return true;
+    return finish();
   }
 
   bool edit(const std::string &diff) {
     // TODO throw if not decrypted
     const auto json = nlohmann::json::parse(diff);
+    ir_.clear();
+    edited_ = true;
 
     if (json.contains("modifiedText")) {
       for (auto &&i : json["modifiedText"].items()) {
-        const auto it = context_.textTranslation.find(std::stoi(i.key()));
-        // TODO dirty const off-cast
-        if (it == context_.textTranslation.end())
+        const std::uint32_t id = std::stoul(i.key());
+        if (id >= context_.textTranslation.size())
           continue;
-        const_cast<pugi::xml_text *>(it->second)
-            ->set(i.value().get<std::string>().c_str());
+        context_.textTranslation[id].set(i.value().get<std::string>().c_str());
+        modified_(id);
       }
     }
 
     return true;
   }
 
+  std::string retranslate() {
+    nlohmann::json result = nlohmann::json::object();
+    if (context_.modifiedBlocks.empty())
+      return result.dump();
+
+    const std::uint32_t textIndex = context_.currentTextTranslationIndex;
+    const std::uint32_t entry = context_.entry;
+    context_.config = &config_;
+
+    for (auto &&id : context_.modifiedBlocks) {
+      const Block &block = context_.blocks[id];
+      std::ostringstream out;
+      context_.output = &out;
+      context_.entry = block.entry;
+      context_.currentBlock = id;
+      context_.currentTextTranslationIndex = block.textBegin;
+      ContentTranslator::html(block.node, context_);
+      result[std::to_string(id)] = out.str();
+    }
+
+    context_.modifiedBlocks.clear();
+    context_.currentTextTranslationIndex = textIndex;
+    context_.entry = entry;
+    context_.config = nullptr;
+    context_.output = nullptr;
+    return result.dump();
+  }
+
   bool save(const access::Path &path) const {
     // TODO throw if not decrypted
     // TODO this would decrypt/inflate and encrypt/deflate again
@@ -230,7 +511,6 @@ public:
     }
 
     storage_->visit([&](const auto &p) {
-      std::cout << p.string() << std::endl;
       if (p == "mimetype")
         return;
       if (storage_->isDirectory(p)) {
@@ -255,16 +535,54 @@ public:
   }
 
 private:
-  std::unique_ptr<access::ReadStorage> storage_;
+  std::unique_ptr<access::CachingStorage> storage_;
 
   FileMeta meta_;
-  Meta::Manifest manifest_;
 
   bool decrypted_{false};
+  bool edited_{false};
 
+  Config config_;
   Context context_;
   pugi::xml_document style_;
   pugi::xml_document content_;
+  common::IrDocument ir_;
+
+  // marks the block containing the text translation index as modified
+  void modified_(const std::uint32_t textIndex) {
+    const auto &blocks = context_.blocks;
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), textIndex,
+                               [](const std::uint32_t index, const Block &b) {
+                                 return index < b.textBegin;
+                               });
+    if (it == blocks.begin())
+      return;
+    --it;
+    if (textIndex < it->textEnd)
+      context_.modifiedBlocks.insert(it - blocks.begin());
+  }
+
+  void translateIr_(std::ostream &out, const Config &config) {
+    // the representation covers the whole document and is built only once
+    if (ir_.empty()) {
+      // edits only live in `content_` and decrypted content stays off disk
+      const bool cache = !config.irCache.empty() && !edited_ && !decrypted_;
+      if (!cache || !common::IrCache::load(config.irCache, *storage_, ir_)) {
+        if (!content_.first_child())
+          content_ = common::XmlUtil::parse(*storage_, "content.xml");
+        ContentTranslator::ir(
+            content_.child("office:document-content").child("office:body"),
+            context_, ir_);
+        if (cache)
+          common::IrCache::store(config.irCache, *storage_, ir_);
+      }
+    }
+
+    if (config.format == TranslationFormat::TEXT)
+      common::IrRenderer::text(ir_, config, out);
+    else
+      common::IrRenderer::json(ir_, config, out);
+  }
 };
 
 OpenDocument::OpenDocument(const char *path)
@@ -294,6 +612,20 @@ const access::ReadStorage &OpenDocument::storage() const noexcept {
   return impl_->storage();
 }
 
+DocumentCost OpenDocument::estimateCost() const {
+  return common::Cost::estimate(impl_->storage(), impl_->meta());
+}
+
+std::string OpenDocument::fingerprint(const bool content) const {
+  if (content)
+    return common::Fingerprint::content(impl_->storage());
+  return common::Fingerprint::directory(impl_->storage());
+}
+
+std::vector<Diagnostic> OpenDocument::diagnostics() const {
+  return impl_->diagnostics();
+}
+
 bool OpenDocument::decrypted() const noexcept { return impl_->decrypted(); }
 
 bool OpenDocument::translatable() const noexcept {
@@ -310,12 +642,14 @@ bool OpenDocument::decrypt(const std::string &password) {
   return impl_->decrypt(password);
 }
 
-void OpenDocument::translate(const access::Path &path, const Config &config) {
-  impl_->translate(path, config);
+bool OpenDocument::translate(const access::Path &path, const Config &config) {
+  return impl_->translate(path, config);
 }
 
 void OpenDocument::edit(const std::string &diff) { impl_->edit(diff); }
 
+std::string OpenDocument::retranslate() { return impl_->retranslate(); }
+
 void OpenDocument::save(const access::Path &path) const { impl_->save(path); }
 
 void OpenDocument::save(const access::Path &path,
@@ -1,10 +1,12 @@
 #include <StyleTranslator.h>
 #include <common/StringUtil.h>
 #include <cstring>
-#include <glog/logging.h>
+#include <odr/Config.h>
 #include <pugixml.hpp>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace odr {
 namespace odf {
@@ -12,7 +14,7 @@ namespace odf {
 namespace {
 void StylePropertiesTranslator(const pugi::xml_attribute &in,
                                std::ostream &out) {
-  static std::unordered_map<std::string, const char *> substitution{
+  static const std::unordered_map<std::string_view, const char *> substitution{
       {"fo:text-align", "text-align"},
       {"fo:font-size", "font-size"},
       {"fo:font-weight", "font-weight"},
@@ -49,7 +51,7 @@ void StylePropertiesTranslator(const pugi::xml_attribute &in,
       {"text:display", "display"},
   };
 
-  const std::string property = in.name();
+  const std::string_view property = in.name();
   const auto it = substitution.find(property);
   if (it != substitution.end()) {
     out << it->second << ":" << in.as_string() << ";";
@@ -67,30 +69,8 @@ void StylePropertiesTranslator(const pugi::xml_attribute &in,
   }
 }
 
-void StyleClassTranslator(const pugi::xml_node &in, std::ostream &out,
-                          Context &context) {
-  static std::unordered_map<std::string, const char *> elementToNameAttr{
-      {"style:default-style", "style:family"},
-      {"style:style", "style:name"},
-      {"style:page-layout", "style:name"},
-      {"style:master-page", "style:name"},
-  };
-
-  const std::string element = in.name();
-  const auto it = elementToNameAttr.find(element);
-  if (it == elementToNameAttr.end())
-    return;
-
-  const auto nameAttr = in.attribute(it->second);
-  if (!nameAttr) {
-    LOG(WARNING) << "skipped style " << in.name() << ". no name attribute.";
-    return;
-  }
-  std::string name = StyleTranslator::escapeStyleName(nameAttr.as_string());
-  // master page
-  if (std::strcmp(in.name(), "style:master-page") == 0)
-    name = StyleTranslator::escapeMasterStyleName(nameAttr.as_string());
-
+void StyleDependencyTranslator(const pugi::xml_node &in,
+                               const std::string &name, Context &context) {
   if (const auto parentStyleNameAttr = in.attribute("style:parent-style-name");
       parentStyleNameAttr)
     context.styleDependencies[name].push_back(
@@ -108,16 +88,56 @@ void StyleClassTranslator(const pugi::xml_node &in, std::ostream &out,
   if (const auto drawStyleAttr = in.attribute("draw:style-name"); drawStyleAttr)
     context.styleDependencies[name].push_back(
         StyleTranslator::escapeStyleName(drawStyleAttr.as_string()));
+}
+
+// records dependencies if `names` is not set; writes css if `out` is set and
+// the style is contained in `names` or `names` is not set
+void StyleClassTranslator(const pugi::xml_node &in, std::ostream *out,
+                          const std::unordered_set<std::string> *names,
+                          Context &context) {
+  static const std::unordered_map<std::string_view, const char *>
+      elementToNameAttr{
+          {"style:default-style", "style:family"},
+          {"style:style", "style:name"},
+          {"style:page-layout", "style:name"},
+          {"style:master-page", "style:name"},
+      };
+
+  const std::string_view element = in.name();
+  const auto it = elementToNameAttr.find(element);
+  if (it == elementToNameAttr.end())
+    return;
+
+  const auto nameAttr = in.attribute(it->second);
+  if (!nameAttr) {
+    context.diagnostics.report("style without name", element);
+    return;
+  }
+  std::string name = StyleTranslator::escapeStyleName(nameAttr.as_string());
+  // master page
+  if (std::strcmp(in.name(), "style:master-page") == 0)
+    name = StyleTranslator::escapeMasterStyleName(nameAttr.as_string());
+
+  if (names != nullptr) {
+    if ((out == nullptr) || (names->find(name) == names->end()))
+      return;
+  } else {
+    StyleDependencyTranslator(in, name, context);
+    if (out == nullptr)
+      return;
+  }
 
-  out << "." << name << "." << name << " {";
+  const bool compact = context.config->compact;
+  const std::string className = StyleTranslator::className(name, context);
+  *out << "." << className << "." << className << (compact ? "{" : " {");
 
   for (auto &&e : in) {
     for (auto &&a : e.attributes()) {
-      StylePropertiesTranslator(a, out);
+      StylePropertiesTranslator(a, *out);
     }
   }
 
-  out << "}\n";
+  *out << (compact ? "}" : "}\n");
 }
 
 // TODO
@@ -128,8 +148,7 @@ void ListStyleTranslator(const pugi::xml_node &in, std::ostream &,
 
   const auto styleNameAttr = in.parent().attribute("style:name");
   if (styleNameAttr == nullptr) {
-    LOG(WARNING) << "skipped style " << in.parent().name()
-                 << ". no name attribute.";
+    context.diagnostics.report("style without name", in.parent().name());
     return;
   }
   const std::string styleName =
@@ -138,7 +157,7 @@ void ListStyleTranslator(const pugi::xml_node &in, std::ostream &,
 
   const auto listLevelAttr = in.attribute("text:level");
   if (!listLevelAttr) {
-    LOG(WARNING) << "cannot find level attribute";
+    context.diagnostics.report("list style without level", styleName);
     return;
   }
   const std::uint32_t listLevel = listLevelAttr.as_uint();
@@ -163,7 +182,7 @@ void ListStyleTranslator(const pugi::xml_node &in, std::ostream &,
     *context.output << "list-style: decimal;";
     *context.output << "}\n";
   } else {
-    LOG(WARNING) << "unhandled case";
+    context.diagnostics.report("unhandled list style", styleName);
   }
 }
 } // namespace
@@ -178,9 +197,43 @@ std::string StyleTranslator::escapeMasterStyleName(const std::string &name) {
   return "master_" + escapeStyleName(name);
 }
 
+std::string StyleTranslator::className(const std::string &name,
+                                      Context &context) {
+  if (!context.config->compact)
+    return name;
+
+  auto it = context.classNames.find(name);
+  if (it == context.classNames.end()) {
+    // base 36 id; the underscore keeps it from starting with a digit
+    std::string id = "_";
+    std::size_t n = context.classNames.size();
+    do {
+      id += "0123456789abcdefghijklmnopqrstuvwxyz"[n % 36];
+      n /= 36;
+    } while (n > 0);
+    it = context.classNames.emplace(name, std::move(id)).first;
+  }
+  return it->second;
+}
+
 void StyleTranslator::css(const pugi::xml_node &in, Context &context) {
   for (auto &&e : in) {
-    StyleClassTranslator(e, *context.output, context);
+    StyleClassTranslator(e, context.output, nullptr, context);
+  }
+}
+
+void StyleTranslator::dependencies(const pugi::xml_node &in,
+                                   Context &context) {
+  for (auto &&e : in) {
+    StyleClassTranslator(e, nullptr, nullptr, context);
+  }
+}
+
+void StyleTranslator::css(const pugi::xml_node &in,
+                          const std::unordered_set<std::string> &names,
+                          Context &context) {
+  for (auto &&e : in) {
+    StyleClassTranslator(e, context.output, &names, context);
   }
 }
 
@@ -3,6 +3,8 @@
 
 #include <Context.h>
 #include <memory>
+#include <string>
+#include <unordered_set>
 
 namespace pugi {
 class xml_node;
@@ -16,7 +18,14 @@ struct Context;
 namespace StyleTranslator {
 std::string escapeStyleName(const std::string &name);
 std::string escapeMasterStyleName(const std::string &name);
+// the class written for an escaped style name; a short id in compact mode
+std::string className(const std::string &name, Context &context);
 void css(const pugi::xml_node &in, Context &context);
+// records the style dependencies without writing css
+void dependencies(const pugi::xml_node &in, Context &context);
+// writes css only for the given style names; dependencies are not recorded
+void css(const pugi::xml_node &in, const std::unordered_set<std::string> &names,
+         Context &context);
 } // namespace StyleTranslator
 
 } // namespace odf
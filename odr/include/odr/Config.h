@@ -2,6 +2,7 @@
 #define ODR_CONFIG_H
 
 #include <cstdint>
+#include <string>
 
 namespace odr {
 
@@ -11,16 +12,44 @@ enum class TableGridlines {
   HARD,
 };
 
+enum class TranslationFormat {
+  HTML,
+  // plain text; table cells separated by tabs
+  TEXT,
+  // content tree with styles and repetitions
+  JSON,
+};
+
 struct Config {
-  // starting sheet for spreadsheet, starting page for presentation, ignored for
-  // text, ignored for graphics
+  TranslationFormat format{TranslationFormat::HTML};
+
+  // starting sheet for spreadsheet, starting page for presentation and text,
+  // ignored for graphics. text pages are delimited by the soft page breaks
+  // stored by the last application which laid out the document
   std::uint32_t entryOffset{0};
   // translate only N sheets / pages; zero means translate all
   std::uint32_t entryCount{0};
+  // translate only the sheet with this name instead of entryOffset and
+  // entryCount; empty selects by position
+  std::string sheetName;
   // create output for each entry
   bool splitEntries{false};
   // create editable output
   bool editable{false};
+  // emit css only for styles referenced by the translated content
+  bool pruneStyles{false};
+  // short class names, merged whitespace and minified css for smaller output
+  bool compact{false};
+  // gzip compress the output while it is written
+  bool gzip{false};
+  // deflate level from 0 (stored) to 9 (smallest)
+  std::uint32_t gzipLevel{6};
+  // inflate and parse the content while the styles are translated, and write
+  // the output on a separate thread
+  bool pipeline{false};
+  // directory to keep the text and json representation in between runs;
+  // empty disables the cache
+  std::string irCache;
 
   // spreadsheet table offset
   std::uint32_t tableOffsetRows{0};
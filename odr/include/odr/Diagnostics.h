@@ -0,0 +1,20 @@
+#ifndef ODR_DIAGNOSTICS_H
+#define ODR_DIAGNOSTICS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace odr {
+
+// problems of one kind found during a translation
+struct Diagnostic {
+  std::string category;
+  std::uint64_t count{0};
+  // details of the first occurrences
+  std::vector<std::string> samples;
+};
+
+} // namespace odr
+
+#endif // ODR_DIAGNOSTICS_H
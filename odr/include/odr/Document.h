@@ -1,9 +1,12 @@
 #ifndef ODR_DOCUMENT_H
 #define ODR_DOCUMENT_H
 
+#include <iosfwd>
 #include <memory>
+#include <odr/Diagnostics.h>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace odr {
 
@@ -13,6 +16,7 @@ class Document;
 
 enum class FileType;
 struct FileMeta;
+struct DocumentCost;
 struct Config;
 
 class Document final {
@@ -25,12 +29,26 @@ public:
 
   explicit Document(const std::string &path);
   Document(const std::string &path, FileType as);
+  // opens a file which was already read into memory, e.g. by a prefetcher.
+  // the document takes the bytes over instead of copying them
+  static Document fromBuffer(std::string &&data);
+  // opens a zip based file while it is still arriving, e.g. from an upload.
+  // members are read ahead as they are needed, so translation overlaps with
+  // the rest of the transfer
+  static Document fromStream(std::unique_ptr<std::istream> in);
   Document(Document &&) noexcept;
   ~Document();
 
   FileType type() const noexcept;
   bool encrypted() const noexcept;
   const FileMeta &meta() const noexcept;
+  // cheap prediction for scheduling before anything is parsed
+  DocumentCost estimateCost() const;
+  // stable 128 bit hash as hex for caching and deduplication. by default only
+  // the container directory is read; `content` hashes every byte instead
+  std::string fingerprint(bool content = false) const;
+  // problems of the last translation counted by category
+  std::vector<Diagnostic> diagnostics() const;
 
   bool decrypted() const noexcept;
   bool translatable() const noexcept;
@@ -39,13 +57,18 @@ public:
 
   bool decrypt(const std::string &password) const;
 
-  void translate(const std::string &path, const Config &config) const;
+  // false if the output could not be written completely
+  bool translate(const std::string &path, const Config &config) const;
   void edit(const std::string &diff) const;
+  // json object mapping block ids to their translation after `edit`
+  std::string retranslate() const;
 
   void save(const std::string &path) const;
   void save(const std::string &path, const std::string &password) const;
 
 private:
+  explicit Document(std::unique_ptr<common::Document>);
+
   std::unique_ptr<common::Document> impl_;
 };
 
@@ -66,6 +89,9 @@ public:
   FileType type() const noexcept;
   bool encrypted() const noexcept;
   const FileMeta &meta() const noexcept;
+  std::optional<DocumentCost> estimateCost() const noexcept;
+  std::optional<std::string> fingerprint(bool content = false) const noexcept;
+  std::optional<std::vector<Diagnostic>> diagnostics() const noexcept;
 
   bool decrypted() const noexcept;
   bool canTranslate() const noexcept;
@@ -77,6 +103,7 @@ public:
 
   bool translate(const std::string &path, const Config &config) const noexcept;
   bool edit(const std::string &diff) const noexcept;
+  std::optional<std::string> retranslate() const noexcept;
 
   bool save(const std::string &path) const noexcept;
   bool save(const std::string &path, const std::string &password) const
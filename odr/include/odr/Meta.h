@@ -58,6 +58,19 @@ struct FileMeta {
   std::string typeAsString() const noexcept;
 };
 
+// rough prediction of the resources a translation takes; derived from the
+// storage listing and the meta data without parsing the document
+struct DocumentCost {
+  // uncompressed markup and binary streams which are parsed
+  std::uint64_t parseBytes{0};
+  // embedded images which end up in the output
+  std::uint64_t imageBytes{0};
+  std::uint64_t nodeCount{0};
+  std::uint64_t cellCount{0};
+  double seconds{0};
+  std::uint64_t memoryBytes{0};
+};
+
 } // namespace odr
 
 #endif // ODR_META_H
@@ -4,6 +4,7 @@
 #include <access/ZipStorage.h>
 #include <common/Constants.h>
 #include <common/Document.h>
+#include <functional>
 #include <glog/logging.h>
 #include <memory>
 #include <odf/OpenDocument.h>
@@ -18,10 +19,12 @@
 namespace odr {
 
 namespace {
-std::unique_ptr<common::Document> openImpl(const std::string &path) {
+using StorageFactory = std::function<std::unique_ptr<access::ReadStorage>()>;
+
+std::unique_ptr<common::Document> openImpl(const StorageFactory &zip,
+                                           const StorageFactory &cfb) {
   try {
-    std::unique_ptr<access::ReadStorage> storage =
-        std::make_unique<access::ZipReader>(path);
+    std::unique_ptr<access::ReadStorage> storage = zip();
 
     try {
       return std::make_unique<odf::OpenDocument>(storage);
@@ -38,8 +41,9 @@ std::unique_ptr<common::Document> openImpl(const std::string &path) {
   }
   try {
     FileMeta meta;
-    std::unique_ptr<access::ReadStorage> storage =
-        std::make_unique<access::CfbReader>(path);
+    if (!cfb)
+      throw UnknownFileType();
+    std::unique_ptr<access::ReadStorage> storage = cfb();
 
     // legacy microsoft
     try {
@@ -61,6 +65,45 @@ std::unique_ptr<common::Document> openImpl(const std::string &path) {
   throw UnknownFileType();
 }
 
+std::unique_ptr<common::Document> openImpl(const std::string &path) {
+  return openImpl([&] { return std::make_unique<access::ZipReader>(path); },
+                  [&] { return std::make_unique<access::CfbReader>(path); });
+}
+
+std::unique_ptr<common::Document> openBufferImpl(std::string &&data) {
+  // both probes and the document share the one buffer
+  const auto buffer = std::make_shared<const std::string>(std::move(data));
+  return openImpl([&] { return std::make_unique<access::ZipReader>(buffer); },
+                  [&] { return std::make_unique<access::CfbReader>(buffer); });
+}
+
+// cfb needs random access, so only zip based formats can be streamed. the
+// format is told from the first member instead of probing one after the
+// other: a failed probe would have read the rest of the stream for nothing
+std::unique_ptr<common::Document>
+openStreamImpl(std::unique_ptr<std::istream> in) {
+  std::unique_ptr<access::ReadStorage> storage;
+  access::Path first;
+  try {
+    auto zip = std::make_unique<access::ZipStreamReader>(std::move(in));
+    first = zip->first();
+    storage = std::move(zip);
+  } catch (...) {
+    throw UnknownFileType();
+  }
+
+  try {
+    // ODF requires `mimetype` to be the first member
+    if (first == access::Path("mimetype"))
+      return std::make_unique<odf::OpenDocument>(storage);
+    return std::make_unique<ooxml::OfficeOpenXml>(storage);
+  } catch (...) {
+    // TODO
+  }
+
+  throw UnknownFileType();
+}
+
 std::unique_ptr<common::Document> openImpl(const std::string &path,
                                            const FileType as) {
   // TODO implement
@@ -89,6 +132,17 @@ Document::Document(const std::string &path) : impl_(openImpl(path)) {}
 Document::Document(const std::string &path, const FileType as)
     : impl_(openImpl(path, as)) {}
 
+Document::Document(std::unique_ptr<common::Document> impl)
+    : impl_(std::move(impl)) {}
+
+Document Document::fromBuffer(std::string &&data) {
+  return Document(openBufferImpl(std::move(data)));
+}
+
+Document Document::fromStream(std::unique_ptr<std::istream> in) {
+  return Document(openStreamImpl(std::move(in)));
+}
+
 Document::Document(Document &&) noexcept = default;
 
 Document::~Document() = default;
@@ -99,6 +153,16 @@ bool Document::encrypted() const noexcept { return impl_->meta().encrypted; }
 
 const FileMeta &Document::meta() const noexcept { return impl_->meta(); }
 
+DocumentCost Document::estimateCost() const { return impl_->estimateCost(); }
+
+std::string Document::fingerprint(const bool content) const {
+  return impl_->fingerprint(content);
+}
+
+std::vector<Diagnostic> Document::diagnostics() const {
+  return impl_->diagnostics();
+}
+
 bool Document::decrypted() const noexcept { return impl_->decrypted(); }
 
 bool Document::translatable() const noexcept { return impl_->translatable(); }
@@ -113,12 +177,14 @@ bool Document::decrypt(const std::string &password) const {
   return impl_->decrypt(password);
 }
 
-void Document::translate(const std::string &path, const Config &config) const {
-  impl_->translate(path, config);
+bool Document::translate(const std::string &path, const Config &config) const {
+  return impl_->translate(path, config);
 }
 
 void Document::edit(const std::string &diff) const { impl_->edit(diff); }
 
+std::string Document::retranslate() const { return impl_->retranslate(); }
+
 void Document::save(const std::string &path) const { impl_->save(path); }
 
 void Document::save(const std::string &path,
@@ -201,6 +267,35 @@ const FileMeta &DocumentNoExcept::meta() const noexcept {
   }
 }
 
+std::optional<DocumentCost> DocumentNoExcept::estimateCost() const noexcept {
+  try {
+    return impl_->estimateCost();
+  } catch (...) {
+    LOG(ERROR) << "estimateCost failed";
+    return {};
+  }
+}
+
+std::optional<std::string>
+DocumentNoExcept::fingerprint(const bool content) const noexcept {
+  try {
+    return impl_->fingerprint(content);
+  } catch (...) {
+    LOG(ERROR) << "fingerprint failed";
+    return {};
+  }
+}
+
+std::optional<std::vector<Diagnostic>>
+DocumentNoExcept::diagnostics() const noexcept {
+  try {
+    return impl_->diagnostics();
+  } catch (...) {
+    LOG(ERROR) << "diagnostics failed";
+    return {};
+  }
+}
+
 bool DocumentNoExcept::decrypted() const noexcept {
   try {
     return impl_->decrypted();
@@ -251,8 +346,7 @@ bool DocumentNoExcept::decrypt(const std::string &password) const noexcept {
 bool DocumentNoExcept::translate(const std::string &path,
                                  const Config &config) const noexcept {
   try {
-    impl_->translate(path, config);
-    return true;
+    return impl_->translate(path, config);
   } catch (...) {
     LOG(ERROR) << "translate failed";
     return false;
@@ -269,6 +363,15 @@ bool DocumentNoExcept::edit(const std::string &diff) const noexcept {
   }
 }
 
+std::optional<std::string> DocumentNoExcept::retranslate() const noexcept {
+  try {
+    return impl_->retranslate();
+  } catch (...) {
+    LOG(ERROR) << "retranslate failed";
+    return {};
+  }
+}
+
 bool DocumentNoExcept::save(const std::string &path) const noexcept {
   try {
     impl_->save(path);
@@ -1,16 +1,19 @@
 #include <access/CfbStorage.h>
 #include <access/Path.h>
+#include <common/Cost.h>
+#include <common/Fingerprint.h>
 #include <memory>
 #include <odr/Exception.h>
 #include <oldms/LegacyMicrosoft.h>
-#include <unordered_map>
+#include <utility>
 
 namespace odr {
 namespace oldms {
 
 namespace {
 FileMeta parseMeta(const access::ReadStorage &storage) {
-  static const std::unordered_map<access::Path, FileType> TYPES = {
+  // probed in order; views so that nothing is allocated
+  static constexpr std::pair<access::PathView, FileType> TYPES[] = {
       // MS-DOC: The "WordDocument" stream MUST be present in the file.
       // https://msdn.microsoft.com/en-us/library/dd926131(v=office.12).aspx
       {"WordDocument", FileType::LEGACY_WORD_DOCUMENT},
@@ -52,11 +55,13 @@ LegacyMicrosoft::LegacyMicrosoft(const access::Path &path)
 LegacyMicrosoft::LegacyMicrosoft(
     std::unique_ptr<access::ReadStorage> &&storage) {
   meta_ = parseMeta(*storage);
+  storage_ = std::move(storage);
 }
 
 LegacyMicrosoft::LegacyMicrosoft(
     std::unique_ptr<access::ReadStorage> &storage) {
   meta_ = parseMeta(*storage);
+  storage_ = std::move(storage);
 }
 
 LegacyMicrosoft::LegacyMicrosoft(LegacyMicrosoft &&) noexcept = default;
@@ -68,6 +73,18 @@ LegacyMicrosoft::~LegacyMicrosoft() = default;
 
 const FileMeta &LegacyMicrosoft::meta() const noexcept { return meta_; }
 
+DocumentCost LegacyMicrosoft::estimateCost() const {
+  return common::Cost::estimate(*storage_, meta_);
+}
+
+std::string LegacyMicrosoft::fingerprint(const bool content) const {
+  if (content)
+    return common::Fingerprint::content(*storage_);
+  return common::Fingerprint::directory(*storage_);
+}
+
+std::vector<Diagnostic> LegacyMicrosoft::diagnostics() const { return {}; }
+
 bool LegacyMicrosoft::decrypted() const noexcept { return false; }
 
 bool LegacyMicrosoft::translatable() const noexcept { return false; }
@@ -80,7 +97,7 @@ bool LegacyMicrosoft::decrypt(const std::string &) {
   throw UnsupportedOperation();
 }
 
-void LegacyMicrosoft::translate(const access::Path &, const Config &) {
+bool LegacyMicrosoft::translate(const access::Path &, const Config &) {
   throw UnsupportedOperation();
 }
 
@@ -88,6 +105,8 @@ void LegacyMicrosoft::edit(const std::string &) {
   throw UnsupportedOperation();
 }
 
+std::string LegacyMicrosoft::retranslate() { throw UnsupportedOperation(); }
+
 void LegacyMicrosoft::save(const access::Path &) const {
   throw UnsupportedOperation();
 }
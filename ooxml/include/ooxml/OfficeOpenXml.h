@@ -26,6 +26,9 @@ public:
 
   const FileMeta &meta() const noexcept final;
   const access::ReadStorage &storage() const noexcept;
+  DocumentCost estimateCost() const final;
+  std::string fingerprint(bool content) const final;
+  std::vector<Diagnostic> diagnostics() const final;
 
   bool decrypted() const noexcept final;
   bool translatable() const noexcept final;
@@ -34,9 +37,10 @@ public:
 
   bool decrypt(const std::string &password) final;
 
-  void translate(const access::Path &path, const Config &config) final;
+  bool translate(const access::Path &path, const Config &config) final;
 
   void edit(const std::string &diff) final;
+  std::string retranslate() final;
 
   void save(const access::Path &path) const final;
   void save(const access::Path &path, const std::string &password) const final;
@@ -1,6 +1,9 @@
 #ifndef ODR_OOXML_CONTEXT_H
 #define ODR_OOXML_CONTEXT_H
 
+#include <access/Diagnostics.h>
+#include <access/Path.h>
+#include <common/StyleTable.h>
 #include <common/TableCursor.h>
 #include <common/TableRange.h>
 #include <iostream>
@@ -9,6 +12,7 @@
 #include <pugixml.hpp>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace odr {
@@ -23,6 +27,12 @@ class ReadStorage;
 namespace odr {
 namespace ooxml {
 
+// slide or sheet part
+struct Entry {
+  std::string name; // xlsx
+  access::Path path;
+};
+
 struct Context {
   const Config *config;
   const FileMeta *meta;
@@ -32,18 +42,29 @@ struct Context {
   std::ostream *output;
 
   std::unordered_map<std::string, std::list<std::string>> styleDependencies;
+  // style names used by the translated content; collected only if set
+  std::unordered_set<std::string> *referencedStyles{nullptr};
+  // classes for inline declarations; written after the content (docx, pptx)
+  common::StyleTable inlineStyles;
   std::unordered_map<std::string, std::string> relations;
   pugi::xml_document sharedStringsDocument;  // xlsx
   std::vector<pugi::xml_node> sharedStrings; // xlsx
 
+  // in document order; built on first use (pptx, xlsx)
+  std::vector<Entry> entries;
+  // position in `entries` by sheet name (xlsx)
+  std::unordered_map<std::string, std::uint32_t> entryIndex;
   std::uint32_t entry{0};
   common::TableRange tableRange;
   common::TableCursor tableCursor;
   std::unordered_map<std::uint32_t, std::string> defaultCellStyles;
+  // problems of the last translation
+  access::Diagnostics diagnostics;
 
   // editing
   std::uint32_t currentTextTranslationIndex{0};
-  std::unordered_map<std::uint32_t, const pugi::xml_text *> textTranslation;
+  // indexed by text translation index
+  std::vector<pugi::xml_text> textTranslation;
 };
 
 } // namespace ooxml
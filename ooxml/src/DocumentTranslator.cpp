@@ -3,13 +3,18 @@
 #include <access/Path.h>
 #include <access/Storage.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
+#include <algorithm>
+#include <common/IrDocument.h>
 #include <common/StringUtil.h>
+#include <common/XmlTraversal.h>
 #include <crypto/CryptoUtil.h>
 #include <cstring>
-#include <glog/logging.h>
 #include <odr/Config.h>
 #include <pugixml.hpp>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -195,14 +200,14 @@ void StyleClassTranslator(const pugi::xml_node &in, std::ostream &out,
   if (const auto nameAttr = in.attribute("w:styleId"); nameAttr) {
     name = nameAttr.value();
   } else {
-    LOG(WARNING) << "no name attribute " << in.name();
+    context.diagnostics.report("style without name", in.name());
   }
 
   std::string type = "unknown";
   if (const auto typeAttr = in.attribute("w:type"); typeAttr) {
     type = typeAttr.value();
   } else {
-    LOG(WARNING) << "no type attribute " << in.name();
+    context.diagnostics.report("style without type", name);
   }
 
   /*
@@ -237,6 +242,7 @@ void DocumentTranslator::css(const pugi::xml_node &in, Context &context) {
 }
 
 namespace {
+template <bool Editable>
 void TextTranslator(const pugi::xml_text &in, std::ostream &out,
                     Context &context) {
   std::string text = in.as_string();
@@ -244,12 +250,15 @@ void TextTranslator(const pugi::xml_text &in, std::ostream &out,
   common::StringUtil::findAndReplaceAll(text, "<", "&lt;");
   common::StringUtil::findAndReplaceAll(text, ">", "&gt;");
 
-  if (!context.config->editable) {
+  if constexpr (!Editable) {
     out << text;
   } else {
+    // without blocks to count markers in, each text carries its own index
     out << R"(<span contenteditable="true" data-odr-cid=")"
         << context.currentTextTranslationIndex << "\">" << text << "</span>";
-    context.textTranslation[context.currentTextTranslationIndex] = &in;
+    if (context.currentTextTranslationIndex >= context.textTranslation.size())
+      context.textTranslation.resize(context.currentTextTranslationIndex + 1);
+    context.textTranslation[context.currentTextTranslationIndex] = in;
     ++context.currentTextTranslationIndex;
   }
 }
@@ -258,18 +267,25 @@ void StyleAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
                               Context &context) {
   const std::string prefix = in.name();
 
-  const pugi::xml_node style =
-      in.child((prefix + "Pr").c_str()).child((prefix + "Style").c_str());
-  if (style)
-    *context.output << " class=\"" << style.attribute("w:val").as_string()
-                    << "\"";
-
   const pugi::xml_node inlineStyle = in.child((prefix + "Pr").c_str());
+  const pugi::xml_node style = inlineStyle.child((prefix + "Style").c_str());
+
+  std::string inlineClass;
   if (inlineStyle && inlineStyle.first_child()) {
-    out << " style=\"";
-    translateStyleInline(inlineStyle, out, context);
-    out << "\"";
+    std::ostringstream declarations;
+    translateStyleInline(inlineStyle, declarations, context);
+    if (const std::string d = declarations.str(); !d.empty())
+      inlineClass = context.inlineStyles.intern(d);
   }
+
+  if (!style && inlineClass.empty())
+    return;
+  out << " class=\"";
+  if (style)
+    out << style.attribute("w:val").as_string();
+  if (style && !inlineClass.empty())
+    out << " ";
+  out << inlineClass << "\"";
 }
 
 void ElementAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
@@ -277,21 +293,35 @@ void ElementAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
   StyleAttributeTranslator(in, out, context);
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context);
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context);
+struct ElementTranslator;
+
+struct ElementState {
+  const ElementTranslator *translator{nullptr};
+};
+
+typedef common::XmlTraversal::Frame<ElementState> Frame;
 
-void TabTranslator(const pugi::xml_node &, std::ostream &out, Context &) {
+struct ElementTranslator {
+  // writes the opening part; returns false to skip the element entirely
+  bool (*enter)(Frame &, std::ostream &, Context &);
+  // writes the closing part; returns true to repeat the element
+  bool (*leave)(Frame &, std::ostream &, Context &);
+};
+
+bool NoLeave(Frame &, std::ostream &, Context &) { return false; }
+
+bool TabEnter(Frame &frame, std::ostream &out, Context &) {
   out << "\t";
+  frame.next = {};
+  return true;
 }
 
-void ParagraphTranslator(const pugi::xml_node &in, std::ostream &out,
-                         Context &context) {
+bool ParagraphEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   const pugi::xml_node num = in.child("w:pPr").child("w:numPr");
-  int listingLevel;
   if (num) {
-    listingLevel = num.child("w:ilvl").attribute("w:val").as_int();
+    const int listingLevel = num.child("w:ilvl").attribute("w:val").as_int();
     for (int i = 0; i <= listingLevel; ++i) {
       out << "<ul>";
     }
@@ -314,32 +344,43 @@ void ParagraphTranslator(const pugi::xml_node &in, std::ostream &out,
     }
   }
 
-  if (empty)
+  if (empty) {
     out << "<br/>";
-  else
-    ElementChildrenTranslator(in, out, context);
+    frame.next = {};
+  }
+
+  return true;
+}
 
+bool ParagraphLeave(Frame &frame, std::ostream &out, Context &) {
   out << "</p>";
 
+  const pugi::xml_node num = frame.node.child("w:pPr").child("w:numPr");
   if (num) {
+    const int listingLevel = num.child("w:ilvl").attribute("w:val").as_int();
     out << "</li>";
     for (int i = 0; i <= listingLevel; ++i) {
       out << "</ul>";
     }
   }
+  return false;
 }
 
-void SpanTranslator(const pugi::xml_node &in, std::ostream &out,
-                    Context &context) {
+bool SpanEnter(Frame &frame, std::ostream &out, Context &context) {
   out << "<span";
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator(frame.node, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool SpanLeave(Frame &, std::ostream &out, Context &) {
   out << "</span>";
+  return false;
 }
 
-void HyperlinkTranslator(const pugi::xml_node &in, std::ostream &out,
-                         Context &context) {
+bool HyperlinkEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   out << "<a";
 
   if (const auto anchorAttr = in.attribute("w:anchor"); anchorAttr)
@@ -350,36 +391,43 @@ void HyperlinkTranslator(const pugi::xml_node &in, std::ostream &out,
   ElementAttributeTranslator(in, out, context);
 
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool HyperlinkLeave(Frame &, std::ostream &out, Context &) {
   out << "</a>";
+  return false;
 }
 
-void BookmarkTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &) {
-  if (const auto nameAttr = in.attribute("w:name"); nameAttr)
+bool BookmarkEnter(Frame &frame, std::ostream &out, Context &) {
+  if (const auto nameAttr = frame.node.attribute("w:name"); nameAttr)
     out << "<a id=\"" << nameAttr.as_string() << "\"/>";
+  frame.next = {};
+  return true;
 }
 
-void TableTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+bool TableEnter(Frame &frame, std::ostream &out, Context &context) {
   out << R"(<table border="0" cellspacing="0" cellpadding="0")";
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator(frame.node, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool TableLeave(Frame &, std::ostream &out, Context &) {
   out << "</table>";
+  return false;
 }
 
-void DrawingsTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
+bool DrawingsEnter(Frame &frame, std::ostream &out, Context &) {
   // ooxml is using amazing units
   // https://startbigthinksmall.wordpress.com/2010/01/04/points-inches-and-emus-measuring-units-in-office-open-xml/
 
-  const auto child = in.first_child();
+  const auto child = frame.node.first_child();
   if (!child)
-    return;
+    return false;
   const auto graphic = child.child("a:graphic");
   if (!graphic)
-    return;
+    return false;
   // TODO handle something other than inline
 
   out << "<div";
@@ -391,21 +439,27 @@ void DrawingsTranslator(const pugi::xml_node &in, std::ostream &out,
   }
 
   out << ">";
-  ElementTranslator(graphic, out, context);
+  frame.next = graphic;
+  frame.single = true;
+  return true;
+}
+
+bool DrawingsLeave(Frame &, std::ostream &out, Context &) {
   out << "</div>";
+  return false;
 }
 
-void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+bool ImageEnter(Frame &frame, std::ostream &out, Context &context) {
   out << "<img style=\"width:100%;height:100%\"";
 
-  const pugi::xml_node ref = in.child("pic:blipFill").child("a:blip");
+  const pugi::xml_node ref = frame.node.child("pic:blipFill").child("a:blip");
   if (!ref || !ref.attribute("r:embed")) {
     out << " alt=\"Error: image path not specified";
-    LOG(ERROR) << "image href not found";
+    context.diagnostics.report("image without href");
   } else {
     const char *rIdAttr = ref.attribute("r:embed").as_string();
     const auto path = access::Path("word").join(context.relations[rIdAttr]);
+    const access::Trace::Span span("image", path.string());
     out << " alt=\"Error: image not found or unsupported: " << path << "\"";
     out << " src=\"";
     std::string image = access::StreamUtil::read(*context.storage->read(path));
@@ -416,65 +470,227 @@ void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
   }
 
   out << "></img>";
+  frame.next = {};
+  return true;
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context) {
-  for (auto &&n : in) {
-    if (n.type() == pugi::node_pcdata)
-      TextTranslator(n.text(), out, context);
-    else if (n.type() == pugi::node_element)
-      ElementTranslator(n, out, context);
-  }
-}
-
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context);
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &context);
+
+bool ChildrenEnter(Frame &, std::ostream &, Context &) { return true; }
+
+constexpr ElementTranslator tabTranslator{TabEnter, NoLeave};
+constexpr ElementTranslator paragraphTranslator{ParagraphEnter,
+                                                ParagraphLeave};
+constexpr ElementTranslator spanTranslator{SpanEnter, SpanLeave};
+constexpr ElementTranslator hyperlinkTranslator{HyperlinkEnter,
+                                                HyperlinkLeave};
+constexpr ElementTranslator bookmarkTranslator{BookmarkEnter, NoLeave};
+constexpr ElementTranslator tableTranslator{TableEnter, TableLeave};
+constexpr ElementTranslator drawingsTranslator{DrawingsEnter, DrawingsLeave};
+constexpr ElementTranslator imageTranslator{ImageEnter, NoLeave};
+constexpr ElementTranslator substitutionTranslator{SubstitutionEnter,
+                                                   SubstitutionLeave};
+constexpr ElementTranslator childrenTranslator{ChildrenEnter, NoLeave};
+
+const char *substitution(const std::string_view element) {
+  static const std::unordered_map<std::string_view, const char *> substitution{
       {"w:tr", "tr"},
       {"w:tc", "td"},
   };
-  static std::unordered_set<std::string> skippers{
+
+  const auto it = substitution.find(element);
+  if (it == substitution.end())
+    return nullptr;
+  return it->second;
+}
+
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context) {
+  out << "<" << substitution(frame.node.name());
+  ElementAttributeTranslator(frame.node, out, context);
+  out << ">";
+  return true;
+}
+
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &) {
+  out << "</" << substitution(frame.node.name()) << ">";
+  return false;
+}
+
+const ElementTranslator *lookupElementTranslator(const pugi::xml_node &in) {
+  static const std::unordered_set<std::string_view> skippers{
       "w:instrText",
   };
 
-  const std::string element = in.name();
+  const std::string_view element = in.name();
   if (skippers.find(element) != skippers.end())
-    return;
+    return nullptr;
 
   if (element == "w:tab")
-    TabTranslator(in, out, context);
+    return &tabTranslator;
   else if (element == "w:p")
-    ParagraphTranslator(in, out, context);
+    return &paragraphTranslator;
   else if (element == "w:r")
-    SpanTranslator(in, out, context);
+    return &spanTranslator;
   else if (element == "w:hyperlink")
-    HyperlinkTranslator(in, out, context);
+    return &hyperlinkTranslator;
   else if (element == "w:bookmarkStart")
-    BookmarkTranslator(in, out, context);
+    return &bookmarkTranslator;
   else if (element == "w:tbl")
-    TableTranslator(in, out, context);
+    return &tableTranslator;
   else if (element == "w:drawing")
-    DrawingsTranslator(in, out, context);
+    return &drawingsTranslator;
   else if (element == "pic:pic")
-    ImageTranslator(in, out, context);
-  else {
-    const auto it = substitution.find(element);
-    if (it != substitution.end()) {
-      out << "<" << it->second;
-      ElementAttributeTranslator(in, out, context);
-      out << ">";
-    }
-    ElementChildrenTranslator(in, out, context);
-    if (it != substitution.end()) {
-      out << "</" << it->second << ">";
+    return &imageTranslator;
+  else if (substitution(element) != nullptr)
+    return &substitutionTranslator;
+  return &childrenTranslator;
+}
+
+template <bool Editable>
+bool NodeEnter(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.node.type() == pugi::node_pcdata) {
+    TextTranslator<Editable>(frame.node.text(), out, context);
+    frame.next = {};
+    return true;
+  }
+  if (frame.node.type() != pugi::node_element)
+    return false;
+
+  if (frame.state.translator == nullptr) {
+    frame.state.translator = lookupElementTranslator(frame.node);
+    if (frame.state.translator == nullptr)
+      return false;
+  }
+  return frame.state.translator->enter(frame, out, context);
+}
+
+bool NodeLeave(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.state.translator == nullptr)
+    return false;
+  return frame.state.translator->leave(frame, out, context);
+}
+
+struct IrState {
+  // number of opened nodes to close on leave
+  std::uint32_t open{0};
+};
+
+typedef common::XmlTraversal::Frame<IrState> IrFrame;
+
+std::string IrStyle(const pugi::xml_node &in) {
+  const std::string prefix = in.name();
+  return in.child((prefix + "Pr").c_str())
+      .child((prefix + "Style").c_str())
+      .attribute("w:val")
+      .as_string();
+}
+
+bool IrEnter(IrFrame &frame, common::IrDocument &out, Context &context) {
+  const pugi::xml_node &in = frame.node;
+  if (in.type() == pugi::node_pcdata) {
+    out.appendText(in.value());
+    return false;
+  }
+  if (in.type() != pugi::node_element)
+    return false;
+
+  const std::string_view element = in.name();
+  // properties carry no content
+  if ((element == "w:instrText") || common::StringUtil::endsWith(element, "Pr"))
+    return false;
+
+  if (element == "w:p") {
+    if (in.child("w:pPr").child("w:numPr")) {
+      out.open(common::IrType::LIST);
+      out.open(common::IrType::LIST_ITEM);
+      frame.state.open += 2;
     }
+    out.open(common::IrType::PARAGRAPH, IrStyle(in));
+    ++frame.state.open;
+  } else if (element == "w:r") {
+    out.open(common::IrType::SPAN, IrStyle(in));
+    ++frame.state.open;
+  } else if (element == "w:hyperlink") {
+    const std::uint32_t index = out.open(common::IrType::LINK);
+    ++frame.state.open;
+    if (const auto anchorAttr = in.attribute("w:anchor"); anchorAttr)
+      out.setText(index, std::string("#") + anchorAttr.as_string());
+    else if (const auto rIdAttr = in.attribute("r:id"); rIdAttr)
+      out.setText(index, context.relations[rIdAttr.as_string()]);
+  } else if (element == "w:bookmarkStart") {
+    const std::uint32_t index = out.leaf(common::IrType::BOOKMARK);
+    out.setText(index, in.attribute("w:name").as_string());
+    frame.next = {};
+  } else if (element == "w:tab") {
+    out.leaf(common::IrType::TAB);
+    frame.next = {};
+  } else if (element == "w:br") {
+    out.leaf(common::IrType::LINE_BREAK);
+    frame.next = {};
+  } else if (element == "w:tbl") {
+    out.open(common::IrType::TABLE, IrStyle(in));
+    ++frame.state.open;
+  } else if (element == "w:gridCol") {
+    out.leaf(common::IrType::TABLE_COLUMN);
+    frame.next = {};
+  } else if (element == "w:tr") {
+    out.open(common::IrType::TABLE_ROW);
+    ++frame.state.open;
+  } else if (element == "w:tc") {
+    const std::uint32_t index = out.open(common::IrType::TABLE_CELL);
+    ++frame.state.open;
+    const std::uint32_t span =
+        in.child("w:tcPr").child("w:gridSpan").attribute("w:val").as_uint(1);
+    out.setSpan(index, std::max(1u, span), 1);
+  } else if (element == "w:drawing") {
+    const auto graphic = in.first_child().child("a:graphic");
+    if (!graphic)
+      return false;
+    out.open(common::IrType::FRAME);
+    ++frame.state.open;
+    frame.next = graphic;
+    frame.single = true;
+  } else if (element == "pic:pic") {
+    const std::uint32_t index = out.leaf(common::IrType::IMAGE);
+    const pugi::xml_node ref = frame.node.child("pic:blipFill").child("a:blip");
+    if (const auto rIdAttr = ref.attribute("r:embed"); rIdAttr)
+      out.setText(index, access::Path("word")
+                             .join(context.relations[rIdAttr.as_string()])
+                             .string());
+    frame.next = {};
   }
+  return true;
+}
+
+bool IrLeave(IrFrame &frame, common::IrDocument &out) {
+  for (std::uint32_t i = 0; i < frame.state.open; ++i)
+    out.close();
+  return false;
+}
+
+template <bool Editable>
+void translate(const pugi::xml_node &in, std::ostream &out, Context &context) {
+  common::XmlTraversal::traverse<ElementState>(
+      in,
+      [&](Frame &frame) { return NodeEnter<Editable>(frame, out, context); },
+      [&](Frame &frame) { return NodeLeave(frame, out, context); });
 }
 } // namespace
 
 void DocumentTranslator::html(const pugi::xml_node &in, Context &context) {
-  ElementTranslator(in, *context.output, context);
+  std::ostream &out = *context.output;
+  if (context.config->editable)
+    translate<true>(in, out, context);
+  else
+    translate<false>(in, out, context);
+}
+
+void DocumentTranslator::ir(const pugi::xml_node &in, Context &context,
+                            common::IrDocument &out) {
+  common::XmlTraversal::traverse<IrState>(
+      in, [&](IrFrame &frame) { return IrEnter(frame, out, context); },
+      [&](IrFrame &frame) { return IrLeave(frame, out); });
 }
 
 } // namespace ooxml
@@ -5,13 +5,16 @@
 #include <odr/Exception.h>
 #include <odr/Meta.h>
 #include <pugixml.hpp>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 
 namespace odr {
 namespace ooxml {
 
 FileMeta Meta::parseFileMeta(access::ReadStorage &storage) {
-  static const std::unordered_map<access::Path, FileType> TYPES = {
+  // probed in order; views so that nothing is allocated
+  static constexpr std::pair<access::PathView, FileType> TYPES[] = {
       {"word/document.xml", FileType::OFFICE_OPEN_XML_DOCUMENT},
       {"ppt/presentation.xml", FileType::OFFICE_OPEN_XML_PRESENTATION},
       {"xl/workbook.xml", FileType::OFFICE_OPEN_XML_WORKBOOK},
@@ -20,16 +23,36 @@ FileMeta Meta::parseFileMeta(access::ReadStorage &storage) {
   FileMeta result;
   result.confident = true;
 
-  if (storage.isFile("EncryptionInfo") && storage.isFile("EncryptedPackage")) {
+  // the content types come first in a package, so a streamed package is
+  // typed without waiting for the rest. the probes below would read a stream
+  // to its end for every member which is missing
+  if (storage.isFile("[Content_Types].xml")) {
+    const auto types = common::XmlUtil::parse(storage, "[Content_Types].xml");
+    for (auto &&o : types.child("Types").children("Override")) {
+      std::string_view part = o.attribute("PartName").as_string();
+      if (!part.empty() && part.front() == '/')
+        part.remove_prefix(1);
+      for (auto &&t : TYPES) {
+        if (t.first.string() == part)
+          result.type = t.second;
+      }
+      if (result.type != FileType::UNKNOWN)
+        break;
+    }
+  } else if (storage.isFile("EncryptionInfo") &&
+             storage.isFile("EncryptedPackage")) {
+    // encrypted packages live in a compound file, which has no content types
     result.type = FileType::OFFICE_OPEN_XML_ENCRYPTED;
     result.encrypted = true;
     return result;
   }
 
-  for (auto &&t : TYPES) {
-    if (storage.isFile(t.first)) {
-      result.type = t.second;
-      break;
+  if (result.type == FileType::UNKNOWN) {
+    for (auto &&t : TYPES) {
+      if (storage.isFile(t.first)) {
+        result.type = t.second;
+        break;
+      }
     }
   }
 
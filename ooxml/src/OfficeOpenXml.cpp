@@ -4,31 +4,55 @@
 #include <Meta.h>
 #include <PresentationTranslator.h>
 #include <WorkbookTranslator.h>
+#include <algorithm>
+#include <access/AsyncStream.h>
+#include <access/CachingStorage.h>
 #include <access/CfbStorage.h>
+#include <access/GzipStream.h>
 #include <access/Path.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
 #include <access/ZipStorage.h>
+#include <common/Cost.h>
+#include <common/Fingerprint.h>
 #include <common/Html.h>
+#include <common/IrCache.h>
+#include <common/IrDocument.h>
+#include <common/IrRenderer.h>
 #include <common/XmlUtil.h>
 #include <fstream>
 #include <odr/Config.h>
 #include <odr/Exception.h>
 #include <odr/Meta.h>
 #include <ooxml/OfficeOpenXml.h>
+#include <optional>
 #include <pugixml.hpp>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace odr {
 namespace ooxml {
 
 namespace {
-void generateStyle_(std::ofstream &out, Context &context) {
+// members like the styles and repeated images are read more than once
+std::unique_ptr<access::ReadStorage>
+cache(std::unique_ptr<access::ReadStorage> storage) {
+  return std::make_unique<access::CachingStorage>(std::move(storage));
+}
+
+// keeps the parsed styles in `styles`; only records dependencies for styles
+// which can be pruned if `context.referencedStyles` is set
+void generateStyle_(std::ostream &out, pugi::xml_document &styles,
+                    Context &context) {
+  const access::Trace::Span span("style");
   // default css
   out << common::Html::odfDefaultStyle();
 
   switch (context.meta->type) {
   case FileType::OFFICE_OPEN_XML_DOCUMENT: {
-    const auto styles =
-        common::XmlUtil::parse(*context.storage, "word/styles.xml");
+    styles = common::XmlUtil::parse(*context.storage, "word/styles.xml");
     DocumentTranslator::css(styles.document_element(), context);
   } break;
   case FileType::OFFICE_OPEN_XML_PRESENTATION: {
@@ -49,20 +73,109 @@ void generateStyle_(std::ofstream &out, Context &context) {
     out << "}";
   } break;
   case FileType::OFFICE_OPEN_XML_WORKBOOK: {
-    const auto styles =
-        common::XmlUtil::parse(*context.storage, "xl/styles.xml");
-    WorkbookTranslator::css(styles.document_element(), context);
+    styles = common::XmlUtil::parse(*context.storage, "xl/styles.xml");
+    if (context.referencedStyles != nullptr)
+      WorkbookTranslator::dependencies(styles.document_element(), context);
+    else
+      WorkbookTranslator::css(styles.document_element(), context);
   } break;
   default:
     throw std::invalid_argument("file.getMeta().type");
   }
 }
 
-void generateScript_(std::ofstream &out, Context &) {
+// writes css for the referenced styles and everything they depend on
+void generateReferencedStyle_(const pugi::xml_document &styles,
+                              const std::unordered_set<std::string> &referenced,
+                              Context &context) {
+  const access::Trace::Span span("style");
+  std::unordered_set<std::string> names;
+  std::vector<std::string> pending(referenced.begin(), referenced.end());
+  while (!pending.empty()) {
+    std::string name = std::move(pending.back());
+    pending.pop_back();
+    if (!names.insert(name).second)
+      continue;
+    const auto it = context.styleDependencies.find(name);
+    if (it == context.styleDependencies.end())
+      continue;
+    pending.insert(pending.end(), it->second.begin(), it->second.end());
+  }
+
+  switch (context.meta->type) {
+  case FileType::OFFICE_OPEN_XML_WORKBOOK:
+    WorkbookTranslator::css(styles.document_element(), names, context);
+    break;
+  default:
+    break;
+  }
+}
+
+void generateScript_(std::ostream &out, Context &) {
   out << common::Html::defaultScript();
 }
 
-void generateContent_(Context &context) {
+// looks up the part of each slide or sheet once so that entries outside of
+// the requested range are never parsed
+void generateEntries_(Context &context) {
+  if (!context.entries.empty())
+    return;
+
+  access::Path root;
+  access::Path path;
+  const char *query;
+  switch (context.meta->type) {
+  case FileType::OFFICE_OPEN_XML_PRESENTATION:
+    root = "ppt";
+    path = "ppt/presentation.xml";
+    query = "//p:sldId";
+    break;
+  case FileType::OFFICE_OPEN_XML_WORKBOOK:
+    root = "xl";
+    path = "xl/workbook.xml";
+    query = "//sheet";
+    break;
+  default:
+    return;
+  }
+
+  const auto document = common::XmlUtil::parse(*context.storage, path);
+  const auto relations = Meta::parseRelationships(*context.storage, path);
+
+  for (auto &&e : document.select_nodes(query)) {
+    const std::string rId = e.node().attribute("r:id").as_string();
+
+    Entry &entry = context.entries.emplace_back();
+    entry.name = e.node().attribute("name").as_string();
+    entry.path = root.join(relations.at(rId));
+    if (!entry.name.empty())
+      context.entryIndex.emplace(entry.name, context.entries.size() - 1);
+  }
+}
+
+// selected entries as [begin, end); everything if lowering to `ir`
+std::pair<std::uint32_t, std::uint32_t>
+entryRange_(const Context &context, const common::IrDocument *ir) {
+  const std::uint32_t size = context.entries.size();
+  if (ir != nullptr)
+    return {0, size};
+  if (!context.config->sheetName.empty() &&
+      (context.meta->type == FileType::OFFICE_OPEN_XML_WORKBOOK)) {
+    const auto it = context.entryIndex.find(context.config->sheetName);
+    if (it == context.entryIndex.end())
+      return {0, 0};
+    return {it->second, it->second + 1};
+  }
+  const std::uint32_t begin = std::min(context.config->entryOffset, size);
+  std::uint32_t end = size;
+  if ((context.config->entryCount > 0) &&
+      (context.config->entryCount < end - begin))
+    end = begin + context.config->entryCount;
+  return {begin, end};
+}
+
+// lowers the whole document into `ir` if given instead of translating to html
+void generateContent_(Context &context, common::IrDocument *ir = nullptr) {
   context.entry = 0;
 
   switch (context.meta->type) {
@@ -73,43 +186,35 @@ void generateContent_(Context &context) {
         Meta::parseRelationships(*context.storage, "word/document.xml");
 
     const auto body = content.child("w:document").child("w:body");
-    DocumentTranslator::html(body, context);
+    const access::Trace::Span span("entry", "word/document.xml", 0);
+    if (ir != nullptr)
+      DocumentTranslator::ir(body, context, *ir);
+    else
+      DocumentTranslator::html(body, context);
   } break;
   case FileType::OFFICE_OPEN_XML_PRESENTATION: {
-    const auto ppt =
-        common::XmlUtil::parse(*context.storage, "ppt/presentation.xml");
-    const auto pptRelations =
-        Meta::parseRelationships(*context.storage, "ppt/presentation.xml");
-
-    for (auto &&e : ppt.select_nodes("//p:sldId")) {
-      const std::string rId = e.node().attribute("r:id").as_string();
+    generateEntries_(context);
+    const auto [begin, end] = entryRange_(context, ir);
 
-      const auto path = access::Path("ppt").join(pptRelations.at(rId));
+    for (context.entry = begin; context.entry < end; ++context.entry) {
+      const auto &path = context.entries[context.entry].path;
+      const access::Trace::Span span("entry", path.string(), context.entry);
       const auto content = common::XmlUtil::parse(*context.storage, path);
       context.relations = Meta::parseRelationships(*context.storage, path);
 
-      if ((context.config->entryOffset > 0) ||
-          (context.config->entryCount > 0)) {
-        if ((context.entry >= context.config->entryOffset) &&
-            (context.entry <
-             context.config->entryOffset + context.config->entryCount)) {
-          PresentationTranslator::html(content, context);
-        }
-      } else {
+      if (ir != nullptr)
+        PresentationTranslator::ir(content, context, *ir);
+      else
         PresentationTranslator::html(content, context);
-      }
-
-      ++context.entry;
     }
   } break;
   case FileType::OFFICE_OPEN_XML_WORKBOOK: {
-    const auto xls =
-        common::XmlUtil::parse(*context.storage, "xl/workbook.xml");
-    const auto xlsRelations =
-        Meta::parseRelationships(*context.storage, "xl/workbook.xml");
+    generateEntries_(context);
+    const auto [begin, end] = entryRange_(context, ir);
 
     // TODO this breaks back translation
-    if (context.storage->isFile("xl/sharedStrings.xml")) {
+    if (context.sharedStrings.empty() &&
+        context.storage->isFile("xl/sharedStrings.xml")) {
       context.sharedStringsDocument =
           common::XmlUtil::parse(*context.storage, "xl/sharedStrings.xml");
       for (auto &&e : context.sharedStringsDocument.select_nodes("//si")) {
@@ -117,25 +222,16 @@ void generateContent_(Context &context) {
       }
     }
 
-    for (auto &&e : xls.select_nodes("//sheet")) {
-      const std::string rId = e.node().attribute("r:id").as_string();
-
-      const auto path = access::Path("xl").join(xlsRelations.at(rId));
+    for (context.entry = begin; context.entry < end; ++context.entry) {
+      const auto &path = context.entries[context.entry].path;
+      const access::Trace::Span span("entry", path.string(), context.entry);
       const auto content = common::XmlUtil::parse(*context.storage, path);
       context.relations = Meta::parseRelationships(*context.storage, path);
 
-      if ((context.config->entryOffset > 0) ||
-          (context.config->entryCount > 0)) {
-        if ((context.entry >= context.config->entryOffset) &&
-            (context.entry <
-             context.config->entryOffset + context.config->entryCount)) {
-          WorkbookTranslator::html(content, context);
-        }
-      } else {
+      if (ir != nullptr)
+        WorkbookTranslator::ir(content, context, *ir);
+      else
         WorkbookTranslator::html(content, context);
-      }
-
-      ++context.entry;
     }
   } break;
   default:
@@ -150,18 +246,16 @@ public:
 
   explicit Impl(const std::string &path) : Impl(access::Path(path)) {}
 
-  explicit Impl(const access::Path &path)
-      : Impl(
-            std::unique_ptr<access::ReadStorage>(new access::ZipReader(path))) {
+  explicit Impl(const access::Path &path) {
     try {
-      storage_ = std::make_unique<access::ZipReader>(path);
+      storage_ = cache(std::make_unique<access::ZipReader>(path));
       meta_ = Meta::parseFileMeta(*storage_);
       return;
     } catch (access::NoZipFileException &) {
     }
 
     try {
-      storage_ = std::make_unique<access::CfbReader>(path);
+      storage_ = cache(std::make_unique<access::CfbReader>(path));
       meta_ = Meta::parseFileMeta(*storage_);
       return;
     } catch (access::NoCfbFileException &) {
@@ -170,14 +264,20 @@ public:
     throw UnknownFileType();
   }
 
-  explicit Impl(std::unique_ptr<access::ReadStorage> &&storage) {
-    meta_ = Meta::parseFileMeta(*storage);
-    storage_ = std::move(storage);
-  }
+  explicit Impl(std::unique_ptr<access::ReadStorage> &&storage)
+      : Impl(storage) {}
 
+  // the meta is read through the cache, so translation does not read it
+  // again. on failure the storage is handed back for the next probe
   explicit Impl(std::unique_ptr<access::ReadStorage> &storage) {
-    meta_ = Meta::parseFileMeta(*storage);
-    storage_ = std::move(storage);
+    auto cached = std::make_unique<access::CachingStorage>(std::move(storage));
+    try {
+      meta_ = Meta::parseFileMeta(*cached);
+    } catch (...) {
+      storage = cached->release();
+      throw;
+    }
+    storage_ = std::move(cached);
   }
 
   FileType type() const noexcept { return meta_.type; }
@@ -190,6 +290,10 @@ public:
 
   bool decrypted() const noexcept { return decrypted_; }
 
+  std::vector<Diagnostic> diagnostics() const {
+    return context_.diagnostics.summary();
+  }
+
   bool translatable() const noexcept { return true; }
 
   bool editable() const noexcept { return false; }
@@ -199,6 +303,7 @@ public:
   bool decrypt(const std::string &password) {
     // TODO throw if not encrypted
     // TODO throw if decrypted
+    const access::Trace::Span span("decrypt");
     const std::string encryptionInfo =
         access::StreamUtil::read(*storage_->read("EncryptionInfo"));
     // TODO cache Crypto::Util
@@ -209,7 +314,8 @@ public:
     const std::string encryptedPackage =
         access::StreamUtil::read(*storage_->read("EncryptedPackage"));
     const std::string decryptedPackage = util.decrypt(encryptedPackage, key);
-    storage_ = std::make_unique<access::ZipReader>(decryptedPackage, false);
+    storage_ =
+        cache(std::make_unique<access::ZipReader>(decryptedPackage, false));
     meta_ = Meta::parseFileMeta(*storage_);
     decrypted_ = true;
     return true;
@@ -217,24 +323,88 @@ public:
 
   bool translate(const access::Path &path, const Config &config) {
     // TODO throw if not decrypted
-    std::ofstream out(path);
-    if (!out.is_open())
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
       return false;
+    // finished explicitly, so that write failures are reported
+    std::optional<access::GzipOstream> gzip;
+    if (config.gzip)
+      gzip.emplace(file, config.gzipLevel);
+    std::ostream &sink = gzip ? static_cast<std::ostream &>(*gzip) : file;
+    // compression and writing run on their own thread; finished first
+    std::optional<access::AsyncOstream> async;
+    if (config.pipeline)
+      async.emplace(sink);
+    std::ostream &out = async ? static_cast<std::ostream &>(*async) : sink;
+    // the writer first, then the deflate stream, then the file; a failure of
+    // any of them leaves the output truncated
+    const auto finish = [&] {
+      if (async)
+        async->finish();
+      if (gzip)
+        gzip->finish();
+      file.close();
+      return !(async && async->fail()) && !(gzip && gzip->fail()) &&
+             !file.fail();
+    };
     context_.config = &config;
     context_.meta = &meta_;
     context_.storage = storage_.get();
     context_.output = &out;
+    context_.diagnostics.clear();
+
+    if (config.format != TranslationFormat::HTML) {
+      // the representation covers the whole document and is built only once
+      if (ir_.empty()) {
+        // decrypted content stays off disk
+        const bool cache = !config.irCache.empty() && !decrypted_;
+        if (!cache ||
+            !common::IrCache::load(config.irCache, *storage_, ir_)) {
+          generateContent_(context_, &ir_);
+          if (cache)
+            common::IrCache::store(config.irCache, *storage_, ir_);
+        }
+      }
+      if (config.format == TranslationFormat::TEXT)
+        common::IrRenderer::text(ir_, config, out);
+      else
+        common::IrRenderer::json(ir_, config, out);
+      context_.config = nullptr;
+      context_.output = nullptr;
+      return finish();
+    }
 
     out << common::Html::doctype();
     out << "<html><head>";
     out << common::Html::defaultHeaders();
+    // only spreadsheet styles are pruned; their css follows the content once
+    // the referenced styles are known
+    const bool pruneStyles = config.pruneStyles &&
+                             (meta_.type == FileType::OFFICE_OPEN_XML_WORKBOOK);
+    std::unordered_set<std::string> referencedStyles;
+    context_.styleDependencies.clear();
+    context_.inlineStyles.clear();
+    if (pruneStyles)
+      context_.referencedStyles = &referencedStyles;
+
     out << "<style>";
-    generateStyle_(out, context_);
+    generateStyle_(out, style_, context_);
     out << "</style>";
     out << "</head>";
 
     out << "<body " << common::Html::bodyAttributes(config) << ">";
     generateContent_(context_);
+    if (!context_.inlineStyles.empty()) {
+      out << "<style>";
+      context_.inlineStyles.css(out);
+      out << "</style>";
+    }
+    if (pruneStyles) {
+      context_.referencedStyles = nullptr;
+      out << "<style>";
+      generateReferencedStyle_(style_, referencedStyles, context_);
+      out << "</style>";
+    }
     out << "</body>";
 
     out << "<script>";
@@ -244,12 +414,13 @@ public:
 
     context_.config = nullptr;
     context_.output = nullptr;
-    out.close();
-    return true;
+    return finish();
   }
 
   bool edit(const std::string &) { return false; }
 
+  std::string retranslate() { return "{}"; }
+
   bool save(const access::Path &) const { return false; }
 
   bool save(const access::Path &, const std::string &) const { return false; }
@@ -264,6 +435,7 @@ private:
   Context context_;
   pugi::xml_document style_;
   pugi::xml_document content_;
+  common::IrDocument ir_;
 };
 
 OfficeOpenXml::OfficeOpenXml(const char *path)
@@ -293,6 +465,20 @@ const access::ReadStorage &OfficeOpenXml::storage() const noexcept {
   return impl_->storage();
 }
 
+DocumentCost OfficeOpenXml::estimateCost() const {
+  return common::Cost::estimate(impl_->storage(), impl_->meta());
+}
+
+std::string OfficeOpenXml::fingerprint(const bool content) const {
+  if (content)
+    return common::Fingerprint::content(impl_->storage());
+  return common::Fingerprint::directory(impl_->storage());
+}
+
+std::vector<Diagnostic> OfficeOpenXml::diagnostics() const {
+  return impl_->diagnostics();
+}
+
 bool OfficeOpenXml::decrypted() const noexcept { return impl_->decrypted(); }
 
 bool OfficeOpenXml::translatable() const noexcept {
@@ -309,12 +495,14 @@ bool OfficeOpenXml::decrypt(const std::string &password) {
   return impl_->decrypt(password);
 }
 
-void OfficeOpenXml::translate(const access::Path &path, const Config &config) {
-  impl_->translate(path, config);
+bool OfficeOpenXml::translate(const access::Path &path, const Config &config) {
+  return impl_->translate(path, config);
 }
 
 void OfficeOpenXml::edit(const std::string &diff) { impl_->edit(diff); }
 
+std::string OfficeOpenXml::retranslate() { return impl_->retranslate(); }
+
 void OfficeOpenXml::save(const access::Path &path) const { impl_->save(path); }
 
 void OfficeOpenXml::save(const access::Path &path,
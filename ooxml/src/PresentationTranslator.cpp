@@ -3,13 +3,18 @@
 #include <access/Path.h>
 #include <access/Storage.h>
 #include <access/StreamUtil.h>
+#include <access/Trace.h>
+#include <algorithm>
+#include <common/IrDocument.h>
 #include <common/StringUtil.h>
+#include <common/XmlTraversal.h>
 #include <crypto/CryptoUtil.h>
 #include <cstring>
-#include <glog/logging.h>
 #include <odr/Config.h>
 #include <pugixml.hpp>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -139,6 +144,7 @@ void DefaultPropertyTransaltor(const pugi::xml_node &in, std::ostream &out,
 void PresentationTranslator::css(const pugi::xml_node &, Context &) {}
 
 namespace {
+template <bool Editable>
 void TextTranslator(const pugi::xml_text &in, std::ostream &out,
                     Context &context) {
   std::string text = in.as_string();
@@ -146,12 +152,15 @@ void TextTranslator(const pugi::xml_text &in, std::ostream &out,
   common::StringUtil::findAndReplaceAll(text, "<", "&lt;");
   common::StringUtil::findAndReplaceAll(text, ">", "&gt;");
 
-  if (!context.config->editable) {
+  if constexpr (!Editable) {
     out << text;
   } else {
+    // without blocks to count markers in, each text carries its own index
     out << R"(<span contenteditable="true" data-odr-cid=")"
         << context.currentTextTranslationIndex << "\">" << text << "</span>";
-    context.textTranslation[context.currentTextTranslationIndex] = &in;
+    if (context.currentTextTranslationIndex >= context.textTranslation.size())
+      context.textTranslation.resize(context.currentTextTranslationIndex + 1);
+    context.textTranslation[context.currentTextTranslationIndex] = in;
     ++context.currentTextTranslationIndex;
   }
 }
@@ -169,24 +178,25 @@ void StyleAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
   if ((pPr && pPr.first_child()) || (rPr && rPr.first_child()) ||
       (spPr && spPr.first_child()) || (tcPr && tcPr.first_child()) ||
       (endParaRPr && endParaRPr.first_child()) || xfrmPr || wAttr || hAttr) {
-    out << " style=\"";
+    std::ostringstream declarations;
     if (pPr)
-      DefaultPropertyTransaltor(pPr, out, context);
+      DefaultPropertyTransaltor(pPr, declarations, context);
     if (rPr)
-      DefaultPropertyTransaltor(rPr, out, context);
+      DefaultPropertyTransaltor(rPr, declarations, context);
     if (spPr)
-      DefaultPropertyTransaltor(spPr, out, context);
+      DefaultPropertyTransaltor(spPr, declarations, context);
     if (tcPr)
-      TableCellPropertyTranslator(tcPr, out, context);
+      TableCellPropertyTranslator(tcPr, declarations, context);
     if (endParaRPr)
-      DefaultPropertyTransaltor(endParaRPr, out, context);
+      DefaultPropertyTransaltor(endParaRPr, declarations, context);
     if (xfrmPr)
-      XfrmTranslator(xfrmPr, out, context);
+      XfrmTranslator(xfrmPr, declarations, context);
     if (wAttr)
-      out << "width:" << (wAttr.as_float() / 914400.0f) << "in;";
+      declarations << "width:" << (wAttr.as_float() / 914400.0f) << "in;";
     if (hAttr)
-      out << "height:" << (hAttr.as_float() / 914400.0f) << "in;";
-    out << "\"";
+      declarations << "height:" << (hAttr.as_float() / 914400.0f) << "in;";
+    if (const std::string d = declarations.str(); !d.empty())
+      out << " class=\"" << context.inlineStyles.intern(d) << "\"";
   }
 }
 
@@ -195,13 +205,27 @@ void ElementAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
   StyleAttributeTranslator(in, out, context);
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context);
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context);
+struct ElementTranslator;
+
+struct ElementState {
+  const ElementTranslator *translator{nullptr};
+  bool link{false};
+};
+
+typedef common::XmlTraversal::Frame<ElementState> Frame;
+
+struct ElementTranslator {
+  // writes the opening part; returns false to skip the element entirely
+  bool (*enter)(Frame &, std::ostream &, Context &);
+  // writes the closing part; returns true to repeat the element
+  bool (*leave)(Frame &, std::ostream &, Context &);
+};
+
+bool NoLeave(Frame &, std::ostream &, Context &) { return false; }
+
+bool ParagraphEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
 
-void ParagraphTranslator(const pugi::xml_node &in, std::ostream &out,
-                         Context &context) {
   out << "<p";
   ElementAttributeTranslator(in, out, context);
   out << ">";
@@ -236,65 +260,82 @@ void ParagraphTranslator(const pugi::xml_node &in, std::ostream &out,
     }
   }
 
-  if (empty)
+  if (empty) {
     out << "<br/>";
-  else
-    ElementChildrenTranslator(in, out, context);
+    frame.next = {};
+  }
+
+  return true;
+}
 
+bool ParagraphLeave(Frame &, std::ostream &out, Context &) {
   out << "</p>";
+  return false;
 }
 
-void SpanTranslator(const pugi::xml_node &in, std::ostream &out,
-                    Context &context) {
-  bool link = false;
+bool SpanEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   const auto hlinkClick = in.child("a:rPr").child("a:hlinkClick");
   if (hlinkClick && hlinkClick.attribute("r:id")) {
     const auto rIdAttr = hlinkClick.attribute("r:id");
     const std::string href = context.relations[rIdAttr.as_string()];
-    link = true;
+    frame.state.link = true;
     out << "<a href=\"" << href << "\">";
   }
 
   out << "<span";
   ElementAttributeTranslator(in, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool SpanLeave(Frame &frame, std::ostream &out, Context &) {
   out << "</span>";
 
-  if (link)
+  if (frame.state.link)
     out << "</a>";
+  return false;
 }
 
-void SlideTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+bool SlideEnter(Frame &, std::ostream &out, Context &) {
   out << "<div class=\"slide\">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool SlideLeave(Frame &, std::ostream &out, Context &) {
   out << "</div>";
+  return false;
 }
 
-void TableTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+bool TableEnter(Frame &frame, std::ostream &out, Context &context) {
   out << R"(<table border="0" cellspacing="0" cellpadding="0")";
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator(frame.node, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
+  return true;
+}
+
+bool TableLeave(Frame &, std::ostream &out, Context &) {
   out << "</table>";
+  return false;
 }
 
 // TODO duplicated in document translation
-void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+bool ImageEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
+
   out << "<img";
   ElementAttributeTranslator(in, out, context);
 
   const auto ref = in.child("p:blipFill").child("a:blip");
   if (!ref || !ref.attribute("r:embed")) {
     out << " alt=\"Error: image path not specified";
-    LOG(ERROR) << "image href not found";
+    context.diagnostics.report("image without href");
   } else {
     const auto rIdAttr = ref.attribute("r:embed");
     const auto path =
         access::Path("ppt/slides").join(context.relations[rIdAttr.as_string()]);
+    const access::Trace::Span span("image", path.string());
     out << " alt=\"Error: image not found or unsupported: " << path << "\"";
     out << " src=\"";
     std::string image = access::StreamUtil::read(*context.storage->read(path));
@@ -305,21 +346,27 @@ void ImageTranslator(const pugi::xml_node &in, std::ostream &out,
   }
 
   out << "></img>";
+  frame.next = {};
+  return true;
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context) {
-  for (auto &&n : in) {
-    if (n.type() == pugi::node_pcdata)
-      TextTranslator(n.text(), out, context);
-    else if (n.type() == pugi::node_element)
-      ElementTranslator(n, out, context);
-  }
-}
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context);
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &context);
+
+bool ChildrenEnter(Frame &, std::ostream &, Context &) { return true; }
 
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
+constexpr ElementTranslator paragraphTranslator{ParagraphEnter,
+                                                ParagraphLeave};
+constexpr ElementTranslator spanTranslator{SpanEnter, SpanLeave};
+constexpr ElementTranslator slideTranslator{SlideEnter, SlideLeave};
+constexpr ElementTranslator tableTranslator{TableEnter, TableLeave};
+constexpr ElementTranslator imageTranslator{ImageEnter, NoLeave};
+constexpr ElementTranslator substitutionTranslator{SubstitutionEnter,
+                                                   SubstitutionLeave};
+constexpr ElementTranslator childrenTranslator{ChildrenEnter, NoLeave};
+
+const char *substitution(const std::string_view element) {
+  static const std::unordered_map<std::string_view, const char *> substitution{
       {"p:sp", "div"},
       {"p:graphicFrame", "div"},
       {"a:tblGrid", "colgroup"},
@@ -327,39 +374,169 @@ void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
       {"a:tr", "tr"},
       {"a:tc", "td"},
   };
-  static std::unordered_set<std::string> skippers{};
 
-  const std::string element = in.name();
+  const auto it = substitution.find(element);
+  if (it == substitution.end())
+    return nullptr;
+  return it->second;
+}
+
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context) {
+  out << "<" << substitution(frame.node.name());
+  ElementAttributeTranslator(frame.node, out, context);
+  out << ">";
+  return true;
+}
+
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &) {
+  out << "</" << substitution(frame.node.name()) << ">";
+  return false;
+}
+
+const ElementTranslator *lookupElementTranslator(const pugi::xml_node &in) {
+  static const std::unordered_set<std::string_view> skippers{};
+
+  const std::string_view element = in.name();
   if (skippers.find(element) != skippers.end())
-    return;
+    return nullptr;
 
   if (element == "a:p")
-    ParagraphTranslator(in, out, context);
+    return &paragraphTranslator;
   else if (element == "a:r")
-    SpanTranslator(in, out, context);
+    return &spanTranslator;
   else if (element == "p:cSld")
-    SlideTranslator(in, out, context);
+    return &slideTranslator;
   else if (element == "a:tbl")
-    TableTranslator(in, out, context);
+    return &tableTranslator;
   else if (element == "p:pic")
-    ImageTranslator(in, out, context);
-  else {
-    const auto it = substitution.find(element);
-    if (it != substitution.end()) {
-      out << "<" << it->second;
-      ElementAttributeTranslator(in, out, context);
-      out << ">";
-    }
-    ElementChildrenTranslator(in, out, context);
-    if (it != substitution.end()) {
-      out << "</" << it->second << ">";
+    return &imageTranslator;
+  else if (substitution(element) != nullptr)
+    return &substitutionTranslator;
+  return &childrenTranslator;
+}
+
+template <bool Editable>
+bool NodeEnter(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.node.type() == pugi::node_pcdata) {
+    TextTranslator<Editable>(frame.node.text(), out, context);
+    frame.next = {};
+    return true;
+  }
+  if (frame.node.type() != pugi::node_element)
+    return false;
+
+  if (frame.state.translator == nullptr) {
+    frame.state.translator = lookupElementTranslator(frame.node);
+    if (frame.state.translator == nullptr)
+      return false;
+  }
+  return frame.state.translator->enter(frame, out, context);
+}
+
+bool NodeLeave(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.state.translator == nullptr)
+    return false;
+  return frame.state.translator->leave(frame, out, context);
+}
+
+struct IrState {
+  // number of opened nodes to close on leave
+  std::uint32_t open{0};
+};
+
+typedef common::XmlTraversal::Frame<IrState> IrFrame;
+
+bool IrEnter(IrFrame &frame, common::IrDocument &out, Context &context) {
+  const pugi::xml_node &in = frame.node;
+  if (in.type() == pugi::node_pcdata) {
+    out.appendText(in.value());
+    return false;
+  }
+  if (in.type() != pugi::node_element)
+    return false;
+
+  const std::string_view element = in.name();
+  // properties carry no content
+  if (common::StringUtil::endsWith(element, "Pr"))
+    return false;
+
+  if (element == "p:cSld") {
+    const std::uint32_t index = out.open(common::IrType::PAGE);
+    ++frame.state.open;
+    out.setText(index, in.attribute("name").as_string());
+  } else if ((element == "p:sp") || (element == "p:graphicFrame")) {
+    out.open(common::IrType::FRAME);
+    ++frame.state.open;
+  } else if (element == "a:p") {
+    out.open(common::IrType::PARAGRAPH);
+    ++frame.state.open;
+  } else if (element == "a:r") {
+    const auto rIdAttr =
+        in.child("a:rPr").child("a:hlinkClick").attribute("r:id");
+    if (rIdAttr) {
+      const std::uint32_t index = out.open(common::IrType::LINK);
+      ++frame.state.open;
+      out.setText(index, context.relations[rIdAttr.as_string()]);
     }
+    out.open(common::IrType::SPAN);
+    ++frame.state.open;
+  } else if (element == "a:br") {
+    out.leaf(common::IrType::LINE_BREAK);
+    frame.next = {};
+  } else if (element == "a:tbl") {
+    out.open(common::IrType::TABLE);
+    ++frame.state.open;
+  } else if (element == "a:gridCol") {
+    out.leaf(common::IrType::TABLE_COLUMN);
+    frame.next = {};
+  } else if (element == "a:tr") {
+    out.open(common::IrType::TABLE_ROW);
+    ++frame.state.open;
+  } else if (element == "a:tc") {
+    const std::uint32_t index = out.open(common::IrType::TABLE_CELL);
+    ++frame.state.open;
+    out.setSpan(index, std::max(1u, in.attribute("gridSpan").as_uint(1)),
+                std::max(1u, in.attribute("rowSpan").as_uint(1)));
+  } else if (element == "p:pic") {
+    const std::uint32_t index = out.leaf(common::IrType::IMAGE);
+    const auto ref = in.child("p:blipFill").child("a:blip");
+    if (const auto rIdAttr = ref.attribute("r:embed"); rIdAttr)
+      out.setText(index, access::Path("ppt/slides")
+                             .join(context.relations[rIdAttr.as_string()])
+                             .string());
+    frame.next = {};
   }
+  return true;
+}
+
+bool IrLeave(IrFrame &frame, common::IrDocument &out) {
+  for (std::uint32_t i = 0; i < frame.state.open; ++i)
+    out.close();
+  return false;
+}
+
+template <bool Editable>
+void translate(const pugi::xml_node &in, std::ostream &out, Context &context) {
+  common::XmlTraversal::traverse<ElementState>(
+      in,
+      [&](Frame &frame) { return NodeEnter<Editable>(frame, out, context); },
+      [&](Frame &frame) { return NodeLeave(frame, out, context); });
 }
 } // namespace
 
 void PresentationTranslator::html(const pugi::xml_node &in, Context &context) {
-  ElementTranslator(in, *context.output, context);
+  std::ostream &out = *context.output;
+  if (context.config->editable)
+    translate<true>(in, out, context);
+  else
+    translate<false>(in, out, context);
+}
+
+void PresentationTranslator::ir(const pugi::xml_node &in, Context &context,
+                                common::IrDocument &out) {
+  common::XmlTraversal::traverse<IrState>(
+      in, [&](IrFrame &frame) { return IrEnter(frame, out, context); },
+      [&](IrFrame &frame) { return IrLeave(frame, out); });
 }
 
 } // namespace ooxml
@@ -8,6 +8,10 @@ class xml_node;
 }
 
 namespace odr {
+namespace common {
+class IrDocument;
+}
+
 namespace ooxml {
 
 struct Context;
@@ -15,6 +19,7 @@ struct Context;
 namespace PresentationTranslator {
 void css(const pugi::xml_node &in, Context &context);
 void html(const pugi::xml_node &in, Context &context);
+void ir(const pugi::xml_node &in, Context &context, common::IrDocument &out);
 } // namespace PresentationTranslator
 
 } // namespace ooxml
@@ -2,14 +2,18 @@
 #include <WorkbookTranslator.h>
 #include <access/Storage.h>
 #include <access/StreamUtil.h>
+#include <algorithm>
+#include <common/IrDocument.h>
 #include <common/StringUtil.h>
+#include <common/TablePosition.h>
+#include <common/XmlTraversal.h>
 #include <common/XmlUtil.h>
 #include <cstring>
-#include <glog/logging.h>
 #include <odr/Config.h>
 #include <odr/Meta.h>
 #include <pugixml.hpp>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -17,10 +21,20 @@ namespace odr {
 namespace ooxml {
 
 namespace {
-void FontsTranslator(const pugi::xml_node &in, std::ostream &out, Context &) {
+// whether css is written for the style; all styles if `names` is not set
+bool StyleSelected(const std::string &name,
+                   const std::unordered_set<std::string> *names) {
+  return (names == nullptr) || (names->find(name) != names->end());
+}
+
+void FontsTranslator(const pugi::xml_node &in, std::ostream &out,
+                     const std::unordered_set<std::string> *names, Context &) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
-    out << ".font-" << i << " {";
+    const std::string style = "font-" + std::to_string(i++);
+    if (!StyleSelected(style, names))
+      continue;
+    out << "." << style << " {";
 
     if (const auto name = e.child("name"); name)
       out << "font-family: " << name.attribute("val").as_string() << ";";
@@ -38,15 +52,17 @@ void FontsTranslator(const pugi::xml_node &in, std::ostream &out, Context &) {
     // <vertAlign val="superscript" />
 
     out << "} ";
-
-    ++i;
   }
 }
 
-void FillsTranslator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void FillsTranslator(const pugi::xml_node &in, std::ostream &out,
+                     const std::unordered_set<std::string> *names, Context &) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
-    out << ".fill-" << i << " {";
+    const std::string style = "fill-" + std::to_string(i++);
+    if (!StyleSelected(style, names))
+      continue;
+    out << "." << style << " {";
 
     if (const auto patternFill = e.child("patternFill"); patternFill) {
       if (const auto bgColor = patternFill.child("bgColor"); bgColor)
@@ -56,52 +72,64 @@ void FillsTranslator(const pugi::xml_node &in, std::ostream &out, Context &) {
     }
 
     out << "} ";
-
-    ++i;
   }
 }
 
-void BordersTranslator(const pugi::xml_node &in, std::ostream &out, Context &) {
+void BordersTranslator(const pugi::xml_node &in, std::ostream &out,
+                       const std::unordered_set<std::string> *names,
+                       Context &) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
-    out << ".border-" << i << " {";
+    const std::string style = "border-" + std::to_string(i++);
+    if (!StyleSelected(style, names))
+      continue;
+    out << "." << style << " {";
     // TODO
     out << "} ";
-
-    ++i;
   }
 }
 
-void CellXfsTranslator(const pugi::xml_node &in, std::ostream &out,
+void CellXfDependencyTranslator(const pugi::xml_node &e,
+                                const std::string &name, Context &context) {
+  if (const auto applyFont = e.attribute("applyFont");
+      applyFont && (std::strcmp(applyFont.as_string(), "true") == 0 ||
+                    std::strcmp(applyFont.as_string(), "1") == 0))
+    context.styleDependencies[name].push_back(
+        std::string("font-") + e.attribute("fontId").as_string());
+
+  if (const auto fillId = e.attribute("fillId"); fillId)
+    context.styleDependencies[name].push_back(std::string("fill-") +
+                                              fillId.as_string());
+
+  if (const auto applyBorder = e.attribute("fillId");
+      applyBorder && (std::strcmp(applyBorder.as_string(), "true") == 0 ||
+                      std::strcmp(applyBorder.as_string(), "1") == 0))
+    context.styleDependencies[name].push_back(
+        std::string("border-") + e.attribute("borderId").as_string());
+}
+
+// records dependencies if `names` is not set; writes css if `out` is set and
+// the style is selected by `names`
+void CellXfsTranslator(const pugi::xml_node &in, std::ostream *out,
+                       const std::unordered_set<std::string> *names,
                        Context &context) {
   std::uint32_t i = 0;
   for (auto &&e : in.children()) {
-    const std::string name = "cellxf-" + std::to_string(i);
-
-    if (const auto applyFont = e.attribute("applyFont");
-        applyFont && (std::strcmp(applyFont.as_string(), "true") == 0 ||
-                      std::strcmp(applyFont.as_string(), "1") == 0))
-      context.styleDependencies[name].push_back(
-          std::string("font-") + e.attribute("fontId").as_string());
-
-    if (const auto fillId = e.attribute("fillId"); fillId)
-      context.styleDependencies[name].push_back(std::string("fill-") +
-                                                fillId.as_string());
+    const std::string name = "cellxf-" + std::to_string(i++);
 
-    if (const auto applyBorder = e.attribute("fillId");
-        applyBorder && (std::strcmp(applyBorder.as_string(), "true") == 0 ||
-                        std::strcmp(applyBorder.as_string(), "1") == 0))
-      context.styleDependencies[name].push_back(
-          std::string("border-") + e.attribute("borderId").as_string());
+    if (names == nullptr)
+      CellXfDependencyTranslator(e, name, context);
+    if ((out == nullptr) || !StyleSelected(name, names))
+      continue;
 
-    out << "." << name << " {";
+    *out << "." << name << " {";
 
     if (const auto applyAlignment = e.attribute("applyAlignment");
         applyAlignment &&
         (std::strcmp(applyAlignment.as_string(), "true") == 0 ||
          std::strcmp(applyAlignment.as_string(), "1") == 0)) {
-      out << "text-align: "
-          << e.child("alignment").attribute("horizontal").as_string() << ";";
+      *out << "text-align: "
+           << e.child("alignment").attribute("horizontal").as_string() << ";";
       // TODO vertical alignment
       // <alignment horizontal="left" vertical="bottom" textRotation="0"
       // wrapText="false" indent="0" shrinkToFit="false" />
@@ -110,9 +138,7 @@ void CellXfsTranslator(const pugi::xml_node &in, std::ostream &out,
     // TODO
     // <protection locked="true" hidden="false" />
 
-    out << "} ";
-
-    ++i;
+    *out << "} ";
   }
 }
 } // namespace
@@ -121,19 +147,44 @@ void WorkbookTranslator::css(const pugi::xml_node &in, Context &context) {
   std::ostream &out = *context.output;
 
   if (const auto fonts = in.child("fonts"); fonts)
-    FontsTranslator(fonts, out, context);
+    FontsTranslator(fonts, out, nullptr, context);
+
+  if (const auto fills = in.child("fills"); fills)
+    FillsTranslator(fills, out, nullptr, context);
+
+  if (const auto borders = in.child("borders"); borders)
+    BordersTranslator(borders, out, nullptr, context);
+
+  if (const auto cellXfs = in.child("cellXfs"); cellXfs)
+    CellXfsTranslator(cellXfs, &out, nullptr, context);
+}
+
+void WorkbookTranslator::dependencies(const pugi::xml_node &in,
+                                      Context &context) {
+  if (const auto cellXfs = in.child("cellXfs"); cellXfs)
+    CellXfsTranslator(cellXfs, nullptr, nullptr, context);
+}
+
+void WorkbookTranslator::css(const pugi::xml_node &in,
+                             const std::unordered_set<std::string> &names,
+                             Context &context) {
+  std::ostream &out = *context.output;
+
+  if (const auto fonts = in.child("fonts"); fonts)
+    FontsTranslator(fonts, out, &names, context);
 
   if (const auto fills = in.child("fills"); fills)
-    FillsTranslator(fills, out, context);
+    FillsTranslator(fills, out, &names, context);
 
   if (const auto borders = in.child("borders"); borders)
-    BordersTranslator(borders, out, context);
+    BordersTranslator(borders, out, &names, context);
 
   if (const auto cellXfs = in.child("cellXfs"); cellXfs)
-    CellXfsTranslator(cellXfs, out, context);
+    CellXfsTranslator(cellXfs, &out, &names, context);
 }
 
 namespace {
+template <bool Editable>
 void TextTranslator(const pugi::xml_text &in, std::ostream &out,
                     Context &context) {
   std::string text = in.as_string();
@@ -141,12 +192,15 @@ void TextTranslator(const pugi::xml_text &in, std::ostream &out,
   common::StringUtil::findAndReplaceAll(text, "<", "&lt;");
   common::StringUtil::findAndReplaceAll(text, ">", "&gt;");
 
-  if (!context.config->editable) {
+  if constexpr (!Editable) {
     out << text;
   } else {
+    // without blocks to count markers in, each text carries its own index
     out << R"(<span contenteditable="true" data-odr-cid=")"
         << context.currentTextTranslationIndex << "\">" << text << "</span>";
-    context.textTranslation[context.currentTextTranslationIndex] = &in;
+    if (context.currentTextTranslationIndex >= context.textTranslation.size())
+      context.textTranslation.resize(context.currentTextTranslationIndex + 1);
+    context.textTranslation[context.currentTextTranslationIndex] = in;
     ++context.currentTextTranslationIndex;
   }
 }
@@ -173,12 +227,13 @@ void ElementAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
     const std::string name = std::string("cellxf-") + s.as_string();
     out << " class=\"";
     out << name;
+    if (context.referencedStyles != nullptr)
+      context.referencedStyles->insert(name);
 
     { // handle style dependencies
       const auto it = context.styleDependencies.find(name);
       if (it == context.styleDependencies.end()) {
-        // TODO remove ?
-        LOG(WARNING) << "unknown style: " << name;
+        context.diagnostics.report("unknown style", name);
       } else {
         for (auto i = it->second.rbegin(); i != it->second.rend(); ++i) {
           out << " " << *i;
@@ -192,13 +247,25 @@ void ElementAttributeTranslator(const pugi::xml_node &in, std::ostream &out,
   StyleAttributeTranslator(in, out, context);
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context);
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context);
+struct ElementTranslator;
+
+struct ElementState {
+  const ElementTranslator *translator{nullptr};
+  bool open{false};
+};
+
+typedef common::XmlTraversal::Frame<ElementState> Frame;
 
-void TableTranslator(const pugi::xml_node &in, std::ostream &out,
-                     Context &context) {
+struct ElementTranslator {
+  // writes the opening part; returns false to skip the element entirely
+  bool (*enter)(Frame &, std::ostream &, Context &);
+  // writes the closing part; returns true to repeat the element
+  bool (*leave)(Frame &, std::ostream &, Context &);
+};
+
+bool NoLeave(Frame &, std::ostream &, Context &) { return false; }
+
+bool TableEnter(Frame &frame, std::ostream &out, Context &context) {
   // TODO context.config->tableLimitByDimensions
   context.tableRange = {
       {context.config->tableOffsetRows, context.config->tableOffsetCols},
@@ -207,18 +274,25 @@ void TableTranslator(const pugi::xml_node &in, std::ostream &out,
   context.tableCursor = {};
 
   out << R"(<table border="0" cellspacing="0" cellpadding="0")";
-  ElementAttributeTranslator(in, out, context);
+  ElementAttributeTranslator(frame.node, out, context);
   out << ">";
-  ElementChildrenTranslator(in, out, context);
-  out << "</table>";
+  return true;
 }
 
-void TableColTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
-  // TODO if min/max is unordered we have a problem here; fail fast in that case
+bool TableLeave(Frame &, std::ostream &out, Context &) {
+  out << "</table>";
+  return false;
+}
 
-  const auto min = in.attribute("min").as_uint(1);
-  const auto max = in.attribute("max").as_uint(1);
+bool TableColEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto min = frame.node.attribute("min").as_uint(1);
+  const auto max = frame.node.attribute("max").as_uint(1);
+  // unordered bounds would wrap around to billions of columns
+  if (max < min) {
+    context.diagnostics.report("unordered column range");
+    frame.next = {};
+    return true;
+  }
   const auto repeated = max - min + 1;
 
   for (std::uint32_t i = 0; i < repeated; ++i) {
@@ -226,20 +300,21 @@ void TableColTranslator(const pugi::xml_node &in, std::ostream &out,
       break;
     if (context.tableCursor.col() >= context.tableRange.from().col()) {
       out << "<col";
-      ElementAttributeTranslator(in, out, context);
+      ElementAttributeTranslator(frame.node, out, context);
       out << ">";
     }
     context.tableCursor.addCol();
   }
+  frame.next = {};
+  return true;
 }
 
-void TableRowTranslator(const pugi::xml_node &in, std::ostream &out,
-                        Context &context) {
-  const auto rowIndex = in.attribute("r").as_uint() - 1;
+bool TableRowEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto rowIndex = frame.node.attribute("r").as_uint() - 1;
 
   while (rowIndex > context.tableCursor.row()) {
     if (context.tableCursor.row() >= context.tableRange.to().row())
-      return;
+      return false;
     if (context.tableCursor.row() >= context.tableRange.from().row()) {
       // TODO insert empty proper rows
       out << "<tr></tr>";
@@ -249,24 +324,33 @@ void TableRowTranslator(const pugi::xml_node &in, std::ostream &out,
 
   context.tableCursor.addRow(0); // TODO hacky
   if (context.tableCursor.row() >= context.tableRange.to().row())
-    return;
-  if (context.tableCursor.row() >= context.tableRange.from().row()) {
+    return false;
+  frame.state.open =
+      context.tableCursor.row() >= context.tableRange.from().row();
+  if (frame.state.open) {
     out << "<tr";
-    ElementAttributeTranslator(in, out, context);
+    ElementAttributeTranslator(frame.node, out, context);
     out << ">";
-    ElementChildrenTranslator(in, out, context);
-    out << "</tr>";
+  } else {
+    frame.next = {};
   }
+  return true;
+}
+
+bool TableRowLeave(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.state.open)
+    out << "</tr>";
   context.tableCursor.addRow();
+  return false;
 }
 
-void TableCellTranslator(const pugi::xml_node &in, std::ostream &out,
-                         Context &context) {
+bool TableCellEnter(Frame &frame, std::ostream &out, Context &context) {
+  const auto &in = frame.node;
   const common::TablePosition cellIndex(in.attribute("r").as_string());
 
   while (cellIndex.col() > context.tableCursor.col()) {
     if (context.tableCursor.col() >= context.tableRange.to().col())
-      return;
+      return false;
     if (context.tableCursor.col() >= context.tableRange.from().col()) {
       out << "<td></td>";
     }
@@ -277,80 +361,230 @@ void TableCellTranslator(const pugi::xml_node &in, std::ostream &out,
   ElementAttributeTranslator(in, out, context);
   out << ">";
 
+  frame.next = {};
   if (const auto t = in.attribute("t"); t) {
     if (std::strcmp(t.as_string(), "s") == 0) {
       const auto sharedStringIndex = in.child("v").text().as_int(-1);
-      if (sharedStringIndex >= 0) {
+      if ((sharedStringIndex >= 0) &&
+          (sharedStringIndex < (int)context.sharedStrings.size())) {
         const pugi::xml_node &replacement =
             context.sharedStrings[sharedStringIndex];
-        ElementChildrenTranslator(replacement, out, context);
+        frame.next = replacement.first_child();
       } else {
-        DLOG(INFO) << "undefined behaviour: shared string not found";
+        context.diagnostics.report("shared string not found",
+                                   in.child("v").text().as_string());
       }
     } else if ((std::strcmp(t.as_string(), "str") == 0) ||
                (std::strcmp(t.as_string(), "inlineStr") == 0) ||
                (std::strcmp(t.as_string(), "n") == 0)) {
-      ElementChildrenTranslator(in, out, context);
+      frame.next = in.first_child();
     } else {
-      DLOG(INFO) << "undefined behaviour: t=" << t.as_string();
+      context.diagnostics.report("unknown cell type", t.as_string());
     }
   } else {
     // TODO empty cell?
   }
 
+  return true;
+}
+
+bool TableCellLeave(Frame &, std::ostream &out, Context &context) {
   out << "</td>";
   context.tableCursor.addCell();
+  return false;
 }
 
-void ElementChildrenTranslator(const pugi::xml_node &in, std::ostream &out,
-                               Context &context) {
-  for (auto &&n : in) {
-    if (n.type() == pugi::node_pcdata)
-      TextTranslator(n.text(), out, context);
-    else if (n.type() == pugi::node_element)
-      ElementTranslator(n, out, context);
-  }
-}
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context);
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &context);
 
-void ElementTranslator(const pugi::xml_node &in, std::ostream &out,
-                       Context &context) {
-  static std::unordered_map<std::string, const char *> substitution{
+bool ChildrenEnter(Frame &, std::ostream &, Context &) { return true; }
+
+constexpr ElementTranslator tableTranslator{TableEnter, TableLeave};
+constexpr ElementTranslator tableColTranslator{TableColEnter, NoLeave};
+constexpr ElementTranslator tableRowTranslator{TableRowEnter, TableRowLeave};
+constexpr ElementTranslator tableCellTranslator{TableCellEnter,
+                                                TableCellLeave};
+constexpr ElementTranslator substitutionTranslator{SubstitutionEnter,
+                                                   SubstitutionLeave};
+constexpr ElementTranslator childrenTranslator{ChildrenEnter, NoLeave};
+
+const char *substitution(const std::string_view element) {
+  static const std::unordered_map<std::string_view, const char *> substitution{
       {"cols", "colgroup"},
   };
-  static std::unordered_set<std::string> skippers{
+
+  const auto it = substitution.find(element);
+  if (it == substitution.end())
+    return nullptr;
+  return it->second;
+}
+
+bool SubstitutionEnter(Frame &frame, std::ostream &out, Context &context) {
+  out << "<" << substitution(frame.node.name());
+  ElementAttributeTranslator(frame.node, out, context);
+  out << ">";
+  return true;
+}
+
+bool SubstitutionLeave(Frame &frame, std::ostream &out, Context &) {
+  out << "</" << substitution(frame.node.name()) << ">";
+  return false;
+}
+
+const ElementTranslator *lookupElementTranslator(const pugi::xml_node &in) {
+  static const std::unordered_set<std::string_view> skippers{
       "headerFooter",
       "f", // TODO translate formula and hide
   };
 
-  const std::string element = in.name();
+  const std::string_view element = in.name();
   if (skippers.find(element) != skippers.end())
-    return;
+    return nullptr;
 
   if (element == "worksheet")
-    TableTranslator(in, out, context);
+    return &tableTranslator;
   else if (element == "col")
-    TableColTranslator(in, out, context);
+    return &tableColTranslator;
   else if (element == "row")
-    TableRowTranslator(in, out, context);
+    return &tableRowTranslator;
   else if (element == "c")
-    TableCellTranslator(in, out, context);
-  else {
-    const auto it = substitution.find(element);
-    if (it != substitution.end()) {
-      out << "<" << it->second;
-      ElementAttributeTranslator(in, out, context);
-      out << ">";
-    }
-    ElementChildrenTranslator(in, out, context);
-    if (it != substitution.end()) {
-      out << "</" << it->second << ">";
+    return &tableCellTranslator;
+  else if (substitution(element) != nullptr)
+    return &substitutionTranslator;
+  return &childrenTranslator;
+}
+
+template <bool Editable>
+bool NodeEnter(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.node.type() == pugi::node_pcdata) {
+    TextTranslator<Editable>(frame.node.text(), out, context);
+    frame.next = {};
+    return true;
+  }
+  if (frame.node.type() != pugi::node_element)
+    return false;
+
+  if (frame.state.translator == nullptr) {
+    frame.state.translator = lookupElementTranslator(frame.node);
+    if (frame.state.translator == nullptr)
+      return false;
+  }
+  return frame.state.translator->enter(frame, out, context);
+}
+
+bool NodeLeave(Frame &frame, std::ostream &out, Context &context) {
+  if (frame.state.translator == nullptr)
+    return false;
+  return frame.state.translator->leave(frame, out, context);
+}
+
+struct IrState {
+  bool open{false};
+};
+
+typedef common::XmlTraversal::Frame<IrState> IrFrame;
+
+std::string IrStyle(const pugi::xml_node &in) {
+  if (const auto s = in.attribute("s"); s)
+    return std::string("cellxf-") + s.as_string();
+  return "";
+}
+
+// gaps in the sheet become empty runs
+void IrGap(const common::IrType type, const std::uint32_t gap,
+           common::IrDocument &out) {
+  if (gap == 0)
+    return;
+  const std::uint32_t index = out.leaf(type);
+  out.setRepeat(index, gap);
+}
+
+bool IrEnter(IrFrame &frame, common::IrDocument &out, Context &context,
+             common::TablePosition &cursor) {
+  const pugi::xml_node &in = frame.node;
+  if (in.type() == pugi::node_pcdata) {
+    out.appendText(in.value());
+    return false;
+  }
+  if (in.type() != pugi::node_element)
+    return false;
+
+  const std::string_view element = in.name();
+  if ((element == "headerFooter") || (element == "f") ||
+      common::StringUtil::endsWith(element, "Pr"))
+    return false;
+
+  if (element == "worksheet") {
+    out.open(common::IrType::SHEET);
+    frame.state.open = true;
+    cursor = {};
+  } else if (element == "col") {
+    const auto min = std::max(1u, in.attribute("min").as_uint(1)) - 1;
+    const auto max = std::max(min + 1, in.attribute("max").as_uint(1));
+    IrGap(common::IrType::TABLE_COLUMN, min - std::min(min, cursor.col()),
+          out);
+    const std::uint32_t index =
+        out.leaf(common::IrType::TABLE_COLUMN, IrStyle(in));
+    out.setRepeat(index, max - min);
+    cursor = {0, max};
+    frame.next = {};
+  } else if (element == "row") {
+    const auto row = in.attribute("r").as_uint(cursor.row() + 1) - 1;
+    IrGap(common::IrType::TABLE_ROW, row - std::min(row, cursor.row()), out);
+    out.open(common::IrType::TABLE_ROW, IrStyle(in));
+    frame.state.open = true;
+    cursor = {row + 1, 0};
+  } else if (element == "c") {
+    std::uint32_t col = cursor.col();
+    if (const auto r = in.attribute("r"); r)
+      col = common::TablePosition(r.as_string()).col();
+    IrGap(common::IrType::TABLE_CELL, col - std::min(col, cursor.col()), out);
+    out.open(common::IrType::TABLE_CELL, IrStyle(in));
+    frame.state.open = true;
+    cursor = {cursor.row(), col + 1};
+
+    if (std::strcmp(in.attribute("t").as_string(), "s") == 0) {
+      const auto sharedStringIndex = in.child("v").text().as_int(-1);
+      if ((sharedStringIndex >= 0) &&
+          (sharedStringIndex < (int)context.sharedStrings.size()))
+        frame.next = context.sharedStrings[sharedStringIndex].first_child();
+      else
+        frame.next = {};
     }
   }
+  return true;
+}
+
+bool IrLeave(IrFrame &frame, common::IrDocument &out) {
+  if (frame.state.open)
+    out.close();
+  return false;
+}
+
+template <bool Editable>
+void translate(const pugi::xml_node &in, std::ostream &out, Context &context) {
+  common::XmlTraversal::traverse<ElementState>(
+      in,
+      [&](Frame &frame) { return NodeEnter<Editable>(frame, out, context); },
+      [&](Frame &frame) { return NodeLeave(frame, out, context); });
 }
 } // namespace
 
 void WorkbookTranslator::html(const pugi::xml_node &in, Context &context) {
-  ElementTranslator(in, *context.output, context);
+  std::ostream &out = *context.output;
+  if (context.config->editable)
+    translate<true>(in, out, context);
+  else
+    translate<false>(in, out, context);
+}
+
+void WorkbookTranslator::ir(const pugi::xml_node &in, Context &context,
+                            common::IrDocument &out) {
+  common::TablePosition cursor;
+  common::XmlTraversal::traverse<IrState>(
+      in,
+      [&](IrFrame &frame) { return IrEnter(frame, out, context, cursor); },
+      [&](IrFrame &frame) { return IrLeave(frame, out); });
 }
 
 } // namespace ooxml
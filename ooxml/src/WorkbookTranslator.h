@@ -2,19 +2,31 @@
 #define ODR_OOXML_WORKBOOK_TRANSLATOR_H
 
 #include <memory>
+#include <string>
+#include <unordered_set>
 
 namespace pugi {
 class xml_node;
 }
 
 namespace odr {
+namespace common {
+class IrDocument;
+}
+
 namespace ooxml {
 
 struct Context;
 
 namespace WorkbookTranslator {
 void css(const pugi::xml_node &in, Context &context);
+// records the style dependencies without writing css
+void dependencies(const pugi::xml_node &in, Context &context);
+// writes css only for the given style names; dependencies are not recorded
+void css(const pugi::xml_node &in, const std::unordered_set<std::string> &names,
+         Context &context);
 void html(const pugi::xml_node &in, Context &context);
+void ir(const pugi::xml_node &in, Context &context, common::IrDocument &out);
 } // namespace WorkbookTranslator
 
 } // namespace ooxml
@@ -21,18 +21,51 @@
       modifiedText: {},
     };
     for (let [k, v] of Object.entries(editJournal['modifiedText'])) {
-      result['modifiedText'][k] = v.innerText;
+      result['modifiedText'][k] = v.textContent;
     }
     return JSON.stringify(result);
   }
 
+  function applyPatches(patches) {
+    for (let [k, v] of Object.entries(patches)) {
+      const block = document.querySelector('[data-odr-bid="' + k + '"]');
+      if (block) {
+        block.outerHTML = v;
+      }
+    }
+  }
+
+  // ooxml text sits alone in a span carrying its index. odf text follows an
+  // empty comment; its index is the first index of the block plus the number
+  // of markers in the block before it
+  function textIndex(node) {
+    const parent = node.parentNode;
+    if (parent && parent.hasAttribute && parent.hasAttribute('data-odr-cid')) {
+      return parseInt(parent.getAttribute('data-odr-cid'));
+    }
+    const marker = node.previousSibling;
+    if (!marker || (marker.nodeType !== Node.COMMENT_NODE)) {
+      return undefined;
+    }
+    const block = node.parentNode.closest('[data-odr-bid]');
+    if (!block) {
+      return undefined;
+    }
+    const walker = document.createTreeWalker(block, NodeFilter.SHOW_COMMENT);
+    let index = odr.textMap[parseInt(block.getAttribute('data-odr-bid'))];
+    let current;
+    while ((current = walker.nextNode()) && (current !== marker)) {
+      ++index;
+    }
+    return current ? index : undefined;
+  }
+
   function mutation(mutations, observer) {
     for(let m of mutations) {
       if (m.type === 'characterData') {
-        const node = m.target.parentNode;
-        const id = node.getAttribute('data-odr-cid');
-        if (id) {
-          editJournal['modifiedText'][parseInt(id)] = node;
+        const id = textIndex(m.target);
+        if (id !== undefined) {
+          editJournal['modifiedText'][id] = m.target;
         }
       } else {
         console.log(m);
@@ -56,5 +89,6 @@
   var odr = window.odr || {};
   odr.download = download;
   odr.generateDiff = generateDiff;
+  odr.applyPatches = applyPatches;
   window.odr = odr;
 })();
\ No newline at end of file
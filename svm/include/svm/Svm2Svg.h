@@ -5,6 +5,10 @@
 #include <memory>
 
 namespace odr {
+namespace access {
+class Diagnostics;
+}
+
 namespace svm {
 
 class NoSvmFileException : public std::exception {
@@ -18,7 +22,9 @@ public:
 };
 
 namespace Translator {
-void svg(std::istream &in, std::ostream &out);
+// problems of the input are counted into `diagnostics` if given
+void svg(std::istream &in, std::ostream &out,
+         access::Diagnostics *diagnostics = nullptr);
 }
 
 } // namespace svm
@@ -1,6 +1,6 @@
+#include <access/Diagnostics.h>
 #include <codecvt>
 #include <cstring>
-#include <glog/logging.h>
 #include <locale>
 #include <string>
 #include <svm/Svm2Svg.h>
@@ -10,6 +10,19 @@ namespace odr {
 namespace svm {
 
 namespace {
+// collector of the running translation; the record readers have no context
+thread_local access::Diagnostics *diagnostics_{nullptr};
+
+void report(const char *category) {
+  if (diagnostics_ != nullptr)
+    diagnostics_->report(category);
+}
+
+void report(const char *category, const std::string &sample) {
+  if (diagnostics_ != nullptr)
+    diagnostics_->report(category, sample);
+}
+
 enum TextEncoding {
   RTL_TEXTENCODING_DONTKNOW = 0,
   RTL_TEXTENCODING_ASCII_US = 11,
@@ -78,13 +91,28 @@ template <typename T> void readPrimitive(std::istream &in, T &out) {
   in.read((char *)&out, sizeof(out));
 }
 
+// counts and lengths are checked against the rest of the input before anything
+// is allocated for them
+void checkRemaining(std::istream &in, const std::uint64_t bytes) {
+  const std::istream::pos_type position = in.tellg();
+  if (position < 0)
+    throw MalformedSvmFileException();
+  in.seekg(0, std::ios::end);
+  const std::istream::pos_type end = in.tellg();
+  in.seekg(position);
+  if ((end < position) || ((std::uint64_t)(end - position) < bytes))
+    throw MalformedSvmFileException();
+}
+
 std::string readAsciiString(std::istream &in, const std::uint32_t length) {
+  checkRemaining(in, length);
   std::string result(length, ' ');
   in.read((char *)result.data(), result.size());
   return result;
 }
 
 std::string readUtf16String(std::istream &in, const std::uint32_t length) {
+  checkRemaining(in, 2 * (std::uint64_t)length);
   std::u16string resultU16(length, ' ');
   in.read((char *)resultU16.data(), length * 2);
   std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> conversion;
@@ -125,7 +153,7 @@ struct VersionLength final {
     readPrimitive(in, version);
     readPrimitive(in, length);
     if (version <= 0) {
-      DLOG(WARNING) << "VersionLength illegal version";
+      report("svm illegal version");
     }
   }
 };
@@ -159,6 +187,7 @@ std::vector<IntPair> readPolygon(std::istream &in) {
 
   std::uint16_t size;
   readPrimitive(in, size);
+  checkRemaining(in, 8 * (std::uint64_t)size);
 
   result.resize(size);
   for (auto &&p : result) {
@@ -173,6 +202,8 @@ std::vector<std::vector<IntPair>> readPolyPolygon(std::istream &in) {
 
   std::uint16_t size;
   readPrimitive(in, size);
+  // every polygon has at least its point count
+  checkRemaining(in, 2 * (std::uint64_t)size);
 
   result.resize(size);
   for (auto &&p : result) {
@@ -234,7 +265,7 @@ struct LineInfo final {
 
     if (vl.version >= 4) {
       // TODO
-      DLOG(WARNING) << "LineInfo version 4 not implemented";
+      report("svm line info version 4 not implemented");
     }
   }
 };
@@ -326,7 +357,7 @@ struct Header final {
     }
     std::size_t left = vl.length - ((std::size_t)in.tellg() - start);
     if (left > 0) {
-      DLOG(WARNING) << "Header skipping " << left << " bytes";
+      report("svm header skipped bytes");
       in.ignore(left);
     }
   }
@@ -359,7 +390,7 @@ struct PolyLineAction final {
 
       if (hasFlags) {
         // TODO
-        DLOG(WARNING) << "PolyLineAction flags not implemented";
+        report("svm polyline flags not implemented");
       }
     }
   }
@@ -377,7 +408,7 @@ struct PolygonAction final {
 
       if (hasFlags) {
         // TODO
-        DLOG(WARNING) << "PolygonAction flags not implemented";
+        report("svm polygon flags not implemented");
       }
     }
   }
@@ -395,7 +426,7 @@ struct PolyPolygonAction final {
 
       if (complexPolygons > 0) {
         // TODO
-        DLOG(WARNING) << "PolyPolygonAction complex not implemented";
+        report("svm complex polypolygon not implemented");
       }
     }
   }
@@ -435,6 +466,7 @@ struct TextArrayAction final {
     readPrimitive(in, length);
     std::uint32_t dxArrayLength;
     readPrimitive(in, dxArrayLength);
+    checkRemaining(in, 4 * (std::uint64_t)dxArrayLength);
     dxArray.resize(dxArrayLength);
     for (std::uint32_t i = 0; i < dxArrayLength; ++i) {
       readPrimitive(in, dxArray[i]);
@@ -571,7 +603,7 @@ void writeStyle(std::ostream &out, SvmContext &context, const int styles) {
     writeTextStyle(out, context);
     break;
   default:
-    DLOG(WARNING) << "not implemented";
+    report("svm style not implemented");
   }
   out << "\"";
 }
@@ -698,15 +730,22 @@ void translateAction(const ActionHeader &action, std::istream &in,
     in.ignore(action.vl.length);
     break;
   default:
-    DLOG(WARNING) << "unhandled action " << action.type << " version "
-                  << action.vl.version << " length " << action.vl.length;
+    report("svm unhandled action", std::to_string(action.type));
     in.ignore(action.vl.length);
     break;
   }
 }
 } // namespace
 
-void Translator::svg(std::istream &in, std::ostream &out) {
+void Translator::svg(std::istream &in, std::ostream &out,
+                     access::Diagnostics *diagnostics) {
+  // restores the outer collector; also on a malformed file
+  struct Scope final {
+    access::Diagnostics *outer{diagnostics_};
+    ~Scope() { diagnostics_ = outer; }
+  } scope;
+  diagnostics_ = diagnostics;
+
   SvmContext context{};
   context.in = &in;
   context.out = &out;
@@ -735,12 +774,9 @@ void Translator::svg(std::istream &in, std::ostream &out) {
     const std::int64_t left =
         action.vl.length - ((std::int64_t)in.tellg() - start);
     if (left > 0) {
-      DLOG(WARNING) << "skipping " << left << " bytes of action " << action.type
-                    << " version " << action.vl.version;
+      report("svm action skipped bytes", std::to_string(action.type));
       in.ignore(left);
     } else if (left < 0) {
-      LOG(ERROR) << -left << " bytes missing action " << action.type
-                 << " version " << action.vl.version;
       throw MalformedSvmFileException();
     }
   }
@@ -0,0 +1,434 @@
+#include <access/CfbStorage.h>
+#include <access/Path.h>
+#include <access/ZipStorage.h>
+#include <chrono>
+#include <common/Fingerprint.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <odr/Config.h>
+#include <odr/Document.h>
+#include <sstream>
+#include <string>
+#include <svm/Svm2Svg.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+// Pathological inputs which are small on disk but used to explode in time or
+// memory. Each case is generated and has to finish within a time and a peak
+// memory ceiling in a child process of its own; the ceilings are generous but
+// far below what a super-linear path would need.
+
+using namespace odr;
+
+namespace {
+// generated inputs and outputs stay out of the working directory
+std::string tempPath(const std::string &name) {
+  return ::testing::TempDir() + name;
+}
+
+std::uint64_t peakRss() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+struct Measurement {
+  double seconds{0};
+  std::uint64_t bytes{0};
+  bool failed{true};
+};
+
+// runs the case in a forked child; the child's peak starts at its resident
+// size at the fork, so the growth is that of this case alone and not hidden
+// below an earlier peak of the test process
+template <typename F>
+void expectBounded(F &&f, const double seconds, const std::uint64_t megabytes) {
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  std::fflush(nullptr);
+  const pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    close(fds[0]);
+    Measurement result;
+    const auto rss = peakRss();
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      f();
+      result.failed = ::testing::Test::HasFailure();
+    } catch (...) {
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    result.bytes = peakRss() - rss;
+    const auto written = write(fds[1], &result, sizeof(result));
+    std::fflush(nullptr);
+    _exit(written == sizeof(result) ? 0 : 1);
+  }
+  close(fds[1]);
+  Measurement result;
+  const auto received = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(result)), received);
+  ASSERT_TRUE(WIFEXITED(status));
+  // the failures themselves are printed by the child
+  EXPECT_FALSE(result.failed);
+  EXPECT_LT(result.seconds, seconds);
+  EXPECT_LT(result.bytes, megabytes * 1024 * 1024);
+}
+
+void writeZip(const std::string &path,
+              const std::vector<std::pair<std::string, std::string>> &files) {
+  access::ZipWriter writer(path);
+  for (auto &&file : files) {
+    const auto out = writer.write(file.first);
+    out->write(file.second.data(), file.second.size());
+  }
+}
+
+std::uint64_t fileSize(const std::string &path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  return in.tellg();
+}
+
+const std::string odfNamespaces =
+    R"( xmlns:office="urn:oasis:names:tc:opendocument:xmlns:office:1.0")"
+    R"( xmlns:text="urn:oasis:names:tc:opendocument:xmlns:text:1.0")"
+    R"( xmlns:table="urn:oasis:names:tc:opendocument:xmlns:table:1.0")"
+    R"( xmlns:draw="urn:oasis:names:tc:opendocument:xmlns:drawing:1.0")";
+
+void writeOdf(const std::string &path, const std::string &mimeType,
+              const std::string &body) {
+  const std::string content = "<office:document-content" + odfNamespaces +
+                              "><office:body>" + body +
+                              "</office:body></office:document-content>";
+  const std::string styles = "<office:document-styles" + odfNamespaces + "/>";
+  writeZip(path, {{"mimetype", mimeType},
+                  {"content.xml", content},
+                  {"styles.xml", styles}});
+}
+
+void translate(const std::string &input, const std::string &output,
+               const TranslationFormat format) {
+  Config config;
+  config.format = format;
+  config.tableLimitRows = 1000;
+  config.tableLimitCols = 100;
+  const Document document(input);
+  document.translate(output, config);
+}
+
+void put(std::string &buffer, const std::size_t offset, std::uint64_t value,
+         const std::size_t size) {
+  for (std::size_t i = 0; i < size; ++i, value >>= 8)
+    buffer[offset + i] = static_cast<char>(value & 0xff);
+}
+
+constexpr std::uint32_t freeSector = 0xFFFFFFFF;
+constexpr std::uint32_t endOfChain = 0xFFFFFFFE;
+constexpr std::uint32_t fatSector = 0xFFFFFFFD;
+constexpr std::uint32_t noStream = 0xFFFFFFFF;
+
+// version 3 compound file with `sectors` sectors: the FAT in sector 0, the
+// directory in sector 1 and the 4096 byte stream "data" in sectors 2 to 9
+std::string cfb(const std::size_t sectors = 16) {
+  std::string result(512 * (sectors + 1), '\0');
+  result.replace(0, 8, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1");
+  put(result, 24, 0x3E, 2); // minor version
+  put(result, 26, 3, 2);    // major version
+  put(result, 28, 0xFFFE, 2);
+  put(result, 30, 9, 2);    // sector shift
+  put(result, 32, 6, 2);    // mini sector shift
+  put(result, 44, 1, 4);    // FAT sectors
+  put(result, 48, 1, 4);    // first directory sector
+  put(result, 56, 4096, 4); // mini stream cutoff
+  put(result, 60, endOfChain, 4);
+  put(result, 68, endOfChain, 4);
+  for (std::size_t i = 0; i < 109; ++i)
+    put(result, 76 + 4 * i, i == 0 ? 0 : freeSector, 4);
+
+  const std::size_t fat = 512;
+  for (std::size_t i = 0; i < 128; ++i)
+    put(result, fat + 4 * i, freeSector, 4);
+  put(result, fat, fatSector, 4);
+  put(result, fat + 4, endOfChain, 4);
+  for (std::size_t i = 2; i < 9; ++i)
+    put(result, fat + 4 * i, i + 1, 4);
+  put(result, fat + 4 * 9, endOfChain, 4);
+
+  const auto entry = [&](const std::size_t id, const std::u16string &name,
+                         const std::uint8_t type, const std::uint32_t child,
+                         const std::uint32_t start, const std::uint64_t size) {
+    const std::size_t offset = 1024 + 128 * id;
+    for (std::size_t i = 0; i < name.size(); ++i)
+      put(result, offset + 2 * i, name[i], 2);
+    put(result, offset + 64, 2 * (name.size() + 1), 2);
+    put(result, offset + 66, type, 1);
+    put(result, offset + 68, noStream, 4); // left sibling
+    put(result, offset + 72, noStream, 4); // right sibling
+    put(result, offset + 76, child, 4);
+    put(result, offset + 116, start, 4);
+    put(result, offset + 120, size, 8);
+  };
+  entry(0, u"Root Entry", 5, 1, endOfChain, 0);
+  entry(1, u"data", 2, noStream, 2, 4096);
+
+  for (std::size_t i = 0; i < 4096; ++i)
+    result[1536 + i] = static_cast<char>(i);
+  return result;
+}
+
+void readCfb(const std::string &buffer) {
+  const std::string path = tempPath("adversarial.cfb");
+  std::ofstream(path, std::ios::binary) << buffer;
+  const access::CfbReader reader(path);
+  reader.visit([&](const access::Path &p) {
+    const auto in = reader.read(p);
+    if (in)
+      while (in->get() != EOF) {
+      }
+  });
+}
+
+void svmHeader(std::string &svm) {
+  svm += "VCLMTF";
+  const auto append = [&](std::uint64_t value, const int size) {
+    for (int i = 0; i < size; ++i, value >>= 8)
+      svm.push_back(static_cast<char>(value & 0xff));
+  };
+  append(1, 2);  // version
+  append(49, 4); // length
+  append(0, 4);  // compression
+  append(1, 2);  // map mode version
+  append(27, 4); // map mode length
+  svm.append(27, '\0');
+  append(1000, 4); // width
+  append(1000, 4); // height
+  append(1, 4);    // actions
+}
+} // namespace
+
+TEST(Adversarial, repeatedRowsAndColumns) {
+  const std::string input = tempPath("adversarial-repeated.ods");
+  const std::string output = tempPath("adversarial-repeated");
+  writeOdf(input, "application/vnd.oasis.opendocument.spreadsheet",
+           "<office:spreadsheet><table:table table:name=\"t\">"
+           "<table:table-column table:number-columns-repeated=\"16384\"/>"
+           "<table:table-row table:number-rows-repeated=\"1048576\">"
+           "<table:table-cell table:number-columns-repeated=\"16384\" "
+           "office:value-type=\"string\"><text:p>x</text:p>"
+           "</table:table-cell></table:table-row>"
+           "<table:table-row><table:table-cell "
+           "table:number-rows-spanned=\"4000000000\" "
+           "table:number-columns-spanned=\"1000000\"/></table:table-row>"
+           "</table:table></office:spreadsheet>");
+
+  expectBounded(
+      [&] {
+        translate(input, output + ".html", TranslationFormat::HTML);
+        translate(input, output + ".txt", TranslationFormat::TEXT);
+      },
+      10, 256);
+}
+
+TEST(Adversarial, deepNesting) {
+  constexpr std::uint32_t depth = 100000;
+  std::string body = "<office:text><text:p>";
+  for (std::uint32_t i = 0; i < depth; ++i)
+    body += "<text:list><text:list-item>";
+  for (std::uint32_t i = 0; i < depth; ++i)
+    body += "</text:list-item></text:list>";
+  for (std::uint32_t i = 0; i < depth; ++i)
+    body += "<draw:frame><draw:text-box>";
+  for (std::uint32_t i = 0; i < depth; ++i)
+    body += "</draw:text-box></draw:frame>";
+  body += "</text:p></office:text>";
+  const std::string input = tempPath("adversarial-nested.odt");
+  const std::string output = tempPath("adversarial-nested");
+  writeOdf(input, "application/vnd.oasis.opendocument.text", body);
+
+  expectBounded(
+      [&] {
+        translate(input, output + ".html", TranslationFormat::HTML);
+        translate(input, output + ".txt", TranslationFormat::TEXT);
+      },
+      10, 512);
+}
+
+TEST(Adversarial, spaceCount) {
+  const std::string input = tempPath("adversarial-spaces.odt");
+  const std::string output = tempPath("adversarial-spaces");
+  writeOdf(input, "application/vnd.oasis.opendocument.text",
+           "<office:text><text:p>a<text:s text:c=\"4000000000\"/>b</text:p>"
+           "</office:text>");
+
+  expectBounded(
+      [&] {
+        translate(input, output + ".html", TranslationFormat::HTML);
+        translate(input, output + ".txt", TranslationFormat::TEXT);
+      },
+      5, 64);
+  EXPECT_LT(fileSize(output + ".html"), 1024 * 1024);
+  EXPECT_LT(fileSize(output + ".txt"), 1024 * 1024);
+}
+
+TEST(Adversarial, overlappingColumns) {
+  std::string sheet = "<worksheet><cols>";
+  for (std::uint32_t i = 0; i < 10000; ++i)
+    sheet += "<col min=\"1\" max=\"16384\"/>";
+  sheet += "<col min=\"16384\" max=\"1\"/>";
+  sheet += "</cols><sheetData/></worksheet>";
+  const std::string input = tempPath("adversarial-cols.xlsx");
+  const std::string output = tempPath("adversarial-cols");
+  writeZip(input,
+           {{"xl/workbook.xml",
+             "<workbook><sheets><sheet name=\"s\" r:id=\"rId1\"/></sheets>"
+             "</workbook>"},
+            {"xl/_rels/workbook.xml.rels",
+             "<Relationships><Relationship Id=\"rId1\" "
+             "Target=\"worksheets/sheet1.xml\"/></Relationships>"},
+            {"xl/styles.xml", "<styleSheet/>"},
+            {"xl/worksheets/sheet1.xml", sheet}});
+
+  expectBounded(
+      [&] {
+        translate(input, output + ".html", TranslationFormat::HTML);
+        translate(input, output + ".txt", TranslationFormat::TEXT);
+      },
+      10, 256);
+}
+
+TEST(Adversarial, millionMembers) {
+  constexpr std::uint32_t members = 1000000;
+  const std::string input = tempPath("adversarial-members.zip");
+  {
+    access::ZipWriter writer(input);
+    for (std::uint32_t i = 0; i < members; ++i)
+      writer.write(std::to_string(i), 0);
+  }
+
+  expectBounded(
+      [&] {
+        const access::ZipReader reader(input);
+        EXPECT_TRUE(reader.isFile(access::Path(std::to_string(members - 1))));
+        // looks up every member once
+        EXPECT_EQ(32, common::Fingerprint::directory(reader).size());
+      },
+      30, 512);
+}
+
+TEST(Adversarial, zipBomb) {
+  const std::string input = tempPath("adversarial-bomb.zip");
+  writeZip(input, {{"content.xml", std::string(80 * 1024 * 1024, ' ')}});
+
+  expectBounded(
+      [&] {
+        const access::ZipReader reader(input);
+        EXPECT_THROW(reader.read("content.xml"), access::ZipBombException);
+      },
+      5, 64);
+}
+
+TEST(Adversarial, cfbValid) {
+  const std::string path = tempPath("adversarial-valid.cfb");
+  std::ofstream(path, std::ios::binary) << cfb();
+  const access::CfbReader reader(path);
+  EXPECT_TRUE(reader.isFile("data"));
+  const auto in = reader.read("data");
+  std::ostringstream out;
+  out << in->rdbuf();
+  ASSERT_EQ(4096, out.str().size());
+  EXPECT_EQ('\x10', out.str()[16]);
+}
+
+TEST(Adversarial, cfbDirectoryLoop) {
+  auto buffer = cfb();
+  put(buffer, 512 + 4, 1, 4); // the directory sector is its own successor
+  expectBounded(
+      [&] { EXPECT_THROW(readCfb(buffer), access::CfbFileCorruptedException); },
+      5, 64);
+}
+
+TEST(Adversarial, cfbSiblingLoop) {
+  auto buffer = cfb();
+  put(buffer, 1024 + 128 + 68, 1, 4); // "data" is its own left sibling
+  expectBounded(
+      [&] { EXPECT_THROW(readCfb(buffer), access::CfbFileCorruptedException); },
+      5, 64);
+}
+
+TEST(Adversarial, cfbStreamLoop) {
+  auto buffer = cfb();
+  put(buffer, 512 + 4 * 2, 2, 4); // the stream loops on its first sector
+  put(buffer, 1024 + 128 + 120, 1ull << 40, 8);
+  expectBounded(
+      [&] { EXPECT_THROW(readCfb(buffer), access::CfbFileCorruptedException); },
+      5, 64);
+}
+
+TEST(Adversarial, cfbFatCount) {
+  auto buffer = cfb();
+  put(buffer, 44, 0xFFFFFFFF, 4);
+  expectBounded(
+      [&] { EXPECT_THROW(readCfb(buffer), access::CfbFileCorruptedException); },
+      5, 64);
+}
+
+TEST(Adversarial, cfbDifatLoop) {
+  auto buffer = cfb(1024);
+  put(buffer, 44, 1000, 4);           // FAT sectors beyond the header
+  put(buffer, 68, 10, 4);             // first DIFAT sector
+  put(buffer, 72, 0xFFFFFFFF, 4);     // DIFAT sectors
+  put(buffer, 512 * 11 + 508, 10, 4); // which is its own successor
+  expectBounded(
+      [&] { EXPECT_THROW(readCfb(buffer), access::CfbFileCorruptedException); },
+      5, 64);
+}
+
+TEST(Adversarial, svmPolygonCount) {
+  // every polygon claims the maximum point count without any points following
+  std::string svm;
+  svmHeader(svm);
+  svm += std::string("\x6f\x00\x01\x00\x06\x00\x00\x00", 8);
+  svm += std::string("\xff\xff\xff\xff", 4);
+  svm += std::string(2, '\0');
+
+  expectBounded(
+      [&] {
+        std::istringstream in(svm);
+        std::ostringstream out;
+        EXPECT_THROW(svm::Translator::svg(in, out),
+                     svm::MalformedSvmFileException);
+      },
+      5, 64);
+}
+
+TEST(Adversarial, svmLargePolygon) {
+  constexpr std::uint32_t points = 0xFFFF;
+  std::string svm;
+  svmHeader(svm);
+  const std::uint32_t length = 2 + 8 * points;
+  svm += std::string("\x6e\x00\x01\x00", 4);
+  for (int i = 0; i < 4; ++i)
+    svm.push_back(static_cast<char>((length >> (8 * i)) & 0xff));
+  svm += std::string("\xff\xff", 2);
+  svm.append(8 * points, '\x01');
+
+  expectBounded(
+      [&] {
+        std::istringstream in(svm);
+        std::ostringstream out;
+        svm::Translator::svg(in, out);
+        EXPECT_LT(out.str().size(), 64 * points);
+      },
+      5, 64);
+}
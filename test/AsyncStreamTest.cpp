@@ -0,0 +1,110 @@
+#include <access/AsyncStream.h>
+#include <access/SpscQueue.h>
+#include <chrono>
+#include <ctime>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace odr::access;
+
+TEST(SpscQueue, order) {
+  SpscQueue<int> queue(3);
+  std::thread producer([&] {
+    for (int i = 1; i <= 100000; ++i)
+      queue.push(i);
+    queue.push(0);
+  });
+
+  int expected = 1;
+  for (int value = queue.pop(); value != 0; value = queue.pop()) {
+    EXPECT_EQ(expected, value);
+    ++expected;
+  }
+  producer.join();
+  EXPECT_EQ(100001, expected);
+}
+
+TEST(SpscQueue, bounded) {
+  SpscQueue<int> queue(2);
+  int value = 1;
+  EXPECT_TRUE(queue.tryPush(value));
+  EXPECT_TRUE(queue.tryPush(value));
+  EXPECT_FALSE(queue.tryPush(value));
+  EXPECT_TRUE(queue.tryPop(value));
+  EXPECT_TRUE(queue.tryPop(value));
+  EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(SpscQueue, sleeps) {
+  SpscQueue<int> queue(1);
+  double cpuSeconds = 0;
+  std::thread consumer([&] {
+    EXPECT_EQ(1, queue.pop());
+    timespec start{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    EXPECT_EQ(2, queue.pop());
+    timespec end{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+    cpuSeconds =
+        (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  });
+
+  queue.push(1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  queue.push(2);
+  consumer.join();
+  // a spinning consumer would burn the whole wait
+  EXPECT_LT(cpuSeconds, 0.05);
+}
+
+TEST(AsyncOstream, content) {
+  std::string input;
+  for (int i = 0; i < 100000; ++i) {
+    input += "<p>line " + std::to_string(i) + "</p>";
+  }
+
+  std::ostringstream out;
+  {
+    AsyncOstream async(out);
+    async << input.substr(0, 1000);
+    async.flush();
+    async << input.substr(1000);
+  }
+
+  EXPECT_EQ(input, out.str());
+}
+
+TEST(AsyncOstream, finish) {
+  std::ostringstream out;
+  AsyncOstream async(out);
+  async << "data";
+  async.finish();
+  EXPECT_EQ("data", out.str());
+
+  async << "more";
+  EXPECT_FALSE(async.good());
+  EXPECT_EQ("data", out.str());
+}
+
+TEST(AsyncOstream, failure) {
+  // accepts nothing, like a full disk
+  struct FullBuf final : std::streambuf {
+    int overflow(int) final { return traits_type::eof(); }
+  } full;
+
+  std::ostream out(&full);
+  AsyncOstream async(out);
+  async << std::string(200000, 'a');
+  async.flush();
+  async.finish();
+  EXPECT_TRUE(async.bad());
+
+  std::ostream throwing(&full);
+  throwing.exceptions(std::ios::badbit);
+  AsyncOstream guarded(throwing);
+  guarded << std::string(200000, 'a');
+  guarded.finish();
+  EXPECT_TRUE(guarded.bad());
+}
@@ -0,0 +1,79 @@
+#include <access/CachingStorage.h>
+#include <access/StreamUtil.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <test/MemoryStorage.h>
+#include <utility>
+
+using namespace odr;
+using namespace odr::access;
+using odr::test::MemoryStorage;
+
+TEST(CachingStorage, hits) {
+  auto parent = std::make_unique<MemoryStorage>(
+      MemoryStorage{{"styles.xml", "styles"}});
+  const MemoryStorage &counting = *parent;
+  const CachingStorage storage(std::move(parent), 1024);
+
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ("styles", StreamUtil::read(*storage.read("styles.xml")));
+  EXPECT_EQ(1, counting.reads);
+  EXPECT_EQ(6, storage.cachedBytes());
+  EXPECT_EQ(nullptr, storage.read("missing.xml"));
+}
+
+TEST(CachingStorage, eviction) {
+  auto parent = std::make_unique<MemoryStorage>(MemoryStorage{
+      {"a", std::string(40, 'a')},
+      {"b", std::string(40, 'b')},
+      {"c", std::string(40, 'c')},
+      {"large", std::string(200, 'l')},
+  });
+  const MemoryStorage &counting = *parent;
+  const CachingStorage storage(std::move(parent), 100);
+
+  storage.read("a");
+  storage.read("b");
+  storage.read("a");
+  // evicts `b` which was used least recently
+  storage.read("c");
+  EXPECT_EQ(3, counting.reads);
+  EXPECT_EQ(80, storage.cachedBytes());
+  storage.read("a");
+  EXPECT_EQ(3, counting.reads);
+  storage.read("b");
+  EXPECT_EQ(4, counting.reads);
+
+  // beyond the budget and never cached
+  EXPECT_EQ(std::string(200, 'l'), StreamUtil::read(*storage.read("large")));
+  storage.read("large");
+  EXPECT_EQ(6, counting.reads);
+  EXPECT_GE(100, storage.cachedBytes());
+}
+
+TEST(CachingStorage, resident) {
+  auto parent = std::make_unique<MemoryStorage>(
+      MemoryStorage{{"styles.xml", "styles"}});
+  parent->isResident = true;
+  const MemoryStorage &counting = *parent;
+  const CachingStorage storage(std::move(parent), 1024);
+
+  // the parent keeps its members already; nothing is copied
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ("styles", StreamUtil::read(*storage.read("styles.xml")));
+  EXPECT_EQ(3, counting.reads);
+  EXPECT_EQ(0, storage.cachedBytes());
+}
+
+TEST(CachingStorage, seek) {
+  const CachingStorage storage(std::make_unique<MemoryStorage>(
+      MemoryStorage{{"content.xml", "0123456789"}}));
+
+  storage.read("content.xml");
+  const auto in = storage.read("content.xml");
+  in->seekg(0, std::ios::end);
+  EXPECT_EQ(10, in->tellg());
+  in->seekg(4);
+  EXPECT_EQ("456789", StreamUtil::read(*in));
+}
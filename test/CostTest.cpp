@@ -0,0 +1,58 @@
+#include <common/Cost.h>
+#include <gtest/gtest.h>
+#include <odr/Meta.h>
+#include <string>
+#include <test/MemoryStorage.h>
+
+using namespace odr;
+using odr::test::MemoryStorage;
+
+TEST(Cost, classification) {
+  const MemoryStorage storage({
+      {"mimetype", std::string(46, 'x')},
+      {"content.xml", std::string(100000, 'x')},
+      {"styles.xml", std::string(20000, 'x')},
+      {"_rels/.rels", std::string(500, 'x')},
+      {"Pictures/image.png", std::string(300000, 'x')},
+  });
+  FileMeta meta;
+  meta.type = FileType::OPENDOCUMENT_TEXT;
+
+  const DocumentCost cost = common::Cost::estimate(storage, meta);
+  EXPECT_EQ(120500, cost.parseBytes);
+  EXPECT_EQ(300000, cost.imageBytes);
+  EXPECT_LT(0, cost.nodeCount);
+  EXPECT_EQ(0, cost.cellCount);
+  EXPECT_LT(0, cost.seconds);
+  EXPECT_LT(cost.parseBytes + cost.imageBytes, cost.memoryBytes);
+}
+
+TEST(Cost, cells) {
+  const MemoryStorage storage({
+      {"xl/workbook.xml", std::string(1000, 'x')},
+      {"xl/worksheets/sheet1.xml", std::string(640000, 'x')},
+  });
+  FileMeta meta;
+  meta.type = FileType::OFFICE_OPEN_XML_WORKBOOK;
+
+  EXPECT_EQ(10000, common::Cost::estimate(storage, meta).cellCount);
+
+  meta.entries.resize(2);
+  meta.entries[0].rowCount = 10;
+  meta.entries[0].columnCount = 20;
+  meta.entries[1].rowCount = 5;
+  meta.entries[1].columnCount = 2;
+  EXPECT_EQ(210, common::Cost::estimate(storage, meta).cellCount);
+}
+
+TEST(Cost, legacy) {
+  const MemoryStorage storage({
+      {"WordDocument", std::string(4096, 'x')},
+      {"1Table", std::string(1024, 'x')},
+      {"SummaryInformation", std::string(512, 'x')},
+  });
+  FileMeta meta;
+  meta.type = FileType::LEGACY_WORD_DOCUMENT;
+
+  EXPECT_EQ(5120, common::Cost::estimate(storage, meta).parseBytes);
+}
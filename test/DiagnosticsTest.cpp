@@ -0,0 +1,54 @@
+#include <access/Diagnostics.h>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <svm/Svm2Svg.h>
+
+using namespace odr;
+
+TEST(Diagnostics, countsByCategory) {
+  access::Diagnostics diagnostics;
+  EXPECT_TRUE(diagnostics.empty());
+
+  for (int i = 0; i < 10; ++i)
+    diagnostics.report("unknown style", "P" + std::to_string(i));
+  diagnostics.report("image without href");
+
+  const auto summary = diagnostics.summary();
+  ASSERT_EQ(2, summary.size());
+  EXPECT_EQ("image without href", summary[0].category);
+  EXPECT_EQ(1, summary[0].count);
+  EXPECT_TRUE(summary[0].samples.empty());
+  EXPECT_EQ("unknown style", summary[1].category);
+  EXPECT_EQ(10, summary[1].count);
+  ASSERT_EQ(access::Diagnostics::maxSamples, summary[1].samples.size());
+  EXPECT_EQ("P0", summary[1].samples[0]);
+
+  diagnostics.clear();
+  EXPECT_TRUE(diagnostics.empty());
+}
+
+TEST(Diagnostics, svmHeaderSkip) {
+  // header with version 1 which claims more bytes than it contains
+  std::string svm = "VCLMTF";
+  const auto append = [&](const std::uint64_t value, const int size) {
+    for (int i = 0; i < size; ++i)
+      svm.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  };
+  append(1, 2);  // version
+  append(64, 4); // length
+  svm.append(64, '\0');
+
+  access::Diagnostics diagnostics;
+  std::istringstream in(svm);
+  std::ostringstream out;
+  try {
+    svm::Translator::svg(in, out, &diagnostics);
+  } catch (...) {
+  }
+  const auto summary = diagnostics.summary();
+  EXPECT_TRUE(std::any_of(summary.begin(), summary.end(), [](auto &&d) {
+    return d.category == "svm header skipped bytes";
+  }));
+}
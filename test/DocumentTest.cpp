@@ -1,11 +1,213 @@
+#include <access/StreamUtil.h>
+#include <access/Trace.h>
+#include <access/ZipStorage.h>
+#include <algorithm>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <odr/Config.h>
 #include <odr/Document.h>
 #include <odr/Exception.h>
+#include <odr/Meta.h>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
 
 using namespace odr;
 
+namespace {
+const std::string odfNamespaces =
+    R"( xmlns:office="urn:oasis:names:tc:opendocument:xmlns:office:1.0")"
+    R"( xmlns:text="urn:oasis:names:tc:opendocument:xmlns:text:1.0")"
+    R"( xmlns:table="urn:oasis:names:tc:opendocument:xmlns:table:1.0")";
+
+std::string odf(const std::string &name, const std::string &mimeType,
+                const std::string &body) {
+  const std::string path = ::testing::TempDir() + name;
+  access::ZipWriter writer(path);
+  *writer.write("mimetype", 0) << mimeType;
+  *writer.write("content.xml")
+      << "<office:document-content" << odfNamespaces << "><office:body>"
+      << body << "</office:body></office:document-content>";
+  *writer.write("styles.xml")
+      << "<office:document-styles" << odfNamespaces << "/>";
+  return path;
+}
+
+std::string odt(const std::string &name, const std::string &text) {
+  return odf(name, "application/vnd.oasis.opendocument.text",
+             "<office:text>" + text + "</office:text>");
+}
+
+std::string sectionedOdt() {
+  return odt("sectioned.odt",
+             "<text:p>before</text:p>"
+             "<text:section text:name=\"s\"><text:p>inside</text:p>"
+             "</text:section>");
+}
+
+std::string readFile(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return access::StreamUtil::read(in);
+}
+
+// hands out a few bytes at a time like an upload and counts what was taken
+class TrickleBuf final : public std::streambuf {
+public:
+  explicit TrickleBuf(std::string data) : data_(std::move(data)) {}
+
+  std::size_t consumed() const { return pos_ - (egptr() - gptr()); }
+
+protected:
+  int underflow() final {
+    if (pos_ >= data_.size())
+      return traits_type::eof();
+    const std::size_t amount = std::min<std::size_t>(64, data_.size() - pos_);
+    char *begin = &data_[pos_];
+    setg(begin, begin, begin + amount);
+    pos_ += amount;
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  std::string data_;
+  std::size_t pos_{0};
+};
+
+// a large member followed by the ones which usually come last
+constexpr std::size_t paddingSize = 1000000;
+} // namespace
+
 TEST(Document, open) { EXPECT_THROW(Document("/"), UnknownFileType); }
 
+TEST(Document, editSection) {
+  const std::string output = ::testing::TempDir() + "sectioned.html";
+  const Document document(sectionedOdt());
+  Config config;
+  config.editable = true;
+  document.translate(output, config);
+
+  // the section writes no element of its own, so a wrapper carries its bid
+  const std::string html = readFile(output);
+  EXPECT_NE(std::string::npos,
+            html.find(R"(<div contenteditable="true" data-odr-bid="1">)"));
+
+  document.edit(R"({"modifiedText":{"1":"edited"}})");
+  const auto patches = nlohmann::json::parse(document.retranslate());
+  ASSERT_TRUE(patches.contains("1"));
+  const std::string patch = patches["1"];
+  EXPECT_EQ(0, patch.find(R"(<div contenteditable="true" data-odr-bid="1">)"));
+  EXPECT_NE(std::string::npos, patch.find("edited"));
+}
+
+TEST(Document, traceEntries) {
+  const Document document(
+      odt("paged.odt", "<text:p>first</text:p>"
+                       "<text:p><text:soft-page-break/>second</text:p>"
+                       "<text:p>third</text:p>"));
+  access::Trace::start();
+  document.translate(::testing::TempDir() + "paged.html", Config());
+  std::ostringstream out;
+  access::Trace::stop(out);
+
+  // one span per page of text; an element is labelled by its first page
+  const std::string json = out.str();
+  EXPECT_NE(std::string::npos,
+            json.find(R"("args":{"path":"content.xml","index":0})"));
+  EXPECT_NE(std::string::npos,
+            json.find(R"("args":{"path":"content.xml","index":1})"));
+}
+
+TEST(Document, sheetName) {
+  const Document document(odf(
+      "named.ods", "application/vnd.oasis.opendocument.spreadsheet",
+      "<office:spreadsheet>"
+      "<table:table table:name=\"first\"><table:table-row><table:table-cell>"
+      "<text:p>one</text:p></table:table-cell></table:table-row></table:table>"
+      "<table:table table:name=\"second\"><table:table-row><table:table-cell>"
+      "<text:p>two</text:p></table:table-cell></table:table-row></table:table>"
+      "</office:spreadsheet>"));
+  const std::string output = ::testing::TempDir() + "named.html";
+  Config config;
+  config.sheetName = "second";
+  document.translate(output, config);
+
+  const std::string html = readFile(output);
+  EXPECT_EQ(std::string::npos, html.find("one"));
+  EXPECT_NE(std::string::npos, html.find("two"));
+}
+
+TEST(Document, translateFailingSink) {
+  // /dev/full accepts the open and fails every write with ENOSPC
+  const Document document(sectionedOdt());
+  Config config;
+  EXPECT_FALSE(document.translate("/dev/full", config));
+  config.gzip = true;
+  EXPECT_FALSE(document.translate("/dev/full", config));
+  config.pipeline = true;
+  EXPECT_FALSE(document.translate("/dev/full", config));
+  EXPECT_TRUE(document.translate(::testing::TempDir() + "full.html", config));
+}
+
+TEST(Document, fromStreamOdf) {
+  const std::string path = ::testing::TempDir() + "streamed.ods";
+  {
+    access::ZipWriter writer(path);
+    *writer.write("mimetype", 0)
+        << "application/vnd.oasis.opendocument.spreadsheet";
+    *writer.write("content.xml")
+        << "<office:document-content" << odfNamespaces << "><office:body>"
+        << "<office:spreadsheet><table:table table:name=\"s\">"
+        << "<table:table-row><table:table-cell><text:p>streamed</text:p>"
+        << "</table:table-cell></table:table-row></table:table>"
+        << "</office:spreadsheet></office:body></office:document-content>";
+    *writer.write("styles.xml")
+        << "<office:document-styles" << odfNamespaces << "/>";
+    *writer.write("Pictures/large.png", 0) << std::string(paddingSize, 'p');
+    *writer.write("META-INF/manifest.xml")
+        << "<manifest:manifest xmlns:manifest="
+           "\"urn:oasis:names:tc:opendocument:xmlns:manifest:1.0\"/>";
+  }
+  TrickleBuf buf(readFile(path));
+  const Document document =
+      Document::fromStream(std::make_unique<std::istream>(&buf));
+
+  EXPECT_EQ(FileType::OPENDOCUMENT_SPREADSHEET, document.type());
+  EXPECT_FALSE(document.encrypted());
+  // neither the padding nor the manifest had to arrive
+  EXPECT_GT(paddingSize / 2, buf.consumed());
+
+  const std::string output = ::testing::TempDir() + "streamed.html";
+  EXPECT_TRUE(document.translate(output, Config()));
+  EXPECT_NE(std::string::npos, readFile(output).find("streamed"));
+}
+
+TEST(Document, fromStreamOoxml) {
+  const std::string path = ::testing::TempDir() + "streamed.docx";
+  {
+    access::ZipWriter writer(path);
+    *writer.write("[Content_Types].xml")
+        << "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/"
+           "content-types\"><Override PartName=\"/word/document.xml\" "
+           "ContentType=\"application/vnd.openxmlformats-officedocument."
+           "wordprocessingml.document.main+xml\"/></Types>";
+    *writer.write("word/document.xml")
+        << "<w:document xmlns:w=\"http://schemas.openxmlformats.org/"
+           "wordprocessingml/2006/main\"><w:body/></w:document>";
+    *writer.write("word/media/large.png", 0)
+        << std::string(paddingSize, 'p');
+  }
+  TrickleBuf buf(readFile(path));
+  const Document document =
+      Document::fromStream(std::make_unique<std::istream>(&buf));
+
+  EXPECT_EQ(FileType::OFFICE_OPEN_XML_DOCUMENT, document.type());
+  EXPECT_FALSE(document.encrypted());
+  EXPECT_GT(paddingSize / 2, buf.consumed());
+}
+
 TEST(DocumentNoExcept, open) {
   EXPECT_EQ(nullptr, DocumentNoExcept::open("/"));
 }
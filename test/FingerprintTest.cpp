@@ -0,0 +1,47 @@
+#include <common/Fingerprint.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <test/MemoryStorage.h>
+
+using namespace odr;
+using odr::test::MemoryStorage;
+
+TEST(Fingerprint, format) {
+  const MemoryStorage storage({{"content.xml", "<a/>"}});
+  const std::string fingerprint = common::Fingerprint::directory(storage);
+  EXPECT_EQ(32, fingerprint.size());
+  EXPECT_EQ(std::string::npos,
+            fingerprint.find_first_not_of("0123456789abcdef"));
+  EXPECT_EQ(fingerprint, common::Fingerprint::directory(storage));
+}
+
+TEST(Fingerprint, order) {
+  const MemoryStorage a({{"content.xml", "<a/>"}, {"styles.xml", "<b/>"}});
+  const MemoryStorage b({{"styles.xml", "<b/>"}, {"content.xml", "<a/>"}});
+  EXPECT_EQ(common::Fingerprint::directory(a),
+            common::Fingerprint::directory(b));
+  EXPECT_EQ(common::Fingerprint::content(a), common::Fingerprint::content(b));
+}
+
+TEST(Fingerprint, changes) {
+  const MemoryStorage a({{"content.xml", "<a/>"}});
+  const MemoryStorage b({{"content.xml", "<b/>"}});
+  const MemoryStorage c({{"content.xml", "<a />"}});
+  const MemoryStorage d({{"other.xml", "<a/>"}});
+  EXPECT_NE(common::Fingerprint::directory(a),
+            common::Fingerprint::directory(b));
+  EXPECT_NE(common::Fingerprint::directory(a),
+            common::Fingerprint::directory(c));
+  EXPECT_NE(common::Fingerprint::directory(a),
+            common::Fingerprint::directory(d));
+  EXPECT_NE(common::Fingerprint::content(a), common::Fingerprint::content(b));
+}
+
+TEST(Fingerprint, content) {
+  // same size and checksum; only the content tells them apart
+  const MemoryStorage a({{"content.xml", "ab"}});
+  const MemoryStorage b({{"content.xml", "ba"}});
+  EXPECT_EQ(common::Fingerprint::directory(a),
+            common::Fingerprint::directory(b));
+  EXPECT_NE(common::Fingerprint::content(a), common::Fingerprint::content(b));
+}
@@ -0,0 +1,66 @@
+#include <access/GzipStream.h>
+#include <gtest/gtest.h>
+#include <miniz.h>
+#include <sstream>
+#include <string>
+
+using namespace odr::access;
+
+namespace {
+std::uint32_t readLittleEndian(const std::string &data, std::size_t offset) {
+  std::uint32_t result = 0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    result |= static_cast<std::uint32_t>(
+                  static_cast<unsigned char>(data[offset + i]))
+              << (8 * i);
+  }
+  return result;
+}
+} // namespace
+
+TEST(GzipOstream, roundtrip) {
+  std::string input;
+  for (int i = 0; i < 10000; ++i) {
+    input += "<p>line " + std::to_string(i) + "</p>";
+  }
+
+  std::ostringstream out;
+  {
+    GzipOstream gzip(out, 9);
+    gzip << input.substr(0, 1000);
+    gzip.flush();
+    gzip << input.substr(1000);
+  }
+  const std::string compressed = out.str();
+
+  ASSERT_GT(compressed.size(), 18);
+  EXPECT_LT(compressed.size(), input.size());
+  EXPECT_EQ('\x1f', compressed[0]);
+  EXPECT_EQ('\x8b', compressed[1]);
+
+  std::size_t length = 0;
+  void *inflated = tinfl_decompress_mem_to_heap(
+      compressed.data() + 10, compressed.size() - 18, &length, 0);
+  ASSERT_NE(nullptr, inflated);
+  const std::string result(static_cast<const char *>(inflated), length);
+  mz_free(inflated);
+  EXPECT_EQ(input, result);
+
+  EXPECT_EQ(mz_crc32(MZ_CRC32_INIT,
+                     reinterpret_cast<const unsigned char *>(input.data()),
+                     input.size()),
+            readLittleEndian(compressed, compressed.size() - 8));
+  EXPECT_EQ(input.size(), readLittleEndian(compressed, compressed.size() - 4));
+}
+
+TEST(GzipOstream, finish) {
+  std::ostringstream out;
+  GzipOstream gzip(out);
+  gzip << "text";
+  gzip.finish();
+  const std::size_t size = out.str().size();
+  gzip << "more";
+  gzip.flush();
+  EXPECT_FALSE(gzip.good());
+  EXPECT_EQ(size, out.str().size());
+}
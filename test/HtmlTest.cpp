@@ -0,0 +1,10 @@
+#include <common/Html.h>
+#include <gtest/gtest.h>
+
+using namespace odr::common;
+
+TEST(Html, minifyCss) {
+  EXPECT_EQ("p{padding:0 !important}.a .b,td{border:1px solid #C0C0C0}",
+            Html::minifyCss("/* x */\np {\n  padding: 0 !important;\n}\n"
+                            ".a  .b, td { border: 1px solid #C0C0C0; }\n"));
+}
@@ -0,0 +1,122 @@
+#include <common/Fingerprint.h>
+#include <common/IrCache.h>
+#include <common/IrDocument.h>
+#include <common/IrRenderer.h>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <odr/Config.h>
+#include <sstream>
+#include <string>
+#include <test/MemoryStorage.h>
+
+using namespace odr;
+using namespace odr::common;
+
+namespace {
+IrDocument sheet() {
+  IrDocument result;
+  result.open(IrType::SHEET, "ta1");
+  std::uint32_t row = result.open(IrType::TABLE_ROW);
+  result.open(IrType::TABLE_CELL, "ce1");
+  result.appendText("a");
+  result.appendText("b");
+  result.close();
+  result.setRepeat(result.leaf(IrType::TABLE_CELL), 2);
+  result.open(IrType::TABLE_CELL);
+  result.appendText("c");
+  result.close();
+  result.close();
+  result.setRepeat(row, 1);
+  result.setRepeat(result.leaf(IrType::TABLE_ROW), 3);
+  row = result.open(IrType::TABLE_ROW);
+  result.setRepeat(row, 2);
+  result.open(IrType::TABLE_CELL);
+  result.appendText("d");
+  result.close();
+  result.close();
+  result.close();
+  return result;
+}
+
+std::string text(const IrDocument &document, const Config &config = {}) {
+  std::ostringstream out;
+  IrRenderer::text(document, config, out);
+  return out.str();
+}
+} // namespace
+
+TEST(IrDocument, build) {
+  const IrDocument document = sheet();
+  ASSERT_EQ(12, document.nodes().size());
+  EXPECT_EQ(12, document.node(0).end);
+  EXPECT_EQ(IrType::SHEET, document.node(1).type);
+  EXPECT_EQ("ta1", document.style(1));
+  EXPECT_EQ(12, document.node(1).end);
+  EXPECT_EQ(8, document.node(2).end);
+  EXPECT_EQ("ab", document.text(4));
+}
+
+TEST(IrDocument, text) {
+  EXPECT_EQ("ab\t\t\tc\n\n\n\nd\nd\n", text(sheet()));
+}
+
+TEST(IrDocument, textLimit) {
+  Config config;
+  config.tableOffsetCols = 1;
+  config.tableLimitRows = 2;
+  EXPECT_EQ("\t\tc\n", text(sheet(), config));
+}
+
+TEST(IrDocument, json) {
+  IrDocument document;
+  document.open(IrType::PARAGRAPH, "P1");
+  document.appendText("\"x\"\n");
+  document.close();
+
+  std::ostringstream out;
+  IrRenderer::json(document, {}, out);
+  EXPECT_EQ(R"({"type":"root","children":[{"type":"paragraph","style":"P1",)"
+            R"("children":[{"type":"text","text":"\"x\"\n"}]}]})",
+            out.str());
+}
+
+TEST(IrDocument, serialize) {
+  const IrDocument document = sheet();
+  std::stringstream buffer;
+  document.write(buffer);
+
+  const IrDocument result = IrDocument::read(buffer);
+  EXPECT_EQ(text(document), text(result));
+  EXPECT_EQ("ce1", result.style(3));
+}
+
+TEST(IrDocument, corrupt) {
+  std::stringstream buffer;
+  sheet().write(buffer);
+  const std::string data = buffer.str();
+
+  std::istringstream truncated(data.substr(0, data.size() / 2));
+  EXPECT_THROW(IrDocument::read(truncated), NoIrFileException);
+  std::istringstream invalid("odri");
+  EXPECT_THROW(IrDocument::read(invalid), NoIrFileException);
+}
+
+TEST(IrDocument, cache) {
+  const std::string directory = ::testing::TempDir();
+  const test::MemoryStorage storage({{"content.xml", "<ab/>"}});
+  // same names, sizes and checksums, so the same directory fingerprint
+  const test::MemoryStorage forged({{"content.xml", "<ba/>"}});
+  ASSERT_EQ(Fingerprint::directory(storage), Fingerprint::directory(forged));
+  const std::string path =
+      directory + "/" + Fingerprint::content(storage) + ".odri";
+  std::remove(path.c_str());
+
+  IrDocument result;
+  EXPECT_FALSE(IrCache::load(directory, storage, result));
+  IrCache::store(directory, storage, sheet());
+  ASSERT_TRUE(IrCache::load(directory, storage, result));
+  EXPECT_EQ(text(sheet()), text(result));
+  EXPECT_FALSE(IrCache::load(directory, forged, result));
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,85 @@
+#ifndef ODR_TEST_MEMORY_STORAGE_H
+#define ODR_TEST_MEMORY_STORAGE_H
+
+#include <access/Path.h>
+#include <access/Storage.h>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace odr {
+namespace test {
+
+// files in insertion order; the checksum is the sum of the bytes, `reads`
+// counts the reads which reach the storage and `isResident` is reported as
+// `resident()`
+class MemoryStorage final : public access::ReadStorage {
+public:
+  MemoryStorage(
+      std::initializer_list<std::pair<access::Path, std::string>> files)
+      : files_(files) {}
+
+  bool isSomething(const access::PathView path) const final {
+    return isFile(path);
+  }
+  bool isFile(const access::PathView path) const final {
+    return find(path) != nullptr;
+  }
+  bool isDirectory(access::PathView) const final { return false; }
+  bool isReadable(const access::PathView path) const final {
+    return isFile(path);
+  }
+
+  std::uint64_t size(const access::PathView path) const final {
+    const std::string *file = find(path);
+    return file == nullptr ? 0 : file->size();
+  }
+
+  std::uint32_t checksum(const access::PathView path) const final {
+    std::uint32_t result = 0;
+    if (const std::string *file = find(path)) {
+      for (auto &&c : *file)
+        result += static_cast<unsigned char>(c);
+    }
+    return result;
+  }
+
+  bool resident() const final { return isResident; }
+
+  void visit(Visitor visitor) const final {
+    for (auto &&file : files_)
+      visitor(file.first);
+  }
+
+  std::unique_ptr<std::istream>
+  read(const access::PathView path) const final {
+    const std::string *file = find(path);
+    if (file == nullptr)
+      return nullptr;
+    ++reads;
+    return std::make_unique<std::istringstream>(*file);
+  }
+
+  mutable int reads{0};
+  bool isResident{false};
+
+private:
+  const std::string *find(const access::PathView path) const {
+    for (auto &&file : files_) {
+      if (file.first == path)
+        return &file.second;
+    }
+    return nullptr;
+  }
+
+  std::vector<std::pair<access::Path, std::string>> files_;
+};
+
+} // namespace test
+} // namespace odr
+
+#endif // ODR_TEST_MEMORY_STORAGE_H
@@ -26,3 +26,33 @@ TEST(Path, rebase) {
   EXPECT_EQ("image8.png",
             Path("./ppt/media/image8.png").rebase("ppt/media").string());
 }
+
+TEST(Path, parent) {
+  EXPECT_EQ("/", Path("/a").parent().string());
+  EXPECT_EQ("../", Path("../a").parent().string());
+  EXPECT_EQ("../../", Path("..").parent().string());
+}
+
+TEST(Path, segments) {
+  EXPECT_TRUE(Path("ppt").parentOf("ppt/slides"));
+  EXPECT_FALSE(Path("ppt").parentOf("pptx/slides"));
+  EXPECT_TRUE(Path("ppt/slides/slide1.xml") > Path("ppt/slides"));
+  // a separator sorts before any other character
+  EXPECT_TRUE(Path("ppt/slides") < Path("ppt-slides"));
+}
+
+TEST(PathView, hash) {
+  constexpr PathView literal("content.xml");
+  static_assert(literal.hash() == PathView::hash("content.xml"));
+  EXPECT_EQ(Path("./content.xml").hash(), literal.hash());
+  EXPECT_EQ(std::hash<Path>{}(Path("a/../content.xml")),
+            std::hash<PathView>{}(literal));
+  EXPECT_EQ(Path("a").join("b").hash(), PathView("a/b").hash());
+}
+
+TEST(PathView, equality) {
+  const Path path("word/document.xml");
+  EXPECT_TRUE(PathView(path) == "word/document.xml");
+  EXPECT_TRUE(PathView(path) != "word/styles.xml");
+  EXPECT_EQ(path, Path(PathView("word/document.xml")));
+}
@@ -0,0 +1,28 @@
+#include <cli/src/Percentile.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace odr;
+
+TEST(Percentile, empty) { EXPECT_EQ(0, percentile({}, 0.5)); }
+
+TEST(Percentile, nearestRank) {
+  // 1, 2, ..., 100
+  std::vector<double> values;
+  for (int i = 1; i <= 100; ++i)
+    values.push_back(i);
+  EXPECT_EQ(1, percentile(values, 0));
+  EXPECT_EQ(7, percentile(values, 0.07));
+  EXPECT_EQ(50, percentile(values, 0.50));
+  EXPECT_EQ(95, percentile(values, 0.95));
+  EXPECT_EQ(99, percentile(values, 0.99));
+  EXPECT_EQ(100, percentile(values, 1));
+}
+
+TEST(Percentile, fewValues) {
+  const std::vector<double> values{10, 20, 30, 40, 50};
+  EXPECT_EQ(30, percentile(values, 0.50));
+  EXPECT_EQ(50, percentile(values, 0.95));
+  EXPECT_EQ(10, percentile(values, 0.20));
+  EXPECT_EQ(20, percentile(values, 0.21));
+}
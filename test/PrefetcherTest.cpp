@@ -0,0 +1,68 @@
+#include <access/Prefetcher.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace odr;
+
+TEST(Prefetcher, order) {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 20; ++i) {
+    paths.push_back(::testing::TempDir() + "prefetch" + std::to_string(i));
+    std::ofstream(paths.back()) << std::string(i * 1000, 'a' + i);
+  }
+  paths.insert(paths.begin() + 5, "/non/existent");
+
+  access::Prefetcher prefetcher(paths, 3);
+  access::Prefetcher::File file;
+  for (int i = 0; i < 21; ++i) {
+    ASSERT_TRUE(prefetcher.next(file));
+    EXPECT_EQ(i, file.index);
+    EXPECT_EQ(paths[i], file.path);
+    if (i == 5) {
+      EXPECT_FALSE(file.error.empty());
+      continue;
+    }
+    const int n = i < 5 ? i : i - 1;
+    EXPECT_TRUE(file.error.empty());
+    EXPECT_EQ(std::string(n * 1000, 'a' + n), file.data);
+  }
+  EXPECT_FALSE(prefetcher.next(file));
+
+  for (auto &&path : paths)
+    std::remove(path.c_str());
+}
+
+TEST(Prefetcher, workers) {
+  const std::string path = ::testing::TempDir() + "prefetch";
+  std::ofstream(path) << "content";
+  const std::vector<std::string> paths(100, path);
+
+  access::Prefetcher prefetcher(paths, 4);
+  std::atomic<int> count{0};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([&] {
+      access::Prefetcher::File file;
+      while (prefetcher.next(file)) {
+        EXPECT_EQ("content", file.data);
+        ++count;
+      }
+    });
+  }
+  for (auto &&worker : workers)
+    worker.join();
+  EXPECT_EQ(100, count);
+
+  std::remove(path.c_str());
+}
+
+TEST(Prefetcher, abandoned) {
+  const std::vector<std::string> paths(100, "/non/existent");
+  // must not hang although nobody takes the files
+  access::Prefetcher prefetcher(paths, 2);
+}
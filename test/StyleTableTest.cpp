@@ -0,0 +1,29 @@
+#include <common/StyleTable.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace odr::common;
+
+TEST(StyleTable, intern) {
+  StyleTable table;
+  const std::string a = table.intern("color:red;");
+  const std::string b = table.intern("color:blue;");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, table.intern("color:red;"));
+  EXPECT_EQ(2, table.size());
+}
+
+TEST(StyleTable, css) {
+  StyleTable table;
+  table.intern("color:red;");
+  table.intern("font-weight:bold;");
+  table.intern("color:red;");
+
+  std::ostringstream out;
+  table.css(out);
+  EXPECT_EQ(".odr-i0 {color:red;}\n.odr-i1 {font-weight:bold;}\n", out.str());
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ("odr-i0", table.intern("color:blue;"));
+}
@@ -25,3 +25,15 @@ TEST(TableCursor, test) {
   EXPECT_EQ(tl.row(), 3);
   EXPECT_EQ(tl.col(), 0);
 }
+
+TEST(TableCursor, largeRowspan) {
+  odr::common::TableCursor tl;
+  tl.addCell(1, 4000000000u, 1);
+  tl.addCell(1, 2, 1);
+  tl.addRow(1);
+  EXPECT_EQ(tl.col(), 2);
+  tl.addRow(1000000);
+  EXPECT_EQ(tl.col(), 1);
+  tl.addCell(1, 1, 1);
+  EXPECT_EQ(tl.col(), 2);
+}
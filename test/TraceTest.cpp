@@ -0,0 +1,37 @@
+#include <access/Trace.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace odr::access;
+
+TEST(Trace, disabled) {
+  { const Trace::Span span("ignored"); }
+  Trace::start();
+  std::ostringstream out;
+  Trace::stop(out);
+  EXPECT_EQ("{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}", out.str());
+  EXPECT_FALSE(Trace::enabled());
+}
+
+TEST(Trace, spans) {
+  Trace::start();
+  {
+    const Trace::Span outer("content", "content.xml");
+    const Trace::Span inner("entry", "xl/worksheets/\"1\".xml", 2);
+  }
+  std::ostringstream out;
+  Trace::stop(out);
+
+  const std::string json = out.str();
+  // inner spans end first
+  const auto inner = json.find("\"name\":\"entry\"");
+  const auto outer = json.find("\"name\":\"content\"");
+  ASSERT_NE(std::string::npos, inner);
+  ASSERT_NE(std::string::npos, outer);
+  EXPECT_LT(inner, outer);
+  EXPECT_NE(std::string::npos,
+            json.find("\"path\":\"xl/worksheets/\\\"1\\\".xml\",\"index\":2"));
+  EXPECT_NE(std::string::npos,
+            json.find("\"args\":{\"path\":\"content.xml\"}"));
+}
@@ -0,0 +1,87 @@
+#include <common/XmlTraversal.h>
+#include <common/XmlUtil.h>
+#include <gtest/gtest.h>
+#include <pugixml.hpp>
+#include <string>
+
+using namespace odr::common;
+
+namespace {
+struct State {};
+typedef XmlTraversal::Frame<State> Frame;
+
+std::string print(const pugi::xml_node &root,
+                  const std::uint32_t maxDepth = XmlTraversal::defaultMaxDepth) {
+  std::string result;
+  XmlTraversal::traverse<State>(
+      root,
+      [&](Frame &frame) {
+        if (frame.node.type() == pugi::node_pcdata)
+          result += frame.node.value();
+        else
+          result += std::string("<") + frame.node.name() + ">";
+        return true;
+      },
+      [&](Frame &frame) {
+        if (frame.node.type() != pugi::node_pcdata)
+          result += std::string("</") + frame.node.name() + ">";
+        return frame.iteration + 1 <
+               frame.node.attribute("repeat").as_uint(1);
+      },
+      maxDepth);
+  return result;
+}
+} // namespace
+
+TEST(XmlTraversal, order) {
+  const auto doc = XmlUtil::parse("<a><b>1</b><c><d>2</d></c>3</a>");
+  EXPECT_EQ("<a><b>1</b><c><d>2</d></c>3</a>", print(doc.document_element()));
+}
+
+TEST(XmlTraversal, repeat) {
+  const auto doc = XmlUtil::parse(R"(<a><b repeat="3">x</b></a>)");
+  EXPECT_EQ("<a><b>x</b><b>x</b><b>x</b></a>", print(doc.document_element()));
+}
+
+TEST(XmlTraversal, maxDepth) {
+  const auto doc = XmlUtil::parse("<a><b><c>1</c></b>2</a>");
+  EXPECT_EQ("<a><b></b>2</a>", print(doc.document_element(), 2));
+}
+
+TEST(XmlTraversal, deep) {
+  constexpr std::uint32_t depth = 100000;
+  std::string xml;
+  for (std::uint32_t i = 0; i < depth; ++i)
+    xml += "<a>";
+  for (std::uint32_t i = 0; i < depth; ++i)
+    xml += "</a>";
+  const auto doc = XmlUtil::parse(xml);
+
+  std::uint32_t entered = 0;
+  XmlTraversal::traverse<State>(
+      doc.document_element(),
+      [&](Frame &) {
+        ++entered;
+        return true;
+      },
+      [&](Frame &) { return false; }, depth);
+  EXPECT_EQ(depth, entered);
+}
+
+TEST(XmlTraversal, redirect) {
+  const auto doc = XmlUtil::parse("<a><b/><c>1</c><d>2</d></a>");
+  std::string result;
+  XmlTraversal::traverse<State>(
+      doc.document_element().child("b"),
+      [&](Frame &frame) {
+        if (frame.node.type() == pugi::node_pcdata) {
+          result += frame.node.value();
+        } else if (std::string(frame.node.name()) == "b") {
+          frame.next = frame.node.next_sibling();
+          frame.single = true;
+        }
+        return true;
+      },
+      [&](Frame &) { return false; });
+  EXPECT_EQ("1", result);
+}
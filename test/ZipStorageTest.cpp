@@ -1,7 +1,16 @@
 #include <access/Path.h>
+#include <access/StreamUtil.h>
 #include <access/ZipStorage.h>
+#include <algorithm>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <memory>
+#include <miniz.h>
+#include <sstream>
+#include <streambuf>
 #include <string>
+#include <utility>
+#include <vector>
 
 using namespace odr::access;
 
@@ -9,6 +18,21 @@ using namespace odr::access;
 
 TEST(ZipReader, exception) { EXPECT_THROW(ZipReader("/"), NoZipFileException); }
 
+TEST(ZipReader, sharedBuffer) {
+  const std::string file = "shared.zip";
+  {
+    ZipWriter writer(file);
+    writer.write("one.txt")->write("shared", 6);
+  }
+  std::ifstream in(file, std::ios::binary);
+  const auto buffer = std::make_shared<const std::string>(StreamUtil::read(in));
+
+  const ZipReader reader(buffer);
+  // the reader keeps the buffer instead of a copy
+  EXPECT_EQ(2, buffer.use_count());
+  EXPECT_EQ("shared", StreamUtil::read(*reader.read("one.txt")));
+}
+
 TEST(ZipWriter, create) {
   const std::string file = "created.zip";
 
@@ -83,3 +107,127 @@ TEST(ZipWriter, create_order) {
 }
 
 // TODO copy test
+
+namespace {
+// a stored member with its sizes in the local header
+std::string storedMember(const std::string &name, const std::string &data) {
+  std::string result;
+  const auto append = [&](const std::uint64_t value, const int size) {
+    for (int i = 0; i < size; ++i)
+      result.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  };
+  const auto *bytes = reinterpret_cast<const unsigned char *>(data.data());
+  const auto crc = mz_crc32(MZ_CRC32_INIT, bytes, data.size());
+  append(0x04034b50, 4);
+  append(20, 2); // version
+  append(0, 2);  // flags
+  append(0, 2);  // stored
+  append(0, 4);  // time and date
+  append(crc, 4);
+  append(data.size(), 4);
+  append(data.size(), 4);
+  append(name.size(), 2);
+  append(0, 2);
+  return result + name + data;
+}
+
+// `content.xml` deflated with a data descriptor, as written by a streaming
+// zip writer which cannot go back to fill in the sizes
+const unsigned char deflatedContent[] = {
+    0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x08, 0x00, 0x08, 0x00, 0x32, 0x83,
+    0x52, 0x5d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x63, 0x6f, 0x6e, 0x74, 0x65, 0x6e,
+    0x74, 0x2e, 0x78, 0x6d, 0x6c, 0xb3, 0x49, 0xc9, 0x4f, 0x2e, 0xcd, 0x4d,
+    0xcd, 0x2b, 0xb1, 0x2b, 0x49, 0xad, 0x28, 0x51, 0xa0, 0x31, 0x61, 0xa3,
+    0x0f, 0xb7, 0x0e, 0x00, 0x50, 0x4b, 0x07, 0x08, 0x4a, 0xdc, 0x6a, 0xe9,
+    0x17, 0x00, 0x00, 0x00, 0x79, 0x00, 0x00, 0x00,
+};
+
+std::string content() {
+  std::string result = "<document>";
+  for (int i = 0; i < 20; ++i)
+    result += "text ";
+  return result + "</document>";
+}
+
+// hands out a few bytes at a time like a slow upload and counts them
+class TrickleBuf final : public std::streambuf {
+public:
+  explicit TrickleBuf(std::string data) : data_(std::move(data)) {}
+
+  std::size_t consumed() const { return pos_ - (egptr() - gptr()); }
+
+protected:
+  int underflow() final {
+    if (pos_ >= data_.size())
+      return traits_type::eof();
+    const std::size_t amount = std::min<std::size_t>(64, data_.size() - pos_);
+    char *begin = &data_[pos_];
+    setg(begin, begin, begin + amount);
+    pos_ += amount;
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  std::string data_;
+  std::size_t pos_{0};
+};
+
+std::string archive() {
+  std::string result = storedMember("mimetype", "application/test");
+  result += storedMember("Pictures/", "");
+  result += std::string(reinterpret_cast<const char *>(deflatedContent),
+                        sizeof(deflatedContent));
+  result += storedMember("Pictures/large.png", std::string(100000, 'p'));
+  // the central directory which is never looked at
+  result += "PK\x01\x02";
+  return result;
+}
+} // namespace
+
+TEST(ZipStreamReader, exception) {
+  EXPECT_THROW(
+      ZipStreamReader(std::make_unique<std::istringstream>("no zip at all")),
+      NoZipFileException);
+}
+
+TEST(ZipStreamReader, beforeArrival) {
+  TrickleBuf buf(archive());
+  auto in = std::make_unique<std::istream>(&buf);
+  const ZipStreamReader reader(std::move(in));
+
+  EXPECT_TRUE(reader.isFile("mimetype"));
+  EXPECT_EQ(content(), StreamUtil::read(*reader.read("content.xml")));
+  EXPECT_TRUE(reader.isDirectory("Pictures"));
+  // the large member is still in flight
+  EXPECT_GT(90000, buf.consumed());
+
+  EXPECT_EQ(100000, reader.size("Pictures/large.png"));
+  EXPECT_FALSE(reader.isSomething("missing.xml"));
+  std::vector<std::string> paths;
+  reader.visit([&](const Path &path) { paths.push_back(path.string()); });
+  EXPECT_EQ((std::vector<std::string>{"mimetype", "Pictures", "content.xml",
+                                      "Pictures/large.png"}),
+            paths);
+}
+
+TEST(ZipStreamReader, first) {
+  TrickleBuf buf(archive());
+  const ZipStreamReader reader(std::make_unique<std::istream>(&buf));
+
+  EXPECT_EQ(Path("mimetype"), reader.first());
+  // only the first member had to arrive
+  EXPECT_GE(128, buf.consumed());
+}
+
+TEST(ZipStreamReader, spool) {
+  const ZipStreamReader reader(std::make_unique<std::istringstream>(archive()),
+                               1024);
+  EXPECT_EQ(std::string(100000, 'p'),
+            StreamUtil::read(*reader.read("Pictures/large.png")));
+  EXPECT_EQ(content(), StreamUtil::read(*reader.read("content.xml")));
+
+  const ZipStreamReader small(std::make_unique<std::istringstream>(archive()),
+                              1024, 1024);
+  EXPECT_THROW(small.read("Pictures/large.png"), ZipSpoolFullException);
+}